@@ -30,21 +30,258 @@
 
 #include "common.h"
 #include "pointset.h"
+#include "polygon.h"
 #include "imageinfo.h"
 
 #include <string>
+#include <vector>
+
+namespace itk {
+class DataObject;
+}
 
 namespace nvidia {
 namespace aiaa {
 
 class AIAA_CLIENT_API AiaaUtils {
  public:
+  /// Default memory budget for decoded input images kept across pre/post process calls (512 MB)
+  static const size_t DEFAULT_IMAGE_CACHE_SIZE;
+
+  /// Set memory budget (in bytes) for decoded images cache; 0 disables the cache
+  static void setImageCacheSize(size_t maxSizeInBytes);
+
+  /*!
+   @brief Compress file (e.g. uncompressed .nii to .nii.gz) using multiple threads
+   @param[in] inputFile  Input file to be compressed
+   @param[in] outputFile  Output gzip file
+   @param[in] threads  Number of threads; 0 means all cores
+
+   Independent blocks are compressed in parallel and written as concatenated gzip members, readable by any standard gzip reader
+
+   @throw nvidia.aiaa.error.107 in case of file read/write or compression error
+   */
+  static void gzipFile(const std::string &inputFile, const std::string &outputFile, int threads = 0);
+
+  /// Default number of slabs used to stream large images from input to output (see imageConvert)
+  static const unsigned int DEFAULT_STREAM_DIVISIONS;
+
+  /*!
+   @brief Convert image (e.g. mha/nrrd/nii to nii.gz) slab by slab using ITK streaming
+   @param[in] inputImage  Input image file
+   @param[in] outputImage  Output image file; .gz output is compressed using all cores
+   @param[in] streamDivisions  Number of slabs; peak memory is proportional to slab size for formats which support streaming
+
+   @throw nvidia.aiaa.error.103 in case of ITK error related to image processing
+   */
+  static void imageConvert(const std::string &inputImage, const std::string &outputImage, unsigned int streamDivisions = DEFAULT_STREAM_DIVISIONS);
+
+  /*!
+   @brief Write in-memory image to file; .gz output is written uncompressed first and then compressed using all cores
+   @param[in] image  Scalar 2D/3D itk::Image (any pixel type supported by imageConvert)
+   @param[in] outputImage  Output image file
+
+   Temporary uncompressed file is removed in all cases (including errors)
+
+   @throw nvidia.aiaa.error.103 in case of ITK error related to image processing or unsupported image type
+   @throw nvidia.aiaa.error.107 in case of file write or compression error
+   */
+  static void imageWrite(const itk::DataObject *image, const std::string &outputImage);
+
+  /// Pixel type for client-side quantization of input image before upload
+  enum QuantizationType {
+    QUANTIZE_NONE,
+    QUANTIZE_INT16,
+    QUANTIZE_UINT8
+  };
+
+  /*!
+   @brief Compute scale/offset for quantization; original intensity ~= quantized value * scale + offset
+
+   For int16, a window within int16 range is only clamped (scale = 1, offset = 0); values are rescaled when the window
+   does not fit (int16) or always (uint8), in which case the server must de-quantize the input to restore intensities
+   @param[in] windowMin  Intensity window min
+   @param[in] windowMax  Intensity window max
+   @param[in] type  Quantization type
+   @param[out] scale  Scale
+   @param[out] offset  Offset
+   */
+  static void quantizationScale(double windowMin, double windowMax, QuantizationType type, double &scale, double &offset);
+
+  /*!
+   @brief Clip image to intensity window and quantize it (int16/uint8) to reduce upload size; image is processed slab by slab
+   @param[in] inputImage  Input image file
+   @param[in] outputImage  Output image file
+   @param[in] windowMin  Intensity window min
+   @param[in] windowMax  Intensity window max
+   @param[in] type  Quantization type
+   @param[in] streamDivisions  Number of slabs
+
+   @throw nvidia.aiaa.error.103 in case of ITK error related to image processing
+   */
+  static void imageQuantize(const std::string &inputImage, const std::string &outputImage, double windowMin, double windowMax,
+                            QuantizationType type, unsigned int streamDivisions = DEFAULT_STREAM_DIVISIONS);
+
+  /*!
+   @brief Crop image to bounding box of foreground (e.g. body in CT) voxels, found by a single threshold/projection pass
+   @param[in] inputImage  Input 3D image file
+   @param[in] outputImage  Output (cropped) image file
+   @param[out] imageInfo  Crop information; use imagePostProcess() with it to re-embed result mask into original image space
+   @param[in] threshold  Voxels with intensity above threshold are foreground
+   @param[in] margin  Margin (in voxels) added around bounding box
+
+   @throw nvidia.aiaa.error.103 in case of ITK error related to image processing
+   */
+  static void imageForegroundCrop(const std::string &inputImage, const std::string &outputImage, ImageInfo &imageInfo, double threshold,
+                                  int margin);
+
+  /*!
+   @brief Compute bounding box of voxels above threshold (plus margin) as crop region in imageInfo
+   @param[in] inputImage  Input 3D image (or mask) file
+   @param[out] imageInfo  Crop information (full image if there are no voxels above threshold)
+   @param[in] threshold  Voxels with intensity above threshold are considered
+   @param[in] margin  Margin (in voxels) added around bounding box
+   @return true if any voxel is above threshold
+
+   @throw nvidia.aiaa.error.103 in case of ITK error related to image processing
+   */
+  static bool imageBoundingBox(const std::string &inputImage, ImageInfo &imageInfo, double threshold, int margin);
+
+  /*!
+   @brief Crop (without resampling) image to the crop region in imageInfo
+   @param[in] inputImage  Input 3D image file
+   @param[in] outputImage  Output (cropped) image file
+   @param[in] imageInfo  Crop information
+
+   @throw nvidia.aiaa.error.103 in case of ITK error related to image processing
+   */
+  static void imageCrop(const std::string &inputImage, const std::string &outputImage, const ImageInfo &imageInfo);
+
+  /*!
+   @brief Downsample image by an integer factor per axis
+   @param[in] inputImage  Input 3D image file
+   @param[in] outputImage  Output (downsampled) image file
+   @param[out] imageInfo  Crop information (whole image); use imagePostProcess() with it to upsample result mask to original size
+   @param[in] factor  Downsample factor
+
+   @throw nvidia.aiaa.error.103 in case of ITK error related to image processing
+   @throw nvidia.aiaa.error.104 in case of invalid factor
+   */
+  static void imageDownsample(const std::string &inputImage, const std::string &outputImage, ImageInfo &imageInfo, int factor);
+
+  /*!
+   @brief Crop a window of Z slices (full X/Y extent) without resampling
+   @param[in] inputImage  Input 3D image file
+   @param[in] outputImage  Output (cropped) image file
+   @param[in] firstSlice  First Z slice of window
+   @param[in] sliceCount  Number of slices in window (clipped to image size)
+   @param[out] imageInfo  Crop information of the window (use imagePostProcess() to restore a window sized mask to image size)
+
+   @throw nvidia.aiaa.error.103 in case of ITK error related to image processing
+   @throw nvidia.aiaa.error.104 in case window is outside of image
+   */
+  static void imageSliceWindow(const std::string &inputImage, const std::string &outputImage, int firstSlice, int sliceCount,
+                               ImageInfo &imageInfo);
+
+  /*!
+   @brief Connected component clean-up of a mask (6-connectivity); only the bounding box of the mask is scanned
+   @param[in] inputImage  Input 3D mask file (non-zero voxels are foreground; label values are preserved)
+   @param[in] outputImage  Output mask file (can be same as input)
+   @param[in] keepLargest  Keep only the largest N components; 0 keeps all
+   @param[in] minSize  Remove components (islands) smaller than minSize voxels; 0 keeps all
+   @param[in] fillHoles  Fill background regions which are fully enclosed by the mask
+
+   @throw nvidia.aiaa.error.103 in case of ITK error related to image processing
+   */
+  static void imageComponentFilter(const std::string &inputImage, const std::string &outputImage, int keepLargest, int minSize, bool fillHoles);
+
+  /*!
+   @brief 3D mask to polygons (per Z slice) conversion on CPU; slices are traced in parallel (see Polygons::fromMask)
+   @param[in] inputImage  Input 3D mask file (non-zero voxels are foreground)
+   @param[in] pointRatio  Every pointRatio-th contour vertex is kept
+
+   @return PolygonsList with one entry per slice (empty Polygons for slices without foreground)
+
+   @throw nvidia.aiaa.error.103 in case of ITK error related to image processing
+   */
+  static PolygonsList imageMaskToPolygon(const std::string &inputImage, int pointRatio);
+
+  /*!
+   @brief 3D mask to polygons conversion on CPU (same as imageMaskToPolygon) into contiguous storage
+   @param[in] inputImage  Input 3D mask file (non-zero voxels are foreground)
+   @param[in] pointRatio  Every pointRatio-th contour vertex is kept
+
+   @return FlatPolygonsList with one slice per Z slice
+
+   @throw nvidia.aiaa.error.103 in case of ITK error related to image processing
+   */
+  static FlatPolygonsList imageMaskToFlatPolygons(const std::string &inputImage, int pointRatio);
+
+  /// How overlapping tiles are combined by imageTileStitch
+  enum TileStitching {
+    /// Most frequent label among all tiles covering the voxel
+    STITCH_MAJORITY,
+    /// Max value among all tiles covering the voxel (tiles are probability maps)
+    STITCH_MAX_PROBABILITY,
+    /// Value from the tile whose center is nearest to the voxel (overlap region is split in half)
+    STITCH_CENTER_CROP
+  };
+
+  /*!
+   @brief Split image into a regular grid of overlapping tiles (last tile along each axis is aligned to the image border)
+   @param[in] inputImage  Input 3D image file
+   @param[in] tileSize  Tile size in [x,y,z] format (clipped to image size)
+   @param[in] overlap  Overlap (in voxels) between neighbouring tiles
+
+   @return List of tiles as crop regions (use imageCrop() to extract them)
+
+   @throw nvidia.aiaa.error.103 in case of ITK error related to image processing
+   @throw nvidia.aiaa.error.104 in case of invalid tile size/overlap
+   */
+  static std::vector<ImageInfo> imageTiles(const std::string &inputImage, const std::vector<int> &tileSize, int overlap);
+
+  /*!
+   @brief Crop (without resampling) many regions of an image; image is read once and crops are written in parallel
+   @param[in] inputImage  Input 3D image file
+   @param[in] outputImages  Output (cropped) image files
+   @param[in] imageInfos  Crop information for each output image
+
+   @throw nvidia.aiaa.error.103 in case of ITK error related to image processing
+   @throw nvidia.aiaa.error.104 in case of mismatch in number of outputImages/imageInfos
+   */
+  static void imageCrop(const std::string &inputImage, const std::vector<std::string> &outputImages, const std::vector<ImageInfo> &imageInfos);
+
+  /*!
+   @brief Stitch result images of tiles (see imageTiles) into a single image of original size
+   @param[in] tileImages  Result image for each tile (same size as tile)
+   @param[in] tiles  Tiles as returned by imageTiles()
+   @param[in] outputImage  Output (stitched) image file
+   @param[in] stitching  How overlapping tiles are combined
+
+   @throw nvidia.aiaa.error.103 in case of ITK error related to image processing
+   @throw nvidia.aiaa.error.104 in case of mismatch in number of tileImages/tiles or tiles not forming a complete grid over the image
+   */
+  static void imageTileStitch(const std::vector<std::string> &tileImages, const std::vector<ImageInfo> &tiles, const std::string &outputImage,
+                              TileStitching stitching);
+
   // Pre Process
   static PointSet imagePreProcess(const PointSet &pointSet, const std::string &inputImage, const std::string &outputImage, ImageInfo &imageInfo,
                                   double PAD, const Point& ROI);
 
+  // Pre Process multiple ROIs (e.g. one per organ) from a single decode of the input image; crops run in parallel
+  static std::vector<PointSet> imagePreProcess(const std::vector<PointSet> &pointSets, const std::string &inputImage,
+                                               const std::vector<std::string> &outputImages, std::vector<ImageInfo> &imageInfos,
+                                               const std::vector<double> &PAD, const std::vector<Point> &ROI);
+
   /// Post Process
   static void imagePostProcess(const std::string &inputImage, const std::string &outputImage, const ImageInfo &imageInfo);
+
+  /// Post Process into caller-provided full size label buffer (imageInfo.imageSize, X fastest); only the crop region is written
+  static void imagePostProcess(const std::string &inputImage, unsigned char *labelBuffer, const ImageInfo &imageInfo);
+  static void imagePostProcess(const std::string &inputImage, unsigned short *labelBuffer, const ImageInfo &imageInfo);
+
+  /// Post Process to crop sized image only (ROI); imageInfo.cropIndex is the offset of ROI within the original image
+  static void imagePostProcessROI(const std::string &inputImage, const std::string &outputImage, const ImageInfo &imageInfo);
 };
 
 }
@@ -0,0 +1,314 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "exception.h"
+#include "log.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace nvidia {
+namespace aiaa {
+
+/*!
+ @brief Compact binary encoding of nested integer arrays (PointSet, Polygons, PolygonsList)
+
+ Layout (all integers are LEB128 varints; coordinates are zigzag encoded deltas):
+ @code
+ "AIAB" version(1 byte) depth(1 byte) dims
+ count(level 0) [size in bytes of each level 0 element; only if depth > 2]
+ element*
+ @endcode
+ Arrays at levels 1..depth-3 and the vertex lists (level depth-2) are prefixed by their count; vertices (last level) have
+ *dims* values (or a count prefix when dims is 0, i.e. ragged points). Each coordinate is stored as the difference to the
+ same coordinate of previous vertex in the vertex list
+ */
+const char BINARY_ARRAY_CONTENT_TYPE[] = "application/x-aiaa-array";
+
+const char BINARY_ARRAY_MAGIC[] = "AIAB";
+const int BINARY_ARRAY_VERSION = 1;
+
+/// Max values per vertex (points are 2D/3D/4D)
+const int BINARY_ARRAY_MAX_DIMS = 4;
+
+/// Checks if data starts with binary array magic
+inline bool isBinaryArray(const std::string &data) {
+  return data.compare(0, 4, BINARY_ARRAY_MAGIC) == 0;
+}
+
+/// Common dimensionality of points (0 if points are of different size; -1 if there are no points yet)
+template<class TPoints>
+void binaryArrayDims(const TPoints &points, int &dims) {
+  for (const auto &p : points) {
+    int n = static_cast<int>(p.size());
+    dims = dims < 0 ? n : (dims == n ? dims : 0);
+  }
+}
+
+class BinaryWriter {
+ public:
+  explicit BinaryWriter(size_t reserveSize = 0) {
+    out.reserve(reserveSize);
+  }
+
+  BinaryWriter &header(int depth, int dims) {
+    out.append(BINARY_ARRAY_MAGIC, 4);
+    out.push_back(static_cast<char>(BINARY_ARRAY_VERSION));
+    out.push_back(static_cast<char>(depth));
+    varint(dims < 0 ? 2 : dims);
+    this->dims = dims < 0 ? 2 : dims;
+    return *this;
+  }
+
+  BinaryWriter &varint(uint64_t v) {
+    while (v >= 0x80) {
+      out.push_back(static_cast<char>((v & 0x7F) | 0x80));
+      v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+    return *this;
+  }
+
+  BinaryWriter &svarint(int64_t v) {
+    return varint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+  }
+
+  /// Vertex list (count + delta encoded vertices); dims of writer must be set (header or setDims)
+  template<class TPoints>
+  BinaryWriter &vertices(const TPoints &points) {
+    varint(points.size());
+    resetDelta();
+    for (const auto &p : points) {
+      vertex(p.data(), p.size());
+    }
+    return *this;
+  }
+
+  void resetDelta() {
+    previous.assign(previous.size(), 0);
+  }
+
+  /// Single vertex (delta to previous vertex since last resetDelta)
+  void vertex(const int *p, size_t n) {
+    size_t count = dims ? static_cast<size_t>(dims) : n;
+    if (!dims) {
+      varint(n);
+    }
+    if (previous.size() < count) {
+      previous.resize(count, 0);
+    }
+    for (size_t i = 0; i < count; i++) {
+      int v = i < n ? p[i] : 0;
+      svarint(static_cast<int64_t>(v) - previous[i]);
+      previous[i] = v;
+    }
+  }
+
+  void setDims(int d) {
+    dims = d;
+  }
+  BinaryWriter &raw(const std::string &s) {
+    out.append(s);
+    return *this;
+  }
+  size_t size() const {
+    return out.size();
+  }
+  std::string release() {
+    return std::move(out);
+  }
+
+ private:
+  std::string out;
+  int dims = 2;
+  std::vector<int> previous;
+};
+
+class BinaryReader {
+ public:
+  explicit BinaryReader(const std::string &data)
+      :
+      p(reinterpret_cast<const unsigned char*>(data.data())),
+      begin(p),
+      end(p + data.size()) {
+  }
+
+  /// Validates header and returns dims
+  int header(int depth) {
+    if (static_cast<size_t>(end - p) < 6 || std::string(reinterpret_cast<const char*>(p), 4) != BINARY_ARRAY_MAGIC) {
+      fail("Invalid binary array (magic)");
+    }
+    if (p[4] != BINARY_ARRAY_VERSION || p[5] != depth) {
+      fail("Unsupported binary array (version/depth)");
+    }
+    p += 6;
+    uint64_t dims = varint();
+    if (dims > BINARY_ARRAY_MAX_DIMS) {
+      fail("Unsupported binary array (dims)");
+    }
+    return static_cast<int>(dims);
+  }
+
+  uint64_t varint() {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (p >= end) {
+        fail("Truncated binary array");
+      }
+      unsigned char b = *p++;
+      v |= static_cast<uint64_t>(b & 0x7F) << shift;
+      if (!(b & 0x80)) {
+        return v;
+      }
+    }
+    fail("Invalid varint in binary array");
+    return 0;
+  }
+
+  int64_t svarint() {
+    uint64_t v = varint();
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+  }
+
+  /// Count which can not exceed remaining bytes (each element takes at least one byte)
+  size_t count() {
+    uint64_t n = varint();
+    if (n > static_cast<uint64_t>(end - p)) {
+      fail("Invalid count in binary array");
+    }
+    return static_cast<size_t>(n);
+  }
+
+  size_t position() const {
+    return static_cast<size_t>(p - begin);
+  }
+  bool atEnd() const {
+    return p == end;
+  }
+
+  [[noreturn]] static void fail(const char *msg) {
+    AIAA_LOG_ERROR(msg);
+    throw exception(exception::RESPONSE_PARSE_ERROR, msg);
+  }
+
+ private:
+  const unsigned char *p;
+  const unsigned char *begin;
+  const unsigned char *end;
+};
+
+/*!
+ @brief Decodes binary array (see BINARY_ARRAY_CONTENT_TYPE) in a single pass
+
+ TBuilder receives the same open(level)/close(level)/value(int) events as with JsonArraySax<Depth, TBuilder>
+
+ @throw nvidia.aiaa.error.102 in case of malformed/truncated data
+ */
+template<int Depth, class TBuilder>
+class BinaryArrayDecoder {
+ public:
+  BinaryArrayDecoder(const std::string &data, TBuilder &builder)
+      :
+      reader(data),
+      builder(builder) {
+  }
+
+  void decode() {
+    dims = reader.header(Depth);
+
+    builder.open(0);
+    size_t n = reader.count();
+    if (Depth <= 2) {
+      vertexList(n, 1);
+    } else {
+      std::vector<size_t> sizes(n);
+      for (size_t i = 0; i < n; i++) {
+        sizes[i] = reader.count();
+      }
+
+      for (size_t i = 0; i < n; i++) {
+        size_t start = reader.position();
+        element(1);
+        if (reader.position() - start != sizes[i]) {
+          BinaryReader::fail("Mismatch in binary array offset table");
+        }
+      }
+    }
+    builder.close(0);
+
+    if (!reader.atEnd()) {
+      BinaryReader::fail("Unexpected data after binary array");
+    }
+  }
+
+ private:
+  BinaryReader reader;
+  TBuilder &builder;
+  int dims = 2;
+  std::vector<int64_t> previous;
+
+  void element(int level) {
+    builder.open(level);
+    size_t n = reader.count();
+    if (level == Depth - 2) {
+      vertexList(n, level + 1);
+    } else {
+      for (size_t i = 0; i < n; i++) {
+        element(level + 1);
+      }
+    }
+    builder.close(level);
+  }
+
+  void vertexList(size_t n, int level) {
+    previous.assign(previous.size(), 0);
+    for (size_t i = 0; i < n; i++) {
+      size_t count = dims ? static_cast<size_t>(dims) : reader.count();
+      if (count > BINARY_ARRAY_MAX_DIMS) {
+        BinaryReader::fail("Unsupported binary array (point size)");
+      }
+      if (previous.size() < count) {
+        previous.resize(count, 0);
+      }
+
+      builder.open(level);
+      for (size_t j = 0; j < count; j++) {
+        previous[j] += reader.svarint();
+        builder.value(static_cast<int>(previous[j]));
+      }
+      builder.close(level);
+    }
+  }
+};
+
+}
+}
@@ -34,12 +34,96 @@
 #include "polygon.h"
 #include "imageinfo.h"
 #include "exception.h"
+#include "aiaautils.h"
+#include "resultcache.h"
 
+#include <functional>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace nvidia {
 namespace aiaa {
 
+////////////
+// Batch //
+////////////
+
+/*!
+ @brief AIAA Batch Job
+
+ Represents one (model, input, output, params) request to be executed as part of Client::batch()
+ */
+struct AIAA_CLIENT_API BatchJob {
+  /// AIAA API to be used for the job
+  enum JobType {
+    SEGMENTATION,
+    INFERENCE
+  };
+
+  /// API to be used (segmentation or inference)
+  JobType type = SEGMENTATION;
+
+  /// Model to be used
+  Model model;
+
+  /// Json String for params (in case of inference API)
+  std::string params;
+
+  /// Input image filename which will be sent to AIAA
+  std::string inputImageFile;
+
+  /// Output image file where Result mask is stored
+  std::string outputImageFile;
+};
+
+/*!
+ @brief AIAA Batch Result
+
+ Status of a BatchJob executed as part of Client::batch()
+ */
+struct AIAA_CLIENT_API BatchResult {
+  /// True if the job is completed successfully
+  bool success = false;
+
+  /// Error id (nvidia.aiaa.error.xxx) if the job failed
+  int errorId = 0;
+
+  /// Error description if the job failed
+  std::string errorMessage;
+
+  /// Extreme points (in case of segmentation API)
+  PointSet points;
+
+  /// JSON response (in case of inference API)
+  std::string response;
+
+  /// Latency (in milli seconds) to complete the job
+  long long latencyInMs = 0;
+};
+
+/*!
+ @brief AIAA Tile Options
+
+ Options for tiled (sliding-window) inference as part of Client::inferenceTiled()
+ */
+struct AIAA_CLIENT_API TileOptions {
+  /// Tile size in [x,y,z] format
+  std::vector<int> tileSize = { 128, 128, 128 };
+
+  /// Overlap (in voxels) between neighbouring tiles
+  int overlap = 16;
+
+  /// How overlapping tile results are combined
+  AiaaUtils::TileStitching stitching = AiaaUtils::STITCH_MAJORITY;
+
+  /// Max number of tiles in flight
+  int concurrency = 4;
+
+  /// Server URIs to dispatch tiles (round robin); If empty then server of the client is used
+  std::vector<std::string> serverUris;
+};
+
 ////////////
 // Client //
 ////////////
@@ -61,6 +145,88 @@ class AIAA_CLIENT_API Client {
    */
   Client(const std::string &serverUri, const int timeoutInSec = 60);
 
+  /*!
+   @brief Enable (opt-in) persistent result cache for segmentation() and inference() APIs
+   @param[in] cacheDir  Directory where results are cached; Empty string disables the cache
+   @param[in] maxSizeInBytes  Max size for all cached results; least recently used entries are evicted beyond this limit
+
+   Cache is used only when *inputImageFile* is provided (not for *sessionId* based requests)
+   */
+  void setResultCache(const std::string &cacheDir, size_t maxSizeInBytes = ResultCache::DEFAULT_MAX_SIZE);
+
+  /*!
+   @brief Enable (opt-in) slab streaming of input image for segmentation() and createSession() APIs
+   @param[in] streamDivisions  Number of slabs; 0 disables it (input image file is uploaded as is)
+
+   Input images which are not already *.nii.gz* are re-encoded slab by slab (see AiaaUtils::imageConvert) into a temporary
+   *.nii.gz* before upload; peak memory stays proportional to slab size instead of volume size
+   */
+  void setUploadStreamDivisions(unsigned int streamDivisions);
+
+  /*!
+   @brief Enable (opt-in) model-aware quantization of input image for segmentation() and inference() APIs
+   @param[in] type  Quantization type (int16/uint8); AiaaUtils::QUANTIZE_NONE disables it
+   @param[in] allowRescale  Allow quantization which rescales intensities (uint8, or int16 with a window outside int16 range)
+
+   Applies only to models which publish *intensity_window*; input image is clipped to the window and quantized before upload.
+   Scale/offset are sent in params as {"quantization": {"type": .., "scale": .., "offset": .., "window": [..]}}
+
+   int16 with a window inside int16 range only clamps intensities (scale = 1, offset = 0) and works with any server.
+   Any other case rescales intensities; a stock AIAA server does NOT undo it, so it is skipped (input image is uploaded without
+   quantization) unless *allowRescale* is set. Set it only for a server which de-quantizes the input (value * scale + offset)
+   using the *quantization* param
+   */
+  void setUploadQuantization(AiaaUtils::QuantizationType type, bool allowRescale = false);
+
+  /*!
+   @brief Enable (opt-in) foreground (body) bounding box crop of input image for segmentation() API
+   @param[in] enable  Enable/Disable foreground crop
+   @param[in] threshold  Voxels with intensity above threshold are foreground (default suits CT; air is around -1000 HU)
+   @param[in] marginInVoxels  Margin (in voxels) added around foreground bounding box
+
+   Only the bounding box is uploaded (see AiaaUtils::imageForegroundCrop); result mask is re-embedded into original image space
+   and returned points are shifted back to original image indices
+   */
+  void setForegroundCrop(bool enable, double threshold = DEFAULT_FOREGROUND_THRESHOLD, int marginInVoxels = DEFAULT_FOREGROUND_MARGIN);
+
+  /*!
+   @brief Enable (opt-in) connected component clean-up of result mask for segmentation() and dextr3D() APIs
+   @param[in] keepLargest  Keep only the largest N components; 0 keeps all
+   @param[in] minComponentSize  Remove islands smaller than this (in voxels); 0 keeps all
+   @param[in] fillHoles  Fill holes which are fully enclosed by the mask
+
+   All zero/false disables it (see AiaaUtils::imageComponentFilter)
+   */
+  void setResultCleanup(int keepLargest, int minComponentSize = 0, bool fillHoles = false);
+
+  /*!
+   @brief Enable (opt-in) compact binary polygon responses for maskToPolygon() and fixPolygon() APIs
+   @param[in] enable  Enable/Disable binary polygons
+
+   Binary encoding (delta + varint coded coordinates; Content-Type: application/x-aiaa-array) is requested through Accept header
+   and is decoded directly into Polygons/PolygonsList; JSON is used when server responds with any other Content-Type
+   */
+  void setBinaryPolygons(bool enable);
+
+  /*!
+   @brief Enable (opt-in) sending many vertex edits of fixPolygon() in a single request
+   @param[in] enable  Enable/Disable batched vertex edits
+
+   Batched edits are sent as *vertex_edits* list which needs a server supporting it. When disabled (default) each edit is sent
+   as its own request (polygon_index/vertex_index/vertex_offset) on top of the result of the previous one; as the server re-traces
+   the polygons, every following edit is re-targeted to the vertex nearest to its original position (see VertexEdit::applySequential)
+   */
+  void setBatchedVertexEdits(bool enable);
+
+  /*!
+   @brief Enable (opt-in) client-side simplification of maskToPolygon() result
+   @param[in] tolerance  Tolerance in pixels; <= 0 disables it
+   @param[in] method  Simplification algorithm
+
+   Nearly collinear vertices are removed (see PolygonsList::simplify) which reduces size of polygons passed to fixPolygon()
+   */
+  void setPolygonSimplification(double tolerance, Polygons::SimplifyMethod method = Polygons::SIMPLIFY_DOUGLAS_PEUCKER);
+
   /*!
    @brief This API is used to fetch a specific Model supported by AIAA Server
    @return ModelList object representing a list of Models
@@ -134,6 +300,26 @@ class AIAA_CLIENT_API Client {
   PointSet segmentation(const Model &model, const std::string &inputImageFile, const std::string &outputImageFile,
                         const std::string &sessionId = "") const;
 
+  /*!
+   @brief This API is used to run coarse-to-fine (progressive) segmentation on input image
+   @param[in] model  Model to be used
+   @param[in] inputImageFile  Input (3D) image filename
+   @param[in] outputImageFile  Output image file where Result mask is stored
+   @param[in] onCoarse  Called once coarse result is available; *outputImageFile* then holds the upsampled coarse mask
+   @param[in] downsampleFactor  Downsample factor (per axis) for coarse request
+   @return PointSet object representing extreme points on (refined) label image
+
+   Coarse request uploads downsampled image; refined request uploads full resolution image restricted to bounding box
+   of coarse mask. Refined mask replaces the coarse one in *outputImageFile*. If coarse mask is empty, refine is skipped
+   and result of a single full resolution segmentation() is returned instead
+
+   @throw nvidia.aiaa.error.101 in case of connect error
+   @throw nvidia.aiaa.error.103 if case of ITK error related to image processing
+   */
+  PointSet segmentationProgressive(const Model &model, const std::string &inputImageFile, const std::string &outputImageFile,
+                                   const std::function<void(const PointSet &coarsePoints)> &onCoarse,
+                                   int downsampleFactor = DEFAULT_PROGRESSIVE_FACTOR) const;
+
   /*!
    @brief 3D image annotation using DEXTR3D method
    @param[in] model  Model to be used
@@ -154,6 +340,27 @@ class AIAA_CLIENT_API Client {
   int dextr3D(const Model &model, const PointSet &pointSet, const std::string &inputImageFile, const std::string &outputImageFile, bool preProcess,
               const std::string &sessionId = "") const;
 
+  /*!
+   @brief 3D image annotation of multiple organs using DEXTR3D method
+
+   Input image is decoded only once; cropping, requests to AIAA and post-processing run in parallel for each organ
+
+   @param[in] models  Model to be used for each organ
+   @param[in] pointSets  PointSet (extreme points) for each organ. Minimum Client::MIN_POINTS_FOR_SEGMENTATION are expected per organ
+   @param[in] inputImageFile  Input image filename which will be pre-processed (cropped) for every organ
+   @param[in] outputImageFiles  Output image file for each organ where Result mask is stored
+
+   @retval 0 Success
+   @retval -1 Input Model name is empty
+   @retval -2 Insufficient Points in the input
+
+   @throw nvidia.aiaa.error.101 in case of connect error
+   @throw nvidia.aiaa.error.103 if case of ITK error related to image processing
+   @throw nvidia.aiaa.error.104 in case of mismatch in number of models/pointSets/outputImageFiles
+   */
+  int dextr3D(const std::vector<Model> &models, const std::vector<PointSet> &pointSets, const std::string &inputImageFile,
+              const std::vector<std::string> &outputImageFiles) const;
+
   /*!
    @brief This API is used to run deepgrow on input image
    @param[in] model  Model to be used
@@ -188,17 +395,53 @@ class AIAA_CLIENT_API Client {
    */
   std::string inference(const Model &model, const std::string &params, const std::string &inputImageFile, const std::string &outputImageFile,
                         const std::string &sessionId = "") const;
+
+  /*!
+   @brief This API is used to run generic inference on a (large) input image as overlapping tiles dispatched concurrently
+   @param[in] model  Model to be used (same for all tiles)
+   @param[in] params  Json String which will be an input for AIAA to run the model inference (same for all tiles)
+   @param[in] inputImageFile  Input 3D image filename
+   @param[in] outputImageFile  Output image file where stitched Result mask is stored
+   @param[in] options  Tile size, overlap, stitching, concurrency and servers
+
+   @retval JSON response from AIAA for each tile
+
+   @throw nvidia.aiaa.error.101 in case of connect error
+   @throw nvidia.aiaa.error.103 if case of ITK error related to image processing
+   */
+  std::vector<std::string> inferenceTiled(const Model &model, const std::string &params, const std::string &inputImageFile,
+                                          const std::string &outputImageFile, const TileOptions &options = TileOptions()) const;
   /*!
    @brief 3D binary mask to polygon representation conversion
    @param[in] pointRatio  Point Ratio
    @param[in] inputImageFile  Input image filename which will be sent to AIAA
+   @param[in] local  Trace contours locally on CPU (see AiaaUtils::imageMaskToPolygon) instead of sending the mask to AIAA
+
+   Result is simplified when enabled through setPolygonSimplification()
 
    @return PolygonsList object representing a list of Polygons across each image slice
 
    @throw nvidia.aiaa.error.101 in case of connect error
    @throw nvidia.aiaa.error.102 if case of response parsing
+   @throw nvidia.aiaa.error.103 if case of ITK error related to image processing (local)
    */
-  PolygonsList maskToPolygon(int pointRatio, const std::string &inputImageFile) const;
+  PolygonsList maskToPolygon(int pointRatio, const std::string &inputImageFile, bool local = false) const;
+
+  /*!
+   @brief 3D binary mask to polygon representation conversion into contiguous storage (see FlatPolygonsList)
+   @param[in] pointRatio  Point Ratio
+   @param[in] inputImageFile  Input image filename which will be sent to AIAA
+   @param[in] local  Trace contours locally on CPU (see AiaaUtils::imageMaskToFlatPolygons) instead of sending the mask to AIAA
+
+   Response is decoded directly into flat storage (no per-vertex allocations); setPolygonSimplification() is not applied
+
+   @return FlatPolygonsList object with one slice per image slice
+
+   @throw nvidia.aiaa.error.101 in case of connect error
+   @throw nvidia.aiaa.error.102 if case of response parsing
+   @throw nvidia.aiaa.error.103 if case of ITK error related to image processing (local)
+   */
+  FlatPolygonsList maskToFlatPolygons(int pointRatio, const std::string &inputImageFile, bool local = false) const;
 
   /*!
    @brief 2D polygon update with single point edit
@@ -208,7 +451,7 @@ class AIAA_CLIENT_API Client {
    @param[in] vertexIndex  Vertex among the polygon which needs an update
    @param[in] vertexOffset  [x,y] offset which will be added to corresponding poly[polyIndex][vertexIndex][x,y] to the new polygon
    @param[in] inputImageFile  Input 2D Slice Image File in PNG format
-   @param[in] outputImageFile  Output Image File in PNG format
+   @param[in] outputImageFile  Output Image File in PNG format (empty to skip it; use Polygons::toMask on the result instead)
 
    @return Polygons object representing set of updated polygons
 
@@ -218,6 +461,26 @@ class AIAA_CLIENT_API Client {
   Polygons fixPolygon(const Polygons &poly, int neighborhoodSize, int polyIndex, int vertexIndex, const int vertexOffset[2],
                       const std::string &inputImageFile, const std::string &outputImageFile) const;
 
+  /*!
+   @brief 2D polygon update with many vertex edits (see Polygons::diff)
+   @param[in] poly  Set of current or old Polygons
+   @param[in] neighborhoodSize  NeighborHood Size for propagation (across polygons)
+   @param[in] edits  Vertex edits w.r.t. poly (sliceIndex is ignored)
+   @param[in] inputImageFile  Input 2D Slice Image File in PNG format
+   @param[in] outputImageFile  Output Image File in PNG format (empty to skip it; use Polygons::toMask on the result instead)
+
+   A single edit is sent as polygon_index/vertex_index/vertex_offset (same as single point edit); more edits are sent one request
+   per edit, or as *vertex_edits* list in a single request if enabled through setBatchedVertexEdits()
+
+   @return Polygons object representing set of updated polygons
+
+   @throw nvidia.aiaa.error.101 in case of connect error
+   @throw nvidia.aiaa.error.102 if case of response parsing
+   @throw nvidia.aiaa.error.104 in case of no edits (or invalid edit when sent one request per edit)
+   */
+  Polygons fixPolygon(const Polygons &poly, int neighborhoodSize, const std::vector<VertexEdit> &edits, const std::string &inputImageFile,
+                      const std::string &outputImageFile) const;
+
   /*!
    @brief 3D polygon update with single point edit
    @param[in] poly  Set of current or old Polygons
@@ -228,7 +491,7 @@ class AIAA_CLIENT_API Client {
    @param[in] vertexIndex  Vertex among the polygon which needs an update
    @param[in] vertexOffset  [x,y] offset which will be added to corresponding poly[polyIndex][vertexIndex][x,y] to the new polygon
    @param[in] inputImageFile  Input 3D Slice Image File in NIFTI format
-   @param[in] outputImageFile  Output Image File in NIFTI format
+   @param[in] outputImageFile  Output Image File in NIFTI format (empty to skip it; use PolygonsList::toMask on the result instead)
 
    @return Polygons object representing set of updated polygons
 
@@ -238,13 +501,117 @@ class AIAA_CLIENT_API Client {
   PolygonsList fixPolygon(const PolygonsList &poly, int neighborhoodSize, int neighborhoodSize3D, int sliceIndex, int polyIndex, int vertexIndex,
                           const int vertexOffset[2], const std::string &inputImageFile, const std::string &outputImageFile) const;
 
+  /*!
+   @brief 3D polygon update with many vertex edits across slices (see PolygonsList::diff and setBatchedVertexEdits())
+   @param[in] poly  Set of current or old Polygons
+   @param[in] neighborhoodSize  NeighborHood Size for propagation (across polygons)
+   @param[in] neighborhoodSize3D  3D NeighborHood Size for propagation (across slices)
+   @param[in] edits  Vertex edits w.r.t. poly
+   @param[in] inputImageFile  Input 3D Slice Image File in NIFTI format
+   @param[in] outputImageFile  Output Image File in NIFTI format (empty to skip it; use PolygonsList::toMask on the result instead)
+
+   @return PolygonsList object representing updated polygons
+
+   @throw nvidia.aiaa.error.101 in case of connect error
+   @throw nvidia.aiaa.error.102 if case of response parsing
+   @throw nvidia.aiaa.error.104 in case of no edits (or invalid edit when sent one request per edit)
+   */
+  PolygonsList fixPolygon(const PolygonsList &poly, int neighborhoodSize, int neighborhoodSize3D, const std::vector<VertexEdit> &edits,
+                          const std::string &inputImageFile, const std::string &outputImageFile) const;
+
+  /*!
+   @brief Incremental 3D polygon update with single point edit; only the slice window which can change is sent
+   @param[in,out] poly  Polygons of all slices; slices within the window are replaced by the updated ones
+   @param[in] neighborhoodSize  NeighborHood Size for propagation (across polygons)
+   @param[in] neighborhoodSize3D  3D NeighborHood Size for propagation (across slices); window is sliceIndex +/- neighborhoodSize3D
+   @param[in] sliceIndex  Slice Index to get the corresponding polygons for editing
+   @param[in] polyIndex  Polygon index among which needs an update
+   @param[in] vertexIndex  Vertex among the polygon which needs an update
+   @param[in] vertexOffset  [x,y] offset which will be added to corresponding poly[polyIndex][vertexIndex][x,y] to the new polygon
+   @param[in] inputImageFile  Input 3D Image File in NIFTI format (only the slice window is uploaded)
+   @param[in] outputImageFile  Output Image File in NIFTI format (empty to skip it); full image size, only the slice window has the result mask
+
+   Request carries polygons and image of the window, slice index relative to the window and *slice_offset* (first slice of window);
+   so request size and parse time depend on neighborhoodSize3D and not on number of slices
+
+   @throw nvidia.aiaa.error.101 in case of connect error
+   @throw nvidia.aiaa.error.102 if case of response parsing (or response does not match the window)
+   @throw nvidia.aiaa.error.103 if case of ITK error related to image processing
+   @throw nvidia.aiaa.error.104 in case of invalid slice index
+   */
+  void fixPolygonIncremental(PolygonsList &poly, int neighborhoodSize, int neighborhoodSize3D, int sliceIndex, int polyIndex, int vertexIndex,
+                             const int vertexOffset[2], const std::string &inputImageFile, const std::string &outputImageFile) const;
+
+  /// Incremental 3D polygon update with many vertex edits (see setBatchedVertexEdits()); window covers edited slices +/- neighborhoodSize3D
+  void fixPolygonIncremental(PolygonsList &poly, int neighborhoodSize, int neighborhoodSize3D, const std::vector<VertexEdit> &edits,
+                             const std::string &inputImageFile, const std::string &outputImageFile) const;
+
+  /*!
+   @brief This API is used to run segmentation/inference for many images with bounded parallelism
+   @param[in] jobs  List of jobs to be executed
+   @param[in] concurrency  Max number of requests running in parallel against each AIAA Server
+   @param[in] onComplete  (Optional) callback which is invoked as soon as a job finishes with (job index, result).  Calls are serialized.
+   @param[in] serverUris  (Optional) Server URIs to dispatch jobs (round robin); If empty then server of the client is used
+
+   Each job runs the complete pipeline (upload, inference, result writing) independently; so different stages of
+   different jobs overlap.  A failed job does not abort the rest of the batch.
+   All servers share the settings (and result cache) of this client.
+
+   @return List of BatchResult (same order as jobs)
+   */
+  std::vector<BatchResult> batch(const std::vector<BatchJob> &jobs, int concurrency = 4,
+                                 const std::function<void(size_t, const BatchResult &)> &onComplete = nullptr,
+                                 const std::vector<std::string> &serverUris = std::vector<std::string>()) const;
+
   /// Minimum Number of Points required for segmentation/sampling
   static const int MIN_POINTS_FOR_SEGMENTATION;
 
+  /// Default intensity threshold for foreground crop
+  static const double DEFAULT_FOREGROUND_THRESHOLD;
+
+  /// Default margin (in voxels) for foreground crop
+  static const int DEFAULT_FOREGROUND_MARGIN;
+
+  /// Default downsample factor for coarse request of progressive segmentation
+  static const int DEFAULT_PROGRESSIVE_FACTOR;
+
  private:
   /// Server URI
   std::string serverUri;
   int timeoutInSec;
+
+  /// Result Cache (optional)
+  std::shared_ptr<ResultCache> resultCache;
+
+  /// Number of slabs to stream input image for upload (0 = upload as is)
+  unsigned int uploadStreamDivisions = 0;
+
+  /// Quantization of input image for upload
+  AiaaUtils::QuantizationType uploadQuantization = AiaaUtils::QUANTIZE_NONE;
+  bool uploadQuantizationRescale = false;
+
+  /// Connected component clean-up of result mask
+  int cleanupKeepLargest = 0;
+  int cleanupMinSize = 0;
+  bool cleanupFillHoles = false;
+
+  /// Applies connected component clean-up (if enabled) on result mask
+  void cleanupResult(const std::string &outputImageFile) const;
+
+  /// Request binary polygons (with JSON fallback)
+  bool binaryPolygons = false;
+
+  /// Send many vertex edits in a single request (vertex_edits)
+  bool batchedVertexEdits = false;
+
+  /// Simplification of maskToPolygon result
+  double simplifyTolerance = 0;
+  Polygons::SimplifyMethod simplifyMethod = Polygons::SIMPLIFY_DOUGLAS_PEUCKER;
+
+  /// Foreground crop of input image for segmentation
+  bool foregroundCrop = false;
+  double foregroundThreshold = DEFAULT_FOREGROUND_THRESHOLD;
+  int foregroundMargin = DEFAULT_FOREGROUND_MARGIN;
 };
 
 }
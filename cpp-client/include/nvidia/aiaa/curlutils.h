@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <functional>
 #include <string>
 
 namespace nvidia {
@@ -36,10 +37,14 @@ namespace aiaa {
 class CurlUtils {
  public:
   static std::string doMethod(const std::string &method, const std::string &uri, int timeoutInSec);
+  // accept (if not empty) is sent as Accept header; contentType (if not null) receives Content-Type of the (text) response
+  // resultWritten (if not null) tells whether the response carried a result image which was written into resultFileName
   static std::string doMethod(const std::string &method, const std::string &uri, const std::string &paramStr, const std::string &uploadFilePath,
-                              int timeoutInSec);
+                              int timeoutInSec, const std::string &accept = "", std::string *contentType = nullptr);
   static std::string doMethod(const std::string &method, const std::string &uri, const std::string &paramStr, const std::string &uploadFilePath,
-                              const std::string &resultFileName, int timeoutInSec);
+                              const std::string &resultFileName, int timeoutInSec,
+                              const std::function<void(const char*, size_t)> &onData = nullptr, const std::string &accept = "",
+                              std::string *contentType = nullptr, bool *resultWritten = nullptr);
 
   static std::string encode(const std::string &param);
 };
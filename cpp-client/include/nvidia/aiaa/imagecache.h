@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "aiaautils.h"
+
+#include <itkDataObject.h>
+
+#include <list>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <typeinfo>
+
+#include <Poco/File.h>
+#include <Poco/Exception.h>
+
+namespace nvidia {
+namespace aiaa {
+
+// In-process LRU of decoded images; keyed by path, modification time, file size and pixel type
+class AIAA_CLIENT_API ImageCache {
+ public:
+  static ImageCache& instance();
+
+  template<class TImage>
+  static std::string key(const std::string &fileName) {
+    try {
+      Poco::File f(fileName);
+      std::stringstream ss;
+      ss << fileName << '|' << f.getLastModified().epochMicroseconds() << '|' << f.getSize() << '|' << typeid(TImage).name();
+      return ss.str();
+    } catch (Poco::Exception &e) {
+      return std::string();
+    }
+  }
+
+  void setMaxSize(size_t size);
+  size_t getMaxSize();
+
+  itk::DataObject::Pointer get(const std::string &key);
+  void put(const std::string &key, itk::DataObject::Pointer image, size_t size);
+
+  // Drop all entries of fileName (any version/pixel type); e.g. once a temporary file is removed
+  void erase(const std::string &fileName);
+
+ private:
+  struct Entry {
+    std::string key;
+    itk::DataObject::Pointer image;
+    size_t size;
+  };
+
+  std::list<Entry> entries;  // most recently used first
+  size_t totalSize = 0;
+  size_t maxSize = AiaaUtils::DEFAULT_IMAGE_CACHE_SIZE;
+  std::mutex lock;
+
+  void evict();
+};
+
+}
+}
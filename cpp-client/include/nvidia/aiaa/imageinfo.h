@@ -30,8 +30,8 @@
 
 #include "common.h"
 
+#include <array>
 #include <string>
-#include <vector>
 
 namespace nvidia {
 namespace aiaa {
@@ -48,13 +48,13 @@ namespace aiaa {
 
 struct AIAA_CLIENT_API ImageInfo {
   /// Original Size in [x,y,z] format
-  std::vector<int> imageSize = { 0, 0, 0, 0 };
+  std::array<int, 4> imageSize = { { 0, 0, 0, 0 } };
 
   /// Cropped Size in [x,y,z] format
-  std::vector<int> cropSize = { 0, 0, 0, 0 };
+  std::array<int, 4> cropSize = { { 0, 0, 0, 0 } };
 
   /// Cropped Index in [x,y,z] format
-  std::vector<int> cropIndex = { 0, 0, 0, 0 };
+  std::array<int, 4> cropIndex = { { 0, 0, 0, 0 } };
 
   /// Check if ImageInfo is empty
   bool empty() const;
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "exception.h"
+#include "log.h"
+
+#include <nlohmann/json.hpp>
+#include <string>
+
+namespace nvidia {
+namespace aiaa {
+
+/*!
+ @brief Base for single-pass (SAX) JSON parsers
+
+ Every event is rejected by default; derived handlers hide the events they accept (nlohmann::json::sax_parse is a template
+ on the handler type, so no virtual dispatch is involved)
+ */
+class JsonSax {
+ public:
+  using number_integer_t = nlohmann::json::number_integer_t;
+  using number_unsigned_t = nlohmann::json::number_unsigned_t;
+  using number_float_t = nlohmann::json::number_float_t;
+  using string_t = nlohmann::json::string_t;
+
+  bool null() {
+    return unexpected("null");
+  }
+  bool boolean(bool) {
+    return unexpected("boolean");
+  }
+  bool number_integer(number_integer_t) {
+    return unexpected("number");
+  }
+  bool number_unsigned(number_unsigned_t) {
+    return unexpected("number");
+  }
+  bool number_float(number_float_t, const string_t&) {
+    return unexpected("number");
+  }
+  bool string(string_t&) {
+    return unexpected("string");
+  }
+  template<class TBinary>
+  bool binary(TBinary&) {
+    return unexpected("binary");
+  }
+  bool start_object(std::size_t) {
+    return unexpected("object");
+  }
+  bool key(string_t&) {
+    return unexpected("key");
+  }
+  bool end_object() {
+    return unexpected("object");
+  }
+  bool start_array(std::size_t) {
+    return unexpected("array");
+  }
+  bool end_array() {
+    return unexpected("array");
+  }
+  bool parse_error(std::size_t, const std::string&, const nlohmann::json::exception &e) {
+    error = e.what();
+    return false;
+  }
+
+  /// Reason of failure
+  std::string error;
+
+ protected:
+  bool unexpected(const char *what) {
+    error = std::string("Unexpected JSON ") + what;
+    return false;
+  }
+};
+
+/*!
+ @brief Parses json with handler in a single pass
+
+ @throw nvidia.aiaa.error.102 in case of malformed JSON or unexpected content
+ */
+template<class THandler>
+void jsonSaxParse(const std::string &json, THandler &handler) {
+  if (!nlohmann::json::sax_parse(json, &handler)) {
+    AIAA_LOG_ERROR(handler.error << "; JSON: " << json.substr(0, 256));
+    throw exception(exception::RESPONSE_PARSE_ERROR, handler.error.c_str());
+  }
+}
+
+/*!
+ @brief SAX handler for nested arrays of integers (e.g. [[x,y,z],...]) with fixed nesting depth
+
+ Target array is either the top level array or the value of *key* in top level object (other values are skipped).
+ TBuilder receives open(level)/close(level) for arrays at level 0..Depth-1 and value(int) for numbers at the last level;
+ null elements are passed as empty arrays
+ */
+template<int Depth, class TBuilder>
+class JsonArraySax : public JsonSax {
+ public:
+  JsonArraySax(TBuilder &builder, const std::string &key)
+      :
+      builder(builder),
+      target(key) {
+  }
+
+  bool null() {
+    if (level >= 0) {
+      if (level + 1 >= Depth) {
+        return unexpected("null");
+      }
+      builder.open(level + 1);
+      builder.close(level + 1);
+    }
+    pending = false;
+    return true;
+  }
+  bool boolean(bool) {
+    return level >= 0 ? unexpected("boolean") : skipValue();
+  }
+  bool number_integer(number_integer_t v) {
+    return number(static_cast<int>(v));
+  }
+  bool number_unsigned(number_unsigned_t v) {
+    return number(static_cast<int>(v));
+  }
+  bool number_float(number_float_t v, const string_t&) {
+    return number(static_cast<int>(v));
+  }
+  bool string(string_t&) {
+    return level >= 0 ? unexpected("string") : skipValue();
+  }
+  bool start_object(std::size_t) {
+    if (level >= 0) {
+      return unexpected("object");
+    }
+    if (!started) {
+      started = true;
+    } else {
+      pending = false;
+      skip++;
+    }
+    return true;
+  }
+  bool key(string_t &k) {
+    pending = skip == 0 && !found && !target.empty() && k == target;
+    return true;
+  }
+  bool end_object() {
+    if (skip > 0) {
+      skip--;
+    }
+    return true;
+  }
+  bool start_array(std::size_t) {
+    if (level >= 0) {
+      if (++level >= Depth) {
+        return unexpected("array");
+      }
+      builder.open(level);
+      return true;
+    }
+
+    if (!started || (pending && skip == 0)) {
+      started = true;
+      found = true;
+      pending = false;
+      level = 0;
+      builder.open(level);
+      return true;
+    }
+
+    started = true;
+    skip++;
+    return true;
+  }
+  bool end_array() {
+    if (level >= 0) {
+      builder.close(level--);
+    } else if (skip > 0) {
+      skip--;
+    }
+    return true;
+  }
+
+ private:
+  TBuilder &builder;
+  std::string target;
+
+  int level = -1;
+  int skip = 0;
+  bool started = false;
+  bool pending = false;
+  bool found = false;
+
+  bool number(int v) {
+    if (level < 0) {
+      return skipValue();
+    }
+    if (level != Depth - 1) {
+      return unexpected("number");
+    }
+    builder.value(v);
+    return true;
+  }
+
+  bool skipValue() {
+    pending = false;
+    return true;
+  }
+};
+
+}
+}
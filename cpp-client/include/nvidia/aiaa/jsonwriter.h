@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <locale>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace nvidia {
+namespace aiaa {
+
+/*!
+ @brief Single-pass JSON writer into one (pre-sized) string; no intermediate DOM
+
+ Commas are inserted automatically; numbers are formatted without streams (except floating point)
+ */
+class JsonWriter {
+ public:
+  explicit JsonWriter(size_t reserveSize = 0) {
+    out.reserve(reserveSize);
+  }
+
+  JsonWriter &beginObject() {
+    separator();
+    out.push_back('{');
+    first.push_back(true);
+    return *this;
+  }
+  JsonWriter &endObject() {
+    first.pop_back();
+    out.push_back('}');
+    return *this;
+  }
+  JsonWriter &beginArray() {
+    separator();
+    out.push_back('[');
+    first.push_back(true);
+    return *this;
+  }
+  JsonWriter &endArray() {
+    first.pop_back();
+    out.push_back(']');
+    return *this;
+  }
+
+  /// Key inside object (escaped as string value); next value does not get a separator
+  JsonWriter &key(const char *k) {
+    separator();
+    quoted(k);
+    out.push_back(':');
+    afterKey = true;
+    return *this;
+  }
+
+  JsonWriter &value(int v) {
+    separator();
+    char buffer[12];
+    char *end = buffer + sizeof(buffer), *p = end;
+    unsigned int u = v < 0 ? 0u - static_cast<unsigned int>(v) : static_cast<unsigned int>(v);
+    do {
+      *--p = static_cast<char>('0' + u % 10);
+      u /= 10;
+    } while (u);
+    if (v < 0) {
+      *--p = '-';
+    }
+    out.append(p, end);
+    return *this;
+  }
+
+  /// Non-finite numbers (nan/inf) are not valid JSON; written as null
+  JsonWriter &value(double v) {
+    separator();
+    if (!std::isfinite(v)) {
+      out.append("null");
+      return *this;
+    }
+
+    std::ostringstream ss;
+    ss.imbue(std::locale::classic());
+    ss.precision(17);
+    ss << v;
+    out.append(ss.str());
+    return *this;
+  }
+
+  JsonWriter &value(bool v) {
+    separator();
+    out.append(v ? "true" : "false");
+    return *this;
+  }
+
+  JsonWriter &value(const std::string &v) {
+    separator();
+    quoted(v);
+    return *this;
+  }
+
+  JsonWriter &value(const char *v) {
+    return value(std::string(v));
+  }
+
+  /// Nested arrays (e.g. std::vector<std::vector<int>>)
+  template<class T>
+  JsonWriter &value(const std::vector<T> &v) {
+    beginArray();
+    for (const auto &e : v) {
+      value(e);
+    }
+    return endArray();
+  }
+
+  /// Already serialized JSON value
+  JsonWriter &raw(const std::string &json) {
+    separator();
+    out.append(json);
+    return *this;
+  }
+
+  const std::string &str() const {
+    return out;
+  }
+
+  std::string release() {
+    return std::move(out);
+  }
+
+  /// Approximate serialized size of nested int arrays (for reserve)
+  template<class T>
+  static size_t estimate(const std::vector<T> &v) {
+    size_t n = 2;
+    for (const auto &e : v) {
+      n += estimate(e) + 1;
+    }
+    return n;
+  }
+  static size_t estimate(int) {
+    return 4;
+  }
+
+ private:
+  std::string out;
+  std::vector<bool> first;
+  bool afterKey = false;
+
+  // Quoted and escaped string (value or key)
+  void quoted(const std::string &v) {
+    out.push_back('"');
+    for (char c : v) {
+      switch (c) {
+        case '"':
+          out.append("\\\"");
+          break;
+        case '\\':
+          out.append("\\\\");
+          break;
+        case '\n':
+          out.append("\\n");
+          break;
+        case '\r':
+          out.append("\\r");
+          break;
+        case '\t':
+          out.append("\\t");
+          break;
+        default:
+          if (static_cast<unsigned char>(c) < 0x20) {
+            const char *hex = "0123456789abcdef";
+            out.append("\\u00");
+            out.push_back(hex[(c >> 4) & 0xF]);
+            out.push_back(hex[c & 0xF]);
+          } else {
+            out.push_back(c);
+          }
+      }
+    }
+    out.push_back('"');
+  }
+
+  void separator() {
+    if (afterKey) {
+      afterKey = false;
+      return;
+    }
+    if (!first.empty()) {
+      if (!first.back()) {
+        out.push_back(',');
+      }
+      first.back() = false;
+    }
+  }
+};
+
+}
+}
@@ -79,6 +79,9 @@ struct AIAA_CLIENT_API Model {
   /// Version of Model
   std::string version;
 
+  /// Intensity window [min, max] applied by the model (if published by AIAA); used for client-side upload quantization
+  std::vector<double> intensity_window;
+
   /*!
    @brief create Model from JSON String
    @param[in] json  JSON String.
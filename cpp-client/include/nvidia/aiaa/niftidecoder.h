@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "common.h"
+
+#include <itk_zlib.h>
+
+#include <string>
+#include <vector>
+
+namespace nvidia {
+namespace aiaa {
+
+// Incremental decoder for (gzipped) NIfTI-1 stream; voxels are inflated and collected while the response is still downloading
+class AIAA_CLIENT_API NiftiStreamDecoder {
+ public:
+  NiftiStreamDecoder();
+  ~NiftiStreamDecoder();
+
+  // Feed next chunk of bytes (gzip, possibly multiple members, or uncompressed); no-op if decoded image cache is disabled
+  void write(const char *data, size_t size);
+
+  // All voxels for the image described by header are received
+  bool complete() const;
+
+  // Publish decoded image for (completely received) fileName into decoded image cache; post-processing then skips reading it again
+  bool publish(const std::string &fileName) const;
+
+ private:
+  z_stream zs;
+  bool started = false;
+  bool gzip = false;
+  bool failed = false;
+
+  std::vector<char> header;
+  bool swap = false;
+  int dims[3] = { 1, 1, 1 };
+  int bitpix = 0;
+  float sclSlope = 0;
+  float sclInter = 0;
+
+  size_t position = 0;
+  size_t voxOffset = 0;
+  size_t expected = 0;
+  std::vector<char> voxels;
+
+  void consume(const char *data, size_t size);
+  bool parseHeader();
+
+  NiftiStreamDecoder(const NiftiStreamDecoder&) = delete;
+  NiftiStreamDecoder& operator=(const NiftiStreamDecoder&) = delete;
+};
+
+}
+}
@@ -30,6 +30,7 @@
 
 #include "common.h"
 
+#include <array>
 #include <vector>
 #include <string>
 
@@ -43,6 +44,32 @@ namespace aiaa {
 /// Type Definition for 2D/3D/4D Point
 typedef std::vector<int> Point;
 
+/// Type Definition for fixed dimension Point (no heap allocation); used internally by pre/post processing
+template<size_t N>
+using PointN = std::array<int, N>;
+
+/// Type Definition for fixed 2D Point
+typedef PointN<2> Point2D;
+
+/// Type Definition for fixed 3D Point
+typedef PointN<3> Point3D;
+
+/// Convert Point to fixed dimension Point (missing values are zero; extra values are ignored)
+template<size_t N>
+PointN<N> toPointN(const Point &point) {
+  PointN<N> p = { };
+  for (size_t i = 0; i < N && i < point.size(); i++) {
+    p[i] = point[i];
+  }
+  return p;
+}
+
+/// Convert fixed dimension Point to Point
+template<size_t N>
+Point toPoint(const PointN<N> &point) {
+  return Point(point.begin(), point.end());
+}
+
 /*!
  @brief AIAA PointSet
  */
@@ -60,6 +87,23 @@ struct AIAA_CLIENT_API PointSet {
   /// Append new Point to points list
   void push_back(Point point);
 
+  /// Append new fixed dimension Point to points list
+  template<size_t N>
+  void push_back(const PointN<N> &point) {
+    points.emplace_back(point.begin(), point.end());
+  }
+
+  /// Points as fixed dimension Points (single allocation for all points)
+  template<size_t N>
+  std::vector<PointN<N>> fixedPoints() const {
+    std::vector<PointN<N>> result;
+    result.reserve(points.size());
+    for (const auto &point : points) {
+      result.push_back(toPointN<N>(point));
+    }
+    return result;
+  }
+
   /*!
    @brief create Model from JSON String
    @param[in] json  JSON String
@@ -80,6 +124,20 @@ struct AIAA_CLIENT_API PointSet {
    @return JSON String
    */
   std::string toJson(int space = 0) const;
+
+  /*!
+   @brief create PointSet from compact binary encoding (see toBinary) in a single pass
+   @param[in] data  Binary data
+   @return PointSet object
+   @throw nvidia.aiaa.error.102
+   */
+  static PointSet fromBinary(const std::string &data);
+
+  /*!
+   @brief convert PointSet to compact binary encoding (delta + varint coded coordinates)
+   @return Binary data
+   */
+  std::string toBinary() const;
 };
 
 }
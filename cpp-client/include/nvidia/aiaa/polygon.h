@@ -30,6 +30,7 @@
 
 #include "common.h"
 
+#include <functional>
 #include <vector>
 #include <utility>
 #include <string>
@@ -41,6 +42,44 @@ namespace aiaa {
 // Polygons //
 ////////////
 
+struct Polygons;
+struct PolygonsList;
+
+/*!
+ @brief Single vertex edit (offset added to poly[polyIndex][vertexIndex]) as computed by Polygons::diff / PolygonsList::diff
+ */
+struct AIAA_CLIENT_API VertexEdit {
+  /// Slice Index (0 for 2D)
+  int sliceIndex = 0;
+
+  /// Polygon Index (within slice)
+  int polyIndex = 0;
+
+  /// Vertex Index (within polygon)
+  int vertexIndex = 0;
+
+  /// Offset (new - old) of first two coordinates
+  int vertexOffset[2] = { 0, 0 };
+
+  /*!
+   @brief Apply edits one at a time, each on top of the result of the previous one (e.g. one fixPolygon request per edit)
+   @param[in,out] poly  Polygons which are edited; apply() replaces them with the (re-traced) result
+   @param[in] edits  Vertex edits w.r.t. poly as it is before the first edit
+   @param[in] apply  Applies a single edit to poly
+
+   Result of an edit can have a different number/order of vertices; so every following edit is re-targeted to the vertex which
+   is nearest to its original (pre-edit) position and its offset is recomputed so that the vertex still ends at original + offset
+
+   @throw nvidia.aiaa.error.104 in case of invalid edit (w.r.t. poly before the first edit)
+   */
+  static void applySequential(Polygons &poly, const std::vector<VertexEdit> &edits,
+                              const std::function<void(Polygons &poly, const VertexEdit &edit)> &apply);
+
+  /// Same as above for edits across slices
+  static void applySequential(PolygonsList &poly, const std::vector<VertexEdit> &edits,
+                              const std::function<void(PolygonsList &poly, const VertexEdit &edit)> &apply);
+};
+
 /*!
  @brief AIAA Polygons
  */
@@ -77,6 +116,25 @@ struct AIAA_CLIENT_API Polygons {
    */
   bool findFirstNonMatching(const Polygons &polygons, int &polyIndex, int &vertexIndex) const;
 
+  /*!
+   @brief Find vertex nearest (first two coordinates) to the given point
+   @param[in] point  Point
+   @param[out] polyIndex  Polygon Index of nearest vertex
+   @param[out] vertexIndex  Vertex Index of nearest vertex
+
+   @return True if there is any vertex (of at least two coordinates)
+   */
+  bool findNearestVertex(const Point &point, int &polyIndex, int &vertexIndex) const;
+
+  /*!
+   @brief Find all changed vertices (in a single pass) w.r.t. older version of polygons
+   @param[in] older  Polygons before the edit (same polygons/vertices; extra polygons or vertices on either side are ignored)
+   @param[in] sliceIndex  Slice Index to be set in each edit
+
+   @return List of VertexEdit (ordered by polygon and vertex) where offset = this - older
+   */
+  std::vector<VertexEdit> diff(const Polygons &older, int sliceIndex = 0) const;
+
   /*!
    @brief create Model from JSON String
    @param[in] json  JSON String.
@@ -97,6 +155,61 @@ struct AIAA_CLIENT_API Polygons {
    @return JSON String
    */
   std::string toJson(int space = 0) const;
+
+  /*!
+   @brief create Polygons by tracing contours of 2D binary mask (marching squares at level 0.5)
+   @param[in] mask  Mask buffer of width x height (X fastest); non-zero is foreground
+   @param[in] width  Width (X) of mask
+   @param[in] height  Height (Y) of mask
+   @param[in] pointRatio  Every pointRatio-th contour vertex is kept (same as *more_points* of AIAA mask2polygon)
+
+   Each outer/hole boundary is one closed polygon of boundary (foreground) pixels in [y,x] order; diagonal foreground pixels are
+   not connected. Contours start at their top-most left-most vertex and are ordered by it
+
+   @return Polygons object
+   */
+  static Polygons fromMask(const unsigned char *mask, int width, int height, int pointRatio = 1);
+
+  /*!
+   @brief Rasterize polygons ([y,x] vertices as produced by fromMask/maskToPolygon) into 2D mask
+   @param[in,out] mask  Mask buffer of width x height (X fastest); pixels inside polygons (even-odd rule) and on their outline are set
+   @param[in] width  Width (X) of mask
+   @param[in] height  Height (Y) of mask
+   @param[in] label  Value written for foreground pixels (other pixels are left untouched)
+   */
+  void toMask(unsigned char *mask, int width, int height, unsigned char label = 1) const;
+
+  /// Polygon simplification algorithms
+  enum SimplifyMethod {
+    /// Douglas-Peucker; drops vertices within tolerance (in pixels) of the simplified outline
+    SIMPLIFY_DOUGLAS_PEUCKER,
+    /// Visvalingam-Whyatt; drops vertices whose effective triangle area is below tolerance^2 (in pixels^2)
+    SIMPLIFY_VISVALINGAM_WHYATT
+  };
+
+  /*!
+   @brief Simplify (closed) polygons in place by removing nearly collinear vertices
+   @param[in] tolerance  Tolerance in pixels; <= 0 keeps all vertices
+   @param[in] method  Simplification algorithm
+
+   Vertex order is preserved and each polygon keeps at least 3 vertices. Use it on maskToPolygon() result or before editing
+   polygons for fixPolygon() (vertex indices of edits must refer to the simplified polygons)
+   */
+  void simplify(double tolerance, SimplifyMethod method = SIMPLIFY_DOUGLAS_PEUCKER);
+
+  /*!
+   @brief create Polygons from compact binary encoding (see toBinary) in a single pass
+   @param[in] data  Binary data
+   @return Polygons object
+   @throw nvidia.aiaa.error.102
+   */
+  static Polygons fromBinary(const std::string &data);
+
+  /*!
+   @brief convert Polygons to compact binary encoding (delta + varint coded coordinates)
+   @return Binary data
+   */
+  std::string toBinary() const;
 };
 
 /*!
@@ -120,6 +233,26 @@ struct AIAA_CLIENT_API PolygonsList {
   /// Flip X,Y points to Y,X
   void flipXY();
 
+  /*!
+   @brief Find all changed vertices across all slices (in a single pass) w.r.t. older version of polygons list
+   @param[in] older  PolygonsList before the edit
+   @return List of VertexEdit (ordered by slice, polygon and vertex) where offset = this - older
+   */
+  std::vector<VertexEdit> diff(const PolygonsList &older) const;
+
+  /*!
+   @brief Rasterize all slices (see Polygons::toMask) into 3D mask; slices are filled in parallel
+   @param[in,out] mask  Mask buffer of width x height x depth (X fastest); slice z is list[z]
+   @param[in] width  Width (X) of mask
+   @param[in] height  Height (Y) of mask
+   @param[in] depth  Depth (Z) of mask; slices beyond list size are left untouched
+   @param[in] label  Value written for foreground pixels
+   */
+  void toMask(unsigned char *mask, int width, int height, int depth, unsigned char label = 1) const;
+
+  /// Simplify polygons of all slices in place (see Polygons::simplify); slices are processed in parallel
+  void simplify(double tolerance, Polygons::SimplifyMethod method = Polygons::SIMPLIFY_DOUGLAS_PEUCKER);
+
   /*!
    @brief create PolygonsList from JSON String
    @param[in] json  JSON String.
@@ -144,6 +277,199 @@ struct AIAA_CLIENT_API PolygonsList {
    @return JSON String
    */
   std::string toJson(int space = 0) const;
+
+  /*!
+   @brief create PolygonsList from compact binary encoding (see toBinary) in a single pass
+   @param[in] data  Binary data
+   @return PolygonsList object
+   @throw nvidia.aiaa.error.102
+   */
+  static PolygonsList fromBinary(const std::string &data);
+
+  /*!
+   @brief convert PolygonsList to compact binary encoding (delta + varint coded coordinates; with per-slice offset table)
+   @return Binary data
+   */
+  std::string toBinary() const;
+};
+
+/*!
+ @brief AIAA List of Polygons in contiguous (flat) storage
+
+ All vertices of all slices live in one coordinate array with fixed dimensionality (*dims* ints per vertex).
+ Polygon *p* owns vertices [polygonOffsets[p], polygonOffsets[p+1]) and slice *s* owns polygons
+ [sliceOffsets[s], sliceOffsets[s+1]); so a 3D result needs three allocations instead of one per vertex
+ */
+struct AIAA_CLIENT_API FlatPolygonsList {
+  /// Read-only view of one polygon (vertex *i* is coords[i * dims ... i * dims + dims - 1])
+  struct PolygonView {
+    /// Coordinates of first vertex
+    const int *coords;
+
+    /// Number of vertices
+    size_t vertices;
+
+    /// Dimensionality of vertex
+    int dims;
+
+    /// Pointer to coordinates of vertex i
+    const int* operator[](size_t i) const {
+      return coords + i * dims;
+    }
+
+    /// Number of vertices
+    size_t size() const {
+      return vertices;
+    }
+
+    /// Iterator over vertices (dereferences to pointer to coordinates of the vertex)
+    struct Iterator {
+      const int *coords;
+      int dims;
+
+      const int* operator*() const {
+        return coords;
+      }
+      Iterator &operator++() {
+        coords += dims;
+        return *this;
+      }
+      bool operator==(const Iterator &other) const {
+        return coords == other.coords;
+      }
+      bool operator!=(const Iterator &other) const {
+        return coords != other.coords;
+      }
+    };
+
+    /// Iterator to first vertex
+    Iterator begin() const {
+      return Iterator { coords, dims };
+    }
+
+    /// Iterator past the last vertex
+    Iterator end() const {
+      return Iterator { coords + vertices * dims, dims };
+    }
+  };
+
+  /// Dimensionality of each vertex
+  int dims = 2;
+
+  /// Coordinates of all vertices [x0,y0,x1,y1,...]
+  std::vector<int> coords;
+
+  /// Vertex offsets per polygon (size = number of polygons + 1)
+  std::vector<size_t> polygonOffsets = { 0 };
+
+  /// Polygon offsets per slice (size = number of slices + 1)
+  std::vector<size_t> sliceOffsets = { 0 };
+
+  /// Checks if there are no slices
+  bool empty() const;
+
+  /// Number of slices
+  size_t size() const;
+
+  /// Number of polygons in slice
+  size_t polygons(size_t slice) const;
+
+  /// Total number of vertices
+  size_t vertices() const;
+
+  /// View of polygon *poly* (index within slice) in slice
+  PolygonView polygon(size_t slice, size_t poly) const;
+
+  /// Append new (empty) slice; polygons are added to the last slice
+  void addSlice();
+
+  /// Append new (empty) polygon to the last slice; vertices are added to the last polygon
+  void addPolygon();
+
+  /*!
+   @brief Append vertex to the last polygon
+   @param[in] point  Coordinates of vertex
+   @param[in] size  Number of coordinates; must be same as *dims*
+   @throw nvidia.aiaa.error.104 in case of empty or ragged vertex
+   */
+  void addVertex(const int *point, size_t size);
+
+  /*!
+   @brief Append new slice with contours of 2D mask as polygons (same as Polygons::fromMask; without per-vertex allocations)
+   @param[in] mask  Mask buffer of width x height (X fastest); non-zero is foreground
+   @param[in] width  Width (X) of mask
+   @param[in] height  Height (Y) of mask
+   @param[in] pointRatio  Every pointRatio-th contour vertex is kept
+   @throw nvidia.aiaa.error.104 if dims is not 2
+   */
+  void addSlice(const unsigned char *mask, int width, int height, int pointRatio = 1);
+
+  /*!
+   @brief Append all slices of other
+   @param[in] other  FlatPolygonsList of same dims
+   @throw nvidia.aiaa.error.104 in case of mismatch in dims
+   */
+  void append(const FlatPolygonsList &other);
+
+  /// Flip X,Y points to Y,X
+  void flipXY();
+
+  /*!
+   @brief Find first vertex which is not matching within a slice
+   @param[in] slice  Slice index
+   @param[in] other  FlatPolygonsList to compare against (same slice index)
+   @param[out] polyIndex  First Polygon Index (within slice) where the polygon is not matching
+   @param[out] vertexIndex  Vertex Index where the Point is not matching
+
+   @return True if non-matching polygon + vertex is found
+   */
+  bool findFirstNonMatching(size_t slice, const FlatPolygonsList &other, int &polyIndex, int &vertexIndex) const;
+
+  /*!
+   @brief create FlatPolygonsList from PolygonsList (dims is taken from the first vertex; default 2)
+   @param[in] polygonsList  PolygonsList object
+   @return FlatPolygonsList object
+   @throw nvidia.aiaa.error.104 in case of empty or ragged vertices
+   */
+  static FlatPolygonsList fromPolygonsList(const PolygonsList &polygonsList);
+
+  /// convert to PolygonsList
+  PolygonsList toPolygonsList() const;
+
+  /// convert slice to Polygons
+  Polygons toPolygons(size_t slice) const;
+
+  /*!
+   @brief create FlatPolygonsList from JSON String (same format as PolygonsList) in a single pass
+   @param[in] json  JSON String.
+   @param[in] key  Specific key inside JSON String that represents PolygonList.
+   @param[in] dims  Dimensionality of vertex
+
+   @return FlatPolygonsList object
+   @throw nvidia.aiaa.error.102 in case of malformed JSON or vertex of size other than dims (including null vertex)
+   */
+  static FlatPolygonsList fromJson(const std::string &json, const std::string &key = "", int dims = 2);
+
+  /*!
+   @brief convert FlatPolygonsList to JSON String (same format as PolygonsList)
+   @param[in] space  If space > 0; then JSON string will be formatted accordingly
+   @return JSON String
+   */
+  std::string toJson(int space = 0) const;
+
+  /*!
+   @brief create FlatPolygonsList from compact binary encoding (see toBinary) in a single pass
+   @param[in] data  Binary data
+   @return FlatPolygonsList object
+   @throw nvidia.aiaa.error.102
+   */
+  static FlatPolygonsList fromBinary(const std::string &data);
+
+  /*!
+   @brief convert FlatPolygonsList to compact binary encoding (delta + varint coded coordinates; same format as PolygonsList)
+   @return Binary data
+   */
+  std::string toBinary() const;
 };
 
 }
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "common.h"
+#include "model.h"
+
+#include <string>
+
+namespace nvidia {
+namespace aiaa {
+
+////////////
+// ResultCache //
+////////////
+
+/*!
+ @brief AIAA Result Cache
+
+ Persistent on-disk LRU cache for results (output image + JSON response) returned by AIAA Server.
+ An entry is keyed by server, api, model name, model version, content hash of the input image and normalized params.
+ Entries are written atomically (temp file + rename) so several processes can safely share the same cache directory.
+ */
+
+class AIAA_CLIENT_API ResultCache {
+ public:
+  /// Default max size for all cached results (1 GB)
+  static const size_t DEFAULT_MAX_SIZE;
+
+  /*!
+   @brief create ResultCache object
+   @param[in] cacheDir  Directory where cached results are stored (created if it does not exist)
+   @param[in] maxSizeInBytes  Max size for all cached results; least recently used entries are evicted beyond this limit
+   */
+  ResultCache(const std::string &cacheDir, size_t maxSizeInBytes = DEFAULT_MAX_SIZE);
+
+  /*!
+   @brief compute cache key
+   @param[in] serverUri  AIAA Server URI which serves the request
+   @param[in] api  API name (for example: segmentation, inference)
+   @param[in] model  Model to be used
+   @param[in] params  Json String which is sent to AIAA as params
+   @param[in] inputImageFile  Input image filename; content of the file is hashed
+   @return Key (hex string) representing the cache entry
+
+   @throw nvidia.aiaa.error.104 if params is not a valid JSON
+   @throw nvidia.aiaa.error.107 if input image can't be read
+   */
+  static std::string key(const std::string &serverUri, const std::string &api, const Model &model, const std::string &params,
+                         const std::string &inputImageFile);
+
+  /*!
+   @brief lookup cache entry
+   @param[in] key  Key for the cache entry
+   @param[in] outputImageFile  If not empty then cached result image is copied into this file
+   @param[out] response  Cached JSON response
+   @return True if cache entry is found
+   */
+  bool get(const std::string &key, const std::string &outputImageFile, std::string &response) const;
+
+  /*!
+   @brief add/replace cache entry
+   @param[in] key  Key for the cache entry
+   @param[in] outputImageFile  Result image produced by the request (stored as part of cache entry); empty if request produced none
+   @param[in] response  JSON response to be stored
+   */
+  void put(const std::string &key, const std::string &outputImageFile, const std::string &response) const;
+
+  /// Remove all the cache entries
+  void clear() const;
+
+ private:
+  /// Evict least recently used entries till total size is within limit
+  void evict() const;
+
+  /// Cache Directory
+  std::string cacheDir;
+
+  /// Max Size in Bytes
+  size_t maxSizeInBytes;
+};
+
+}
+}
@@ -36,6 +36,7 @@
 #include <vector>
 #include <locale>
 #include <sstream>
+#include <functional>
 
 namespace nvidia {
 namespace aiaa {
@@ -84,6 +85,17 @@ class AIAA_CLIENT_API Utils {
    */
   static Point stringToPoint(const std::string &str, char delim);
 
+  /*!
+   @brief run func(i) for each i in [0, n) over a bounded pool of worker threads
+   @param[in] n total number of tasks
+   @param[in] func task to be executed for each index
+   @param[in] threads max number of worker threads; If <= 0 then hardware concurrency is used
+
+   Tasks are picked up dynamically by the workers, in index order.
+   If any task throws, remaining tasks still run and the first exception is re-thrown once all workers are finished.
+   */
+  static void parallelFor(size_t n, const std::function<void(size_t)> &func, int threads = 0);
+
   /*!
    @brief Lexical Cast with locale support
    @param[in] in input string/numeric
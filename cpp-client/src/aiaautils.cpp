@@ -28,66 +28,177 @@
 
 #include "../include/nvidia/aiaa/log.h"
 #include "../include/nvidia/aiaa/exception.h"
-
-#include <itkResampleImageFilter.h>
-#include <itkConnectedComponentImageFilter.h>
-#include <itkLabelShapeKeepNObjectsImageFilter.h>
-#include <itkConstantPadImageFilter.h>
-#include <itkRegionOfInterestImageFilter.h>
-#include <itkLinearInterpolateImageFunction.h>
-#include <itkNearestNeighborInterpolateImageFunction.h>
+#include "../include/nvidia/aiaa/utils.h"
+#include "../include/nvidia/aiaa/imagecache.h"
 
 #include <itkImage.h>
 #include <itkImageFileReader.h>
 #include <itkImageFileWriter.h>
 #include <itkImageIOFactory.h>
+#include <itkRegionOfInterestImageFilter.h>
+#include <itkUnaryFunctorImageFilter.h>
+#include <itk_zlib.h>
 
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <limits>
 #include <sstream>
+#include <thread>
+#include <type_traits>
 #include "../include/nvidia/aiaa/aiaautils.h"
 
 namespace nvidia {
 namespace aiaa {
 
-template<class TImage>
-typename TImage::Pointer resizeImage(typename TImage::Pointer image, typename TImage::SizeType targetSize, bool linearInterpolate) {
+const size_t AiaaUtils::DEFAULT_IMAGE_CACHE_SIZE = 512 * 1024 * 1024;
+const unsigned int AiaaUtils::DEFAULT_STREAM_DIVISIONS = 16;
+const size_t GZIP_BLOCK_SIZE = 1024 * 1024;
+const std::string GZIP_EXTENSION = ".gz";
 
-  auto imageSize = image->GetLargestPossibleRegion().GetSize();
-  auto imageSpacing = image->GetSpacing();
+void AiaaUtils::setImageCacheSize(size_t maxSizeInBytes) {
+  AIAA_LOG_DEBUG("Image Cache Size: " << maxSizeInBytes);
+  ImageCache::instance().setMaxSize(maxSizeInBytes);
+}
 
-  using ImageType = TImage;
-  unsigned int dimension = image->GetImageDimension();
-  constexpr unsigned int ImageDimension = 3;
+//////////
+// GZip //
+//////////
 
-  typename ImageType::SpacingType targetSpacing;
-  for (unsigned int i = 0; i < dimension; i++) {
-    targetSpacing[i] = imageSpacing[i] * (static_cast<double>(imageSize[i]) / static_cast<double>(targetSize[i]));
+// Compress one block as a complete gzip member
+void gzipBlock(const std::vector<char> &in, std::vector<char> &out) {
+  z_stream zs = { };
+  if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    throw exception(exception::SYSTEM_ERROR, "Failed to initialize gzip stream");
+  }
+
+  out.resize(deflateBound(&zs, static_cast<uLong>(in.size())) + 32);
+  zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+  zs.avail_in = static_cast<uInt>(in.size());
+  zs.next_out = reinterpret_cast<Bytef*>(out.data());
+  zs.avail_out = static_cast<uInt>(out.size());
+
+  int ret = deflate(&zs, Z_FINISH);
+  out.resize(zs.total_out);
+  deflateEnd(&zs);
+
+  if (ret != Z_STREAM_END) {
+    throw exception(exception::SYSTEM_ERROR, "Failed to compress gzip block");
+  }
+}
+
+void AiaaUtils::gzipFile(const std::string &inputFile, const std::string &outputFile, int threads) {
+  std::ifstream in(inputFile, std::ios::in | std::ios::binary);
+  std::ofstream out(outputFile, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!in || !out) {
+    AIAA_LOG_ERROR("Failed to open: " << inputFile << " => " << outputFile);
+    throw exception(exception::SYSTEM_ERROR, ("Failed to open: " + inputFile + " => " + outputFile).c_str());
   }
 
-  auto filter = itk::ResampleImageFilter<ImageType, ImageType>::New();
-  filter->SetInput(image);
+  size_t n = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::vector<char>> inBlocks(n), outBlocks(n);
+
+  // Independent blocks are compressed in parallel and written in order as concatenated gzip members
+  // Memory is bounded to (threads * block size); output stays readable by any standard gzip reader
+  size_t total = 0;
+  while (in) {
+    size_t blocks = 0;
+    while (blocks < n && in) {
+      inBlocks[blocks].resize(GZIP_BLOCK_SIZE);
+      in.read(inBlocks[blocks].data(), GZIP_BLOCK_SIZE);
+      inBlocks[blocks].resize(static_cast<size_t>(in.gcount()));
+      if (!inBlocks[blocks].empty()) {
+        total += inBlocks[blocks].size();
+        blocks++;
+      }
+    }
+
+    Utils::parallelFor(blocks, [&](size_t i) {
+      gzipBlock(inBlocks[i], outBlocks[i]);
+    }, static_cast<int>(n));
+
+    for (size_t i = 0; i < blocks; i++) {
+      out.write(outBlocks[i].data(), outBlocks[i].size());
+    }
+  }
+
+  // Empty input still needs one (empty) gzip member
+  if (!total) {
+    gzipBlock(std::vector<char>(), outBlocks[0]);
+    out.write(outBlocks[0].data(), outBlocks[0].size());
+  }
+
+  if (!out) {
+    AIAA_LOG_ERROR("Failed to write: " << outputFile);
+    throw exception(exception::SYSTEM_ERROR, ("Failed to write: " + outputFile).c_str());
+  }
+  AIAA_LOG_DEBUG("GZip (" << n << " threads) " << inputFile << " => " << outputFile << "; Total bytes: " << total);
+}
+
+// Writes image; for .gz output an uncompressed file is written first and then compressed on all cores
+// If image is output of a (streaming) pipeline, streamDivisions > 1 pulls and writes it slab by slab
+template<class TImage>
+void writeImage(const TImage *image, const std::string &fileName, unsigned int streamDivisions = 1) {
+  using ImageType = TImage;
 
-  filter->SetSize(targetSize);
-  filter->SetOutputSpacing(targetSpacing);
-  filter->SetTransform(itk::IdentityTransform<double, ImageDimension>::New());
-  filter->SetOutputOrigin(image->GetOrigin());
-  filter->SetOutputDirection(image->GetDirection());
+  // Decoded image of the previous content (if any) must never be served again
+  ImageCache::instance().erase(fileName);
+
+  bool compress = fileName.size() > GZIP_EXTENSION.size()
+      && fileName.compare(fileName.size() - GZIP_EXTENSION.size(), GZIP_EXTENSION.size(), GZIP_EXTENSION) == 0;
+  std::string uncompressedFile = fileName;
+  if (compress) {
+    // unique temporary file (never next to / over user files); keep the format extension (e.g. .nii) so ITK picks the same ImageIO
+    std::string name = fileName.substr(0, fileName.size() - GZIP_EXTENSION.size());
+    std::string::size_type dot = name.find_last_of('.');
+    std::string::size_type slash = name.find_last_of("/\\");
+    bool hasExt = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+    uncompressedFile = Utils::tempfilename() + (hasExt ? name.substr(dot) : std::string());
+  }
 
-  if (linearInterpolate) {
-    filter->SetInterpolator(itk::LinearInterpolateImageFunction<ImageType, double>::New());
-  } else {
-    filter->SetInterpolator(itk::NearestNeighborInterpolateImageFunction<ImageType, double>::New());
+  try {
+    auto writer = itk::ImageFileWriter<ImageType>::New();
+    writer->SetInput(image);
+    writer->SetFileName(uncompressedFile);
+    writer->SetNumberOfStreamDivisions(streamDivisions);
+    writer->Update();
+
+    if (compress) {
+      AiaaUtils::gzipFile(uncompressedFile, fileName);
+    }
+  } catch (...) {
+    if (compress) {
+      std::remove(uncompressedFile.c_str());
+    }
+    throw;
   }
 
-  filter->UpdateLargestPossibleRegion();
-  return filter->GetOutput();
+  if (compress) {
+    std::remove(uncompressedFile.c_str());
+  }
 }
 
+// Reads image; image cache is looked up (and filled) only if useCache is set, otherwise image is always decoded from file and
+// its buffer is never shared with the cache
 template<class TImage>
-void readImage(const std::string &fileName, typename TImage::Pointer image) {
+void readImage(const std::string &fileName, typename TImage::Pointer image, bool useCache) {
   using ImageType = TImage;
   using ImageReaderType = itk::ImageFileReader<ImageType>;
 
+  std::string cacheKey = useCache ? ImageCache::key<ImageType>(fileName) : std::string();
+  if (!cacheKey.empty()) {
+    itk::DataObject::Pointer cached = ImageCache::instance().get(cacheKey);
+    ImageType *cachedImage = dynamic_cast<ImageType*>(cached.GetPointer());
+    if (cachedImage) {
+      AIAA_LOG_DEBUG("Using decoded image from cache: " << fileName);
+      image->Graft(cachedImage);
+      return;
+    }
+  }
+
   typename ImageReaderType::Pointer reader = ImageReaderType::New();
   reader->SetFileName(fileName.c_str());
 
@@ -99,19 +210,25 @@ void readImage(const std::string &fileName, typename TImage::Pointer image) {
   }
 
   image->Graft(reader->GetOutput());
+
+  if (!cacheKey.empty()) {
+    typename ImageType::Pointer cachedImage = ImageType::New();
+    cachedImage->Graft(reader->GetOutput());
+
+    size_t size = cachedImage->GetLargestPossibleRegion().GetNumberOfPixels() * sizeof(typename ImageType::PixelType);
+    ImageCache::instance().put(cacheKey, cachedImage.GetPointer(), size);
+  }
 }
 
 template<class TImage>
-PointSet preProcessImage(const PointSet &pointSet, typename TImage::Pointer image, const std::string &outputImage, ImageInfo &imageInfo, double PAD,
-                         const Point &ROI) {
+typename TImage::RegionType computeCropRegion(const std::vector<PointN<TImage::ImageDimension>> &points,
+                                              const typename TImage::SizeType &imageSize, const typename TImage::SpacingType &spacing,
+                                              double PAD) {
   using ImageType = TImage;
-  unsigned int dimension = image->GetImageDimension();
-  AIAA_LOG_DEBUG("Image Dimension: " << dimension);
+  const unsigned int dimension = ImageType::ImageDimension;
 
-  typename ImageType::SizeType imageSize = image->GetLargestPossibleRegion().GetSize();
   typename ImageType::IndexType indexMin;
   typename ImageType::IndexType indexMax;
-  typename ImageType::SpacingType spacing = image->GetSpacing();
   for (unsigned int i = 0; i < dimension; i++) {
     indexMin[i] = INT_MAX;
     indexMax[i] = INT_MIN;
@@ -119,7 +236,7 @@ PointSet preProcessImage(const PointSet &pointSet, typename TImage::Pointer imag
 
   typename ImageType::IndexType index;
   int pointCount = 0;
-  for (auto point : pointSet.points) {
+  for (const auto &point : points) {
     pointCount++;
     for (unsigned int i = 0; i < dimension; i++) {
       int vxPad = (int) (spacing[i] > 0 ? (PAD / spacing[i]) : PAD);
@@ -141,13 +258,211 @@ PointSet preProcessImage(const PointSet &pointSet, typename TImage::Pointer imag
   // Output min max index (ROI region)
   AIAA_LOG_DEBUG("Min index: " << indexMin << "; Max index: " << indexMax);
 
-  // Extract ROI image
   typename ImageType::IndexType cropIndex;
   typename ImageType::SizeType cropSize;
   for (unsigned int i = 0; i < dimension; i++) {
     cropIndex[i] = indexMin[i];
     cropSize[i] = indexMax[i] - indexMin[i];
+  }
+  return typename ImageType::RegionType(cropIndex, cropSize);
+}
+
+// Per-axis linear interpolation table; output j samples the source at continuous index j * n / m (same as ITK Resample with
+// IdentityTransform over the cropped image). Samples outside the buffer (>= n - 0.5) get zero weights (default pixel value 0)
+struct AxisWeights {
+  std::vector<int> i0;
+  std::vector<int> i1;
+  std::vector<float> w0;
+  std::vector<float> w1;
+
+  AxisWeights(size_t n, size_t m)
+      :
+      i0(m),
+      i1(m),
+      w0(m),
+      w1(m) {
+    for (size_t j = 0; j < m; j++) {
+      double c = static_cast<double>(j) * n / m;
+      int base = static_cast<int>(std::floor(c));
+      double d = c - base;
+
+      bool inside = c < (n - 0.5);
+      i0[j] = std::min(base, static_cast<int>(n) - 1);
+      i1[j] = std::min(base + 1, static_cast<int>(n) - 1);
+      w0[j] = inside ? static_cast<float>(1.0 - d) : 0.0f;
+      w1[j] = inside ? static_cast<float>(d) : 0.0f;
+    }
+  }
+};
 
+template<class TPixel>
+inline TPixel castWithBounds(float value) {
+  const double v = value;
+  if (v < static_cast<double>(std::numeric_limits<TPixel>::lowest())) {
+    return std::numeric_limits<TPixel>::lowest();
+  }
+  if (v > static_cast<double>(std::numeric_limits<TPixel>::max())) {
+    return std::numeric_limits<TPixel>::max();
+  }
+  return static_cast<TPixel>(value);
+}
+
+// Fused crop + linear resize (3D); reads directly from the source buffer (no intermediate cropped image) using separable
+// 1-D passes along X, Y and Z. Inner loops run over contiguous float rows so the compiler can vectorize them
+template<class TImage>
+typename TImage::Pointer cropAndResizeImage(typename TImage::Pointer image, const typename TImage::RegionType &cropRegion,
+                                            const typename TImage::SizeType &roiSize) {
+  using ImageType = TImage;
+  using PixelType = typename ImageType::PixelType;
+  static_assert(ImageType::ImageDimension == 3, "Only 3D images are supported");
+
+  const typename ImageType::IndexType cropIndex = cropRegion.GetIndex();
+  const typename ImageType::SizeType cropSize = cropRegion.GetSize();
+
+  const size_t cx = cropSize[0], cy = cropSize[1], cz = cropSize[2];
+  const size_t rx = roiSize[0], ry = roiSize[1], rz = roiSize[2];
+
+  AxisWeights wx(cx, rx), wy(cy, ry), wz(cz, rz);
+
+  const PixelType *src = image->GetBufferPointer();
+  const typename ImageType::OffsetValueType *offsetTable = image->GetOffsetTable();
+  const typename ImageType::OffsetValueType base = image->ComputeOffset(cropIndex);
+
+  // Pass 1: X (cz * cy rows of rx)
+  std::vector<float> tx(cz * cy * rx);
+  Utils::parallelFor(cz, [&](size_t z) {
+    for (size_t y = 0; y < cy; y++) {
+      const PixelType *row = src + base + z * offsetTable[2] + y * offsetTable[1];
+      float *out = &tx[(z * cy + y) * rx];
+      for (size_t x = 0; x < rx; x++) {
+        out[x] = wx.w0[x] * static_cast<float>(row[wx.i0[x]]) + wx.w1[x] * static_cast<float>(row[wx.i1[x]]);
+      }
+    }
+  });
+
+  // Pass 2: Y (cz planes of ry * rx)
+  std::vector<float> txy(cz * ry * rx);
+  Utils::parallelFor(cz, [&](size_t z) {
+    for (size_t y = 0; y < ry; y++) {
+      const float *r0 = &tx[(z * cy + wy.i0[y]) * rx];
+      const float *r1 = &tx[(z * cy + wy.i1[y]) * rx];
+      const float a = wy.w0[y], b = wy.w1[y];
+      float *out = &txy[(z * ry + y) * rx];
+      for (size_t x = 0; x < rx; x++) {
+        out[x] = a * r0[x] + b * r1[x];
+      }
+    }
+  });
+
+  // Pass 3: Z (rz planes) written to output image
+  typename ImageType::Pointer output = ImageType::New();
+  typename ImageType::RegionType outputRegion;
+  outputRegion.SetSize(roiSize);
+
+  typename ImageType::SpacingType spacing = image->GetSpacing();
+  typename ImageType::PointType origin;
+  image->TransformIndexToPhysicalPoint(cropIndex, origin);
+  for (unsigned int i = 0; i < ImageType::ImageDimension; i++) {
+    spacing[i] = spacing[i] * (static_cast<double>(cropSize[i]) / static_cast<double>(roiSize[i]));
+  }
+
+  output->SetRegions(outputRegion);
+  output->SetSpacing(spacing);
+  output->SetOrigin(origin);
+  output->SetDirection(image->GetDirection());
+  output->Allocate();
+
+  PixelType *dst = output->GetBufferPointer();
+  const size_t plane = ry * rx;
+  Utils::parallelFor(rz, [&](size_t z) {
+    const float *p0 = &txy[wz.i0[z] * plane];
+    const float *p1 = &txy[wz.i1[z] * plane];
+    const float a = wz.w0[z], b = wz.w1[z];
+    PixelType *out = dst + z * plane;
+    for (size_t k = 0; k < plane; k++) {
+      out[k] = castWithBounds<PixelType>(a * p0[k] + b * p1[k]);
+    }
+  });
+
+  return output;
+}
+
+// Reads only the union of crop regions for all PointSets; returns false if the format can not stream (caller does a full read)
+template<class TImage>
+bool readImageRegion(const std::string &fileName, typename TImage::Pointer image, const std::vector<PointSet> &pointSets,
+                     const std::vector<double> &PAD) {
+  using ImageType = TImage;
+  using ImageReaderType = itk::ImageFileReader<ImageType>;
+
+  // Compressed files (e.g. .nii.gz) have to be inflated from the start anyway; a full (cached) read is cheaper
+  std::string ext = fileName.size() > 3 ? fileName.substr(fileName.size() - 3) : fileName;
+  std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+  if (ext == ".gz" || ext == "zip") {
+    return false;
+  }
+
+  itk::ImageIOBase::Pointer imageIO = itk::ImageIOFactory::CreateImageIO(fileName.c_str(), itk::ImageIOFactory::FileModeType::ReadMode);
+  if (!imageIO || !imageIO->CanStreamRead()) {
+    return false;
+  }
+
+  typename ImageReaderType::Pointer reader = ImageReaderType::New();
+  reader->SetImageIO(imageIO);
+  reader->SetFileName(fileName.c_str());
+
+  try {
+    reader->UpdateOutputInformation();
+
+    auto output = reader->GetOutput();
+    typename ImageType::RegionType largestRegion = output->GetLargestPossibleRegion();
+
+    typename ImageType::IndexType indexMin = largestRegion.GetUpperIndex();
+    typename ImageType::IndexType indexMax = largestRegion.GetIndex();
+    for (size_t n = 0; n < pointSets.size(); n++) {
+      auto points = pointSets[n].fixedPoints<ImageType::ImageDimension>();
+      auto region = computeCropRegion<ImageType>(points, largestRegion.GetSize(), output->GetSpacing(), PAD[n]);
+      for (unsigned int i = 0; i < ImageType::ImageDimension; i++) {
+        indexMin[i] = std::min(indexMin[i], region.GetIndex()[i]);
+        indexMax[i] = std::max( { indexMax[i], region.GetIndex()[i], region.GetUpperIndex()[i] });
+      }
+    }
+
+    typename ImageType::RegionType requestedRegion;
+    requestedRegion.SetIndex(indexMin);
+    requestedRegion.SetUpperIndex(indexMax);
+    requestedRegion.Crop(largestRegion);
+    AIAA_LOG_DEBUG("Streaming Region: " << requestedRegion.GetIndex() << " => " << requestedRegion.GetSize());
+
+    output->SetRequestedRegion(requestedRegion);
+    reader->Update();
+    AIAA_LOG_DEBUG("Reading File Region completed: " << fileName);
+  } catch (itk::ExceptionObject &e) {
+    AIAA_LOG_ERROR(e.what());
+    throw exception(exception::ITK_PROCESS_ERROR, "Failed to read Input Image");
+  }
+
+  image->Graft(reader->GetOutput());
+  return true;
+}
+
+template<class TImage>
+PointSet preProcessImage(const PointSet &pointSet, typename TImage::Pointer image, const std::string &outputImage, ImageInfo &imageInfo, double PAD,
+                         const Point &ROI) {
+  using ImageType = TImage;
+  const unsigned int dimension = ImageType::ImageDimension;
+  AIAA_LOG_DEBUG("Image Dimension: " << dimension);
+
+  typename ImageType::SizeType imageSize = image->GetLargestPossibleRegion().GetSize();
+  typename ImageType::IndexType index;
+
+  // Fixed dimension copy of points (one allocation instead of one per point)
+  const std::vector<PointN<ImageType::ImageDimension>> points = pointSet.fixedPoints<ImageType::ImageDimension>();
+
+  // Extract ROI image
+  typename ImageType::RegionType cropRegion = computeCropRegion<ImageType>(points, imageSize, image->GetSpacing(), PAD);
+  typename ImageType::IndexType cropIndex = cropRegion.GetIndex();
+  typename ImageType::SizeType cropSize = cropRegion.GetSize();
+  for (unsigned int i = 0; i < dimension; i++) {
     imageInfo.cropSize[i] = cropSize[i];
     imageInfo.imageSize[i] = imageSize[i];
     imageInfo.cropIndex[i] = cropIndex[i];
@@ -155,28 +470,20 @@ PointSet preProcessImage(const PointSet &pointSet, typename TImage::Pointer imag
 
   AIAA_LOG_DEBUG("ImageInfo >>>> " << imageInfo.dump());
 
-  auto cropFilter = itk::RegionOfInterestImageFilter<ImageType, ImageType>::New();
-  cropFilter->SetInput(image);
-
-  typename ImageType::RegionType cropRegion(cropIndex, cropSize);
-  cropFilter->SetRegionOfInterest(cropRegion);
-  cropFilter->Update();
-
-  auto croppedItkImage = cropFilter->GetOutput();
-  AIAA_LOG_DEBUG("++++ Cropped Image: " << croppedItkImage->GetLargestPossibleRegion());
-
   // Resize to 128x128x128x128
   typename ImageType::SizeType roiSize;
   for (unsigned int i = 0; i < dimension; i++) {
     roiSize[i] = ROI[i];
   }
 
-  auto resampledImage = resizeImage<ImageType>(cropFilter->GetOutput(), roiSize, true);
+  // Crop + Resize in a single pass over the source image
+  auto resampledImage = cropAndResizeImage<ImageType>(image, cropRegion, roiSize);
   AIAA_LOG_DEBUG("ResampledImage completed");
 
   // Adjust extreme points index to cropped and resized image
   PointSet pointSetROI;
-  for (auto p : pointSet.points) {
+  pointSetROI.points.reserve(points.size());
+  for (const auto &p : points) {
     for (unsigned int i = 0; i < dimension; i++) {
       index[i] = p[i];
     }
@@ -187,252 +494,1324 @@ PointSet preProcessImage(const PointSet &pointSet, typename TImage::Pointer imag
     image->TransformIndexToPhysicalPoint(index, point);
     resampledImage->TransformPhysicalPointToIndex(point, index);
 
-    Point pointROI;
+    PointN<ImageType::ImageDimension> pointROI;
     for (unsigned int i = 0; i < dimension; i++) {
-      pointROI.push_back(index[i]);
+      pointROI[i] = index[i];
     }
-    pointSetROI.points.push_back(pointROI);
+    pointSetROI.push_back(pointROI);
   }
 
   AIAA_LOG_DEBUG("PointSetROI: " << pointSetROI.toJson());
 
   // Write the ROI image out to temp folder
-  auto writer = itk::ImageFileWriter<ImageType>::New();
-  writer->SetInput(resampledImage);
-  writer->SetFileName(outputImage);
-  writer->Update();
+  writeImage<ImageType>(resampledImage, outputImage);
 
   return pointSetROI;
 }
 
+// Source index (nearest neighbour) along one axis for each of the crop positions; -1 if it falls outside the ROI image
+std::vector<int> nearestIndex(size_t roi, size_t crop) {
+  std::vector<int> index(crop);
+  for (size_t j = 0; j < crop; j++) {
+    double c = static_cast<double>(j) * roi / crop;
+    index[j] = c < (roi - 0.5) ? static_cast<int>(std::floor(c + 0.5)) : -1;
+  }
+  return index;
+}
+
+// Nearest neighbour upscale of ROI image (server result) into crop region of destination buffer; only crop region is touched
+// Destination buffer has size dstSize (X fastest) and the crop region starts at dstOffset
+template<class TImage, class TLabel>
+void scatterImage(typename TImage::Pointer image, const ImageInfo &imageInfo, TLabel *dst, const int *dstSize, const int *dstOffset) {
+  using ImageType = TImage;
+  using PixelType = typename ImageType::PixelType;
+  static_assert(ImageType::ImageDimension == 3, "Only 3D images are supported");
+
+  const typename ImageType::SizeType roiSize = image->GetLargestPossibleRegion().GetSize();
+  const size_t cx = imageInfo.cropSize[0], cy = imageInfo.cropSize[1], cz = imageInfo.cropSize[2];
+  if (!cx || !cy || !cz) {
+    return;
+  }
+
+  std::vector<int> ix = nearestIndex(roiSize[0], cx), iy = nearestIndex(roiSize[1], cy), iz = nearestIndex(roiSize[2], cz);
+
+  const PixelType *src = image->GetBufferPointer();
+  const size_t srcRow = roiSize[0], srcPlane = roiSize[0] * roiSize[1];
+  const size_t dstRow = dstSize[0], dstPlane = static_cast<size_t>(dstSize[0]) * dstSize[1];
+
+  Utils::parallelFor(cz, [&](size_t z) {
+    TLabel *plane = dst + (z + dstOffset[2]) * dstPlane + dstOffset[1] * dstRow + dstOffset[0];
+    for (size_t y = 0; y < cy; y++) {
+      TLabel *out = plane + y * dstRow;
+      if (iz[z] < 0 || iy[y] < 0) {
+        std::fill(out, out + cx, TLabel(0));
+        continue;
+      }
+
+      const PixelType *row = src + iz[z] * srcPlane + iy[y] * srcRow;
+      for (size_t x = 0; x < cx; x++) {
+        out[x] = ix[x] < 0 ? TLabel(0) : static_cast<TLabel>(row[ix[x]]);
+      }
+    }
+  });
+}
+
 template<class TImage>
-PointSet postProcessImage(typename TImage::Pointer image, const std::string &outputImage, ImageInfo &imageInfo) {
+PointSet postProcessImage(typename TImage::Pointer image, const std::string &outputImage, ImageInfo &imageInfo, bool roiOnly) {
   using ImageType = TImage;
   unsigned int dimension = image->GetImageDimension();
   AIAA_LOG_DEBUG("Image Dimension: " << dimension);
 
-  auto segLocalImage = image;
-
   // Recover the ROI segmentation back to original image space for storage
-  // Reverse the resize and crop operation for result image
-  // Reverse the resizing by resizing
-  typename ImageType::SizeType recoverSize;
+  // Reverse the resize (nearest neighbour) and crop operation directly into the destination image
+  const typename ImageType::SizeType roiSize = image->GetLargestPossibleRegion().GetSize();
+  typename ImageType::SpacingType spacing = image->GetSpacing();
   for (unsigned int i = 0; i < dimension; i++) {
-    recoverSize[i] = imageInfo.cropSize[i];
+    spacing[i] = spacing[i] * (static_cast<double>(roiSize[i]) / static_cast<double>(imageInfo.cropSize[i]));
   }
 
-  AIAA_LOG_DEBUG("Recover resizing: " << recoverSize);
-  typename ImageType::Pointer segLocalResizeImage;
-  segLocalResizeImage = resizeImage<ImageType>(segLocalImage, recoverSize, false);
-
-  // Reverse the cropping by adding proper padding
-  typename ImageType::Pointer segRecoverImage = ImageType::New();
-  typename ImageType::SizeType padLowerBound;
-  typename ImageType::SizeType padUpperBound;
+  // Output is either full image or only the crop region (ROI + offset in imageInfo.cropIndex)
+  typename ImageType::SizeType size;
+  typename ImageType::PointType origin = image->GetOrigin();
+  int dstSize[3], dstOffset[3];
   for (unsigned int i = 0; i < dimension; i++) {
-    padLowerBound[i] = imageInfo.cropIndex[i];
-    padUpperBound[i] = imageInfo.imageSize[i] - imageInfo.cropSize[i] - imageInfo.cropIndex[i];
+    size[i] = roiOnly ? imageInfo.cropSize[i] : imageInfo.imageSize[i];
+    dstSize[i] = size[i];
+    dstOffset[i] = roiOnly ? 0 : imageInfo.cropIndex[i];
   }
+  if (!roiOnly) {
+    for (unsigned int i = 0; i < dimension; i++) {
+      for (unsigned int j = 0; j < dimension; j++) {
+        origin[i] -= image->GetDirection()[i][j] * imageInfo.cropIndex[j] * spacing[j];
+      }
+    }
+  }
+
+  typename ImageType::Pointer segRecoverImage = ImageType::New();
+  typename ImageType::RegionType region;
+  region.SetSize(size);
+  segRecoverImage->SetRegions(region);
+  segRecoverImage->SetSpacing(spacing);
+  segRecoverImage->SetOrigin(origin);
+  segRecoverImage->SetDirection(image->GetDirection());
+  segRecoverImage->Allocate(!roiOnly);
+
+  scatterImage<ImageType, typename ImageType::PixelType>(image, imageInfo, segRecoverImage->GetBufferPointer(), dstSize, dstOffset);
+  AIAA_LOG_DEBUG("++++ Recovered Image: " << segRecoverImage->GetLargestPossibleRegion());
 
-  AIAA_LOG_DEBUG("Recover cropping... ");
-  AIAA_LOG_DEBUG("Padding => Lower Bound: " << padLowerBound << "; Upper Bound: " << padUpperBound);
+  writeImage<ImageType>(segRecoverImage, outputImage);
 
-  typename ImageType::PixelType constantPixel = 0;
+  return PointSet();
+}
 
-  auto padFilter = itk::ConstantPadImageFilter<ImageType, ImageType>::New();
-  padFilter->SetInput(segLocalResizeImage);
-  padFilter->SetPadLowerBound(padLowerBound);
-  padFilter->SetPadUpperBound(padUpperBound);
-  padFilter->SetConstant(constantPixel);
-  padFilter->Update();
+template<class TLabel>
+void postProcessImage(const std::string &inputImage, TLabel *labelBuffer, const ImageInfo &imageInfo) {
+  using ImageType = itk::Image<TLabel, 3>;
 
-  segRecoverImage = padFilter->GetOutput();
-  segRecoverImage->SetOrigin(segLocalImage->GetOrigin());
-  AIAA_LOG_DEBUG("++++ Recovered Image: " << segRecoverImage->GetLargestPossibleRegion());
+  try {
+    // Result from AIAA is single-use; use the cache only if it already holds the decoded download
+    typename ImageType::Pointer image = ImageType::New();
+    readImage<ImageType>(inputImage, image, ImageCache::instance().get(ImageCache::key<ImageType>(inputImage)).IsNotNull());
 
-  auto writer = itk::ImageFileWriter<ImageType>::New();
-  writer->SetInput(segRecoverImage);
-  writer->SetFileName(outputImage);
-  writer->Update();
+    int dstSize[3] = { imageInfo.imageSize[0], imageInfo.imageSize[1], imageInfo.imageSize[2] };
+    int dstOffset[3] = { imageInfo.cropIndex[0], imageInfo.cropIndex[1], imageInfo.cropIndex[2] };
+    scatterImage<ImageType, TLabel>(image, imageInfo, labelBuffer, dstSize, dstOffset);
+  } catch (itk::ExceptionObject &e) {
+    AIAA_LOG_ERROR(e.what());
+    throw exception(exception::ITK_PROCESS_ERROR, e.what());
+  }
+}
 
-  return PointSet();
+template<class TImage>
+std::vector<PointSet> processImage(const std::vector<PointSet> &pointSets, const std::string &inputFileName,
+                                   const std::vector<std::string> &outputImages, std::vector<ImageInfo> &imageInfos, const std::vector<double> &PAD,
+                                   const std::vector<Point> &ROI, bool pre, bool roiOnly) {
+  using ImageType = TImage;
+
+  typename ImageType::Pointer image = ImageType::New();
+  // Post-process inputs are single-use results from AIAA; only use the cache for them if already there (decoded download)
+  // For pre-process, a decoded image already in cache is preferred over streaming the crop region(s) from file
+  bool cached = ImageCache::instance().get(ImageCache::key<ImageType>(inputFileName)).IsNotNull();
+  if (!pre || cached || !readImageRegion<ImageType>(inputFileName, image, pointSets, PAD)) {
+    readImage<ImageType>(inputFileName, image, pre || cached);
+  }
+
+  std::vector<PointSet> pointSetROIs(outputImages.size());
+  if (!pre) {
+    for (size_t i = 0; i < outputImages.size(); i++) {
+      postProcessImage<ImageType>(image, outputImages[i], imageInfos[i], roiOnly);
+    }
+    return pointSetROIs;
+  }
+
+  // Decoded once; each ROI works on its own view (sharing the pixel buffer) so that crops can run in parallel
+  Utils::parallelFor(outputImages.size(), [&](size_t i) {
+    typename ImageType::Pointer view = ImageType::New();
+    view->Graft(image);
+    pointSetROIs[i] = preProcessImage<ImageType>(pointSets[i], view, outputImages[i], imageInfos[i], PAD[i], ROI[i]);
+  });
+  return pointSetROIs;
 }
 
 template<unsigned int VDimension>
-PointSet processImage(const itk::ImageIOBase::IOComponentType componentType, const PointSet &pointSet, const std::string &inputFileName,
-                      const std::string &outputImage, ImageInfo &imageInfo, double PAD, const Point &ROI, bool pre) {
+std::vector<PointSet> processImage(const itk::ImageIOBase::IOComponentType componentType, const std::vector<PointSet> &pointSets,
+                                   const std::string &inputFileName, const std::vector<std::string> &outputImages, std::vector<ImageInfo> &imageInfos,
+                                   const std::vector<double> &PAD, const std::vector<Point> &ROI, bool pre, bool roiOnly) {
   switch (componentType) {
-    case itk::ImageIOBase::UCHAR: {
-      using PixelType = unsigned char;
-      using ImageType = itk::Image<PixelType, VDimension>;
+    case itk::ImageIOBase::UCHAR:
+      return processImage<itk::Image<unsigned char, VDimension>>(pointSets, inputFileName, outputImages, imageInfos, PAD, ROI, pre,
+                                                                 roiOnly);
+    case itk::ImageIOBase::CHAR:
+      return processImage<itk::Image<char, VDimension>>(pointSets, inputFileName, outputImages, imageInfos, PAD, ROI, pre, roiOnly);
+    case itk::ImageIOBase::USHORT:
+      return processImage<itk::Image<unsigned short, VDimension>>(pointSets, inputFileName, outputImages, imageInfos, PAD, ROI, pre,
+                                                                  roiOnly);
+    case itk::ImageIOBase::SHORT:
+      return processImage<itk::Image<short, VDimension>>(pointSets, inputFileName, outputImages, imageInfos, PAD, ROI, pre, roiOnly);
+    case itk::ImageIOBase::UINT:
+      return processImage<itk::Image<unsigned int, VDimension>>(pointSets, inputFileName, outputImages, imageInfos, PAD, ROI, pre, roiOnly);
+    case itk::ImageIOBase::INT:
+      return processImage<itk::Image<int, VDimension>>(pointSets, inputFileName, outputImages, imageInfos, PAD, ROI, pre, roiOnly);
+    case itk::ImageIOBase::ULONG:
+      return processImage<itk::Image<unsigned long, VDimension>>(pointSets, inputFileName, outputImages, imageInfos, PAD, ROI, pre,
+                                                                 roiOnly);
+    case itk::ImageIOBase::LONG:
+      return processImage<itk::Image<long, VDimension>>(pointSets, inputFileName, outputImages, imageInfos, PAD, ROI, pre, roiOnly);
+    case itk::ImageIOBase::FLOAT:
+      return processImage<itk::Image<float, VDimension>>(pointSets, inputFileName, outputImages, imageInfos, PAD, ROI, pre, roiOnly);
+    case itk::ImageIOBase::DOUBLE:
+      return processImage<itk::Image<double, VDimension>>(pointSets, inputFileName, outputImages, imageInfos, PAD, ROI, pre, roiOnly);
+    default:
+      break;
+  }
+
+  AIAA_LOG_ERROR("Unknown and unsupported component type!");
+  throw exception(exception::ITK_PROCESS_ERROR, "Unknown and unsupported component type!");
+}
 
-      typename ImageType::Pointer image = ImageType::New();
-      readImage<ImageType>(inputFileName, image);
-      if (pre) {
-        return preProcessImage<ImageType>(pointSet, image, outputImage, imageInfo, PAD, ROI);
+std::vector<PointSet> processImage(const std::vector<PointSet> &pointSets, const std::string &inputImage,
+                                   const std::vector<std::string> &outputImages, std::vector<ImageInfo> &imageInfos, const std::vector<double> &PAD,
+                                   const std::vector<Point> &ROI, bool pre, bool roiOnly = false) {
+
+  try {
+    AIAA_LOG_DEBUG("Input Image: " << inputImage);
+
+    const char *inputFileName = inputImage.c_str();
+    itk::ImageIOBase::Pointer imageIO = itk::ImageIOFactory::CreateImageIO(inputFileName, itk::ImageIOFactory::FileModeType::ReadMode);
+
+    imageIO->SetFileName(inputFileName);
+    imageIO->ReadImageInformation();
+
+    using IOPixelType = itk::ImageIOBase::IOPixelType;
+    const IOPixelType pixelType = imageIO->GetPixelType();
+
+    AIAA_LOG_DEBUG("Pixel Type is " << itk::ImageIOBase::GetPixelTypeAsString(pixelType));
+
+    using IOComponentType = itk::ImageIOBase::IOComponentType;
+    const IOComponentType componentType = imageIO->GetComponentType();
+    AIAA_LOG_DEBUG("Component Type is " << imageIO->GetComponentTypeAsString(componentType));
+
+    const unsigned int imageDimension = imageIO->GetNumberOfDimensions();
+    AIAA_LOG_DEBUG("Image Dimension is " << imageDimension);
+
+    if (pixelType == itk::ImageIOBase::SCALAR) {
+      if (imageDimension == 3) {
+        return processImage<3>(componentType, pointSets, inputImage, outputImages, imageInfos, PAD, ROI, pre, roiOnly);
       }
-      return postProcessImage<ImageType>(image, outputImage, imageInfo);
     }
 
-    case itk::ImageIOBase::CHAR: {
-      using PixelType = char;
-      using ImageType = itk::Image<PixelType, VDimension>;
+    AIAA_LOG_ERROR("ImageReader: not implemented yet!");
+    throw exception(exception::ITK_PROCESS_ERROR, "ImageReader: not implemented yet!");
+
+  } catch (itk::ExceptionObject &e) {
+    AIAA_LOG_ERROR(e.what());
+    throw exception(exception::ITK_PROCESS_ERROR, e.what());
+  }
+}
 
-      typename ImageType::Pointer image = ImageType::New();
-      if (pre) {
-        return preProcessImage<ImageType>(pointSet, image, outputImage, imageInfo, PAD, ROI);
+template<class TImage>
+void convertImage(const std::string &inputImage, const std::string &outputImage, unsigned int streamDivisions) {
+  using ImageType = TImage;
+
+  auto reader = itk::ImageFileReader<ImageType>::New();
+  reader->SetFileName(inputImage);
+
+  // Writer requests one slab at a time from reader; memory stays proportional to slab size for streamable formats
+  writeImage<ImageType>(reader->GetOutput(), outputImage, streamDivisions);
+}
+
+template<unsigned int VDimension>
+void convertImage(const itk::ImageIOBase::IOComponentType componentType, const std::string &inputImage, const std::string &outputImage,
+                  unsigned int streamDivisions) {
+  switch (componentType) {
+    case itk::ImageIOBase::UCHAR:
+      return convertImage<itk::Image<unsigned char, VDimension>>(inputImage, outputImage, streamDivisions);
+    case itk::ImageIOBase::CHAR:
+      return convertImage<itk::Image<char, VDimension>>(inputImage, outputImage, streamDivisions);
+    case itk::ImageIOBase::USHORT:
+      return convertImage<itk::Image<unsigned short, VDimension>>(inputImage, outputImage, streamDivisions);
+    case itk::ImageIOBase::SHORT:
+      return convertImage<itk::Image<short, VDimension>>(inputImage, outputImage, streamDivisions);
+    case itk::ImageIOBase::UINT:
+      return convertImage<itk::Image<unsigned int, VDimension>>(inputImage, outputImage, streamDivisions);
+    case itk::ImageIOBase::INT:
+      return convertImage<itk::Image<int, VDimension>>(inputImage, outputImage, streamDivisions);
+    case itk::ImageIOBase::ULONG:
+      return convertImage<itk::Image<unsigned long, VDimension>>(inputImage, outputImage, streamDivisions);
+    case itk::ImageIOBase::LONG:
+      return convertImage<itk::Image<long, VDimension>>(inputImage, outputImage, streamDivisions);
+    case itk::ImageIOBase::FLOAT:
+      return convertImage<itk::Image<float, VDimension>>(inputImage, outputImage, streamDivisions);
+    case itk::ImageIOBase::DOUBLE:
+      return convertImage<itk::Image<double, VDimension>>(inputImage, outputImage, streamDivisions);
+    default:
+      break;
+  }
+
+  AIAA_LOG_ERROR("Unknown and unsupported component type!");
+  throw exception(exception::ITK_PROCESS_ERROR, "Unknown and unsupported component type!");
+}
+
+void AiaaUtils::imageConvert(const std::string &inputImage, const std::string &outputImage, unsigned int streamDivisions) {
+  AIAA_LOG_DEBUG("Convert Image: " << inputImage << " => " << outputImage << "; Stream Divisions: " << streamDivisions);
+
+  try {
+    itk::ImageIOBase::Pointer imageIO = itk::ImageIOFactory::CreateImageIO(inputImage.c_str(), itk::ImageIOFactory::FileModeType::ReadMode);
+    if (!imageIO) {
+      throw exception(exception::ITK_PROCESS_ERROR, ("Unsupported Image: " + inputImage).c_str());
+    }
+
+    imageIO->SetFileName(inputImage);
+    imageIO->ReadImageInformation();
+
+    const unsigned int imageDimension = imageIO->GetNumberOfDimensions();
+    if (imageIO->GetPixelType() == itk::ImageIOBase::SCALAR) {
+      switch (imageDimension) {
+        case 2:
+          return convertImage<2>(imageIO->GetComponentType(), inputImage, outputImage, streamDivisions);
+        case 3:
+          return convertImage<3>(imageIO->GetComponentType(), inputImage, outputImage, streamDivisions);
+        case 4:
+          return convertImage<4>(imageIO->GetComponentType(), inputImage, outputImage, streamDivisions);
+        default:
+          break;
       }
-      return postProcessImage<ImageType>(image, outputImage, imageInfo);
     }
 
-    case itk::ImageIOBase::USHORT: {
-      using PixelType = unsigned short;
-      using ImageType = itk::Image<PixelType, VDimension>;
+    AIAA_LOG_ERROR("ImageConvert: not implemented yet!");
+    throw exception(exception::ITK_PROCESS_ERROR, "ImageConvert: not implemented yet!");
+  } catch (itk::ExceptionObject &e) {
+    AIAA_LOG_ERROR(e.what());
+    throw exception(exception::ITK_PROCESS_ERROR, e.what());
+  }
+}
+
+// Calls func with image cast to itk::Image<TPixel, VDimension>; returns false if image is of another type
+template<class TPixel, unsigned int VDimension, class TFunc>
+bool castImage(const itk::DataObject *image, TFunc &func) {
+  auto typedImage = dynamic_cast<const itk::Image<TPixel, VDimension>*>(image);
+  if (typedImage) {
+    func(typedImage);
+  }
+  return typedImage != nullptr;
+}
+
+template<unsigned int VDimension, class TFunc>
+bool castImageDimension(const itk::DataObject *image, TFunc &func) {
+  return castImage<unsigned char, VDimension>(image, func) || castImage<char, VDimension>(image, func)
+      || castImage<unsigned short, VDimension>(image, func) || castImage<short, VDimension>(image, func)
+      || castImage<unsigned int, VDimension>(image, func) || castImage<int, VDimension>(image, func)
+      || castImage<unsigned long, VDimension>(image, func) || castImage<long, VDimension>(image, func)
+      || castImage<float, VDimension>(image, func) || castImage<double, VDimension>(image, func);
+}
+
+void AiaaUtils::imageWrite(const itk::DataObject *image, const std::string &outputImage) {
+  AIAA_LOG_DEBUG("Write Image: " << outputImage);
+  auto write = [&](auto typedImage) {
+    writeImage<typename std::remove_const<typename std::remove_pointer<decltype(typedImage)>::type>::type>(typedImage, outputImage);
+  };
+
+  try {
+    if (!image || !(castImageDimension<2>(image, write) || castImageDimension<3>(image, write))) {
+      AIAA_LOG_ERROR("Only scalar 2D/3D images are supported!");
+      throw exception(exception::ITK_PROCESS_ERROR, "Only scalar 2D/3D images are supported!");
+    }
+  } catch (itk::ExceptionObject &e) {
+    AIAA_LOG_ERROR(e.what());
+    throw exception(exception::ITK_PROCESS_ERROR, e.what());
+  }
+}
+
+//////////////////
+// Quantization //
+//////////////////
+
+// Clip to intensity window and map linearly to output pixel type; original ~= value * scale + offset
+template<class TInput, class TOutput>
+class QuantizeFunctor {
+ public:
+  double windowMin = 0;
+  double windowMax = 0;
+  double scale = 1;
+  double offset = 0;
+
+  bool operator!=(const QuantizeFunctor &other) const {
+    return windowMin != other.windowMin || windowMax != other.windowMax || scale != other.scale || offset != other.offset;
+  }
+
+  bool operator==(const QuantizeFunctor &other) const {
+    return !(*this != other);
+  }
+
+  inline TOutput operator()(const TInput &v) const {
+    double c = std::min(std::max(static_cast<double>(v), windowMin), windowMax);
+    double q = std::round((c - offset) / scale);
+    q = std::min(std::max(q, static_cast<double>(std::numeric_limits<TOutput>::lowest())), static_cast<double>(std::numeric_limits<TOutput>::max()));
+    return static_cast<TOutput>(q);
+  }
+};
+
+template<class TInput, class TOutput, unsigned int VDimension>
+void quantizeImage(const std::string &inputImage, const std::string &outputImage, double windowMin, double windowMax, double scale,
+                   double offset, unsigned int streamDivisions) {
+  using InputImageType = itk::Image<TInput, VDimension>;
+  using OutputImageType = itk::Image<TOutput, VDimension>;
+  using FunctorType = QuantizeFunctor<TInput, TOutput>;
+
+  auto reader = itk::ImageFileReader<InputImageType>::New();
+  reader->SetFileName(inputImage);
+
+  FunctorType functor;
+  functor.windowMin = windowMin;
+  functor.windowMax = windowMax;
+  functor.scale = scale;
+  functor.offset = offset;
+
+  auto filter = itk::UnaryFunctorImageFilter<InputImageType, OutputImageType, FunctorType>::New();
+  filter->SetInput(reader->GetOutput());
+  filter->SetFunctor(functor);
+
+  writeImage<OutputImageType>(filter->GetOutput(), outputImage, streamDivisions);
+}
+
+template<class TOutput, unsigned int VDimension>
+void quantizeImage(const itk::ImageIOBase::IOComponentType componentType, const std::string &inputImage, const std::string &outputImage,
+                   double windowMin, double windowMax, double scale, double offset, unsigned int streamDivisions) {
+  switch (componentType) {
+    case itk::ImageIOBase::UCHAR:
+      return quantizeImage<unsigned char, TOutput, VDimension>(inputImage, outputImage, windowMin, windowMax, scale, offset, streamDivisions);
+    case itk::ImageIOBase::CHAR:
+      return quantizeImage<char, TOutput, VDimension>(inputImage, outputImage, windowMin, windowMax, scale, offset, streamDivisions);
+    case itk::ImageIOBase::USHORT:
+      return quantizeImage<unsigned short, TOutput, VDimension>(inputImage, outputImage, windowMin, windowMax, scale, offset, streamDivisions);
+    case itk::ImageIOBase::SHORT:
+      return quantizeImage<short, TOutput, VDimension>(inputImage, outputImage, windowMin, windowMax, scale, offset, streamDivisions);
+    case itk::ImageIOBase::UINT:
+      return quantizeImage<unsigned int, TOutput, VDimension>(inputImage, outputImage, windowMin, windowMax, scale, offset, streamDivisions);
+    case itk::ImageIOBase::INT:
+      return quantizeImage<int, TOutput, VDimension>(inputImage, outputImage, windowMin, windowMax, scale, offset, streamDivisions);
+    case itk::ImageIOBase::ULONG:
+      return quantizeImage<unsigned long, TOutput, VDimension>(inputImage, outputImage, windowMin, windowMax, scale, offset, streamDivisions);
+    case itk::ImageIOBase::LONG:
+      return quantizeImage<long, TOutput, VDimension>(inputImage, outputImage, windowMin, windowMax, scale, offset, streamDivisions);
+    case itk::ImageIOBase::FLOAT:
+      return quantizeImage<float, TOutput, VDimension>(inputImage, outputImage, windowMin, windowMax, scale, offset, streamDivisions);
+    case itk::ImageIOBase::DOUBLE:
+      return quantizeImage<double, TOutput, VDimension>(inputImage, outputImage, windowMin, windowMax, scale, offset, streamDivisions);
+    default:
+      break;
+  }
+
+  AIAA_LOG_ERROR("Unknown and unsupported component type!");
+  throw exception(exception::ITK_PROCESS_ERROR, "Unknown and unsupported component type!");
+}
+
+template<class TOutput>
+void quantizeImage(const itk::ImageIOBase *imageIO, const std::string &inputImage, const std::string &outputImage, double windowMin,
+                   double windowMax, double scale, double offset, unsigned int streamDivisions) {
+  switch (imageIO->GetNumberOfDimensions()) {
+    case 2:
+      return quantizeImage<TOutput, 2>(imageIO->GetComponentType(), inputImage, outputImage, windowMin, windowMax, scale, offset, streamDivisions);
+    case 3:
+      return quantizeImage<TOutput, 3>(imageIO->GetComponentType(), inputImage, outputImage, windowMin, windowMax, scale, offset, streamDivisions);
+    case 4:
+      return quantizeImage<TOutput, 4>(imageIO->GetComponentType(), inputImage, outputImage, windowMin, windowMax, scale, offset, streamDivisions);
+    default:
+      break;
+  }
+
+  AIAA_LOG_ERROR("ImageQuantize: not implemented yet!");
+  throw exception(exception::ITK_PROCESS_ERROR, "ImageQuantize: not implemented yet!");
+}
 
-      typename ImageType::Pointer image = ImageType::New();
-      readImage<ImageType>(inputFileName, image);
-      if (pre) {
-        return preProcessImage<ImageType>(pointSet, image, outputImage, imageInfo, PAD, ROI);
+void AiaaUtils::quantizationScale(double windowMin, double windowMax, QuantizationType type, double &scale, double &offset) {
+  double typeMin = 0, typeMax = 1;
+  switch (type) {
+    case QUANTIZE_INT16:
+      typeMin = std::numeric_limits<short>::lowest();
+      typeMax = std::numeric_limits<short>::max();
+      // Window fits into int16 (e.g. CT in HU); clamp only, values stay as is and server needs no de-quantization
+      if (windowMin >= typeMin && windowMax <= typeMax) {
+        scale = 1;
+        offset = 0;
+        return;
       }
-      return postProcessImage<ImageType>(image, outputImage, imageInfo);
+      break;
+    case QUANTIZE_UINT8:
+      // Lossy; server must de-quantize (value * scale + offset) to restore original intensities
+      typeMin = std::numeric_limits<unsigned char>::lowest();
+      typeMax = std::numeric_limits<unsigned char>::max();
+      break;
+    default:
+      scale = 1;
+      offset = 0;
+      return;
+  }
+
+  scale = windowMax > windowMin ? (windowMax - windowMin) / (typeMax - typeMin) : 1;
+  offset = windowMin - typeMin * scale;
+}
+
+void AiaaUtils::imageQuantize(const std::string &inputImage, const std::string &outputImage, double windowMin, double windowMax,
+                              QuantizationType type, unsigned int streamDivisions) {
+  double scale, offset;
+  quantizationScale(windowMin, windowMax, type, scale, offset);
+  AIAA_LOG_DEBUG("Quantize Image: " << inputImage << " => " << outputImage << "; Window: [" << windowMin << ", " << windowMax << "]; Scale: "
+      << scale << "; Offset: " << offset);
+
+  try {
+    itk::ImageIOBase::Pointer imageIO = itk::ImageIOFactory::CreateImageIO(inputImage.c_str(), itk::ImageIOFactory::FileModeType::ReadMode);
+    if (!imageIO) {
+      throw exception(exception::ITK_PROCESS_ERROR, ("Unsupported Image: " + inputImage).c_str());
     }
 
-    case itk::ImageIOBase::SHORT: {
-      using PixelType = short;
-      using ImageType = itk::Image<PixelType, VDimension>;
+    imageIO->SetFileName(inputImage);
+    imageIO->ReadImageInformation();
+    if (imageIO->GetPixelType() != itk::ImageIOBase::SCALAR) {
+      throw exception(exception::ITK_PROCESS_ERROR, "ImageQuantize: not implemented yet!");
+    }
 
-      typename ImageType::Pointer image = ImageType::New();
-      readImage<ImageType>(inputFileName, image);
-      if (pre) {
-        return preProcessImage<ImageType>(pointSet, image, outputImage, imageInfo, PAD, ROI);
+    switch (type) {
+      case QUANTIZE_INT16:
+        return quantizeImage<short>(imageIO, inputImage, outputImage, windowMin, windowMax, scale, offset, streamDivisions);
+      case QUANTIZE_UINT8:
+        return quantizeImage<unsigned char>(imageIO, inputImage, outputImage, windowMin, windowMax, scale, offset, streamDivisions);
+      default:
+        return imageConvert(inputImage, outputImage, streamDivisions);
+    }
+  } catch (itk::ExceptionObject &e) {
+    AIAA_LOG_ERROR(e.what());
+    throw exception(exception::ITK_PROCESS_ERROR, e.what());
+  }
+}
+
+//////////////////////////////
+// Foreground Crop / Coarse //
+//////////////////////////////
+
+// Bounding box of voxels above threshold (single pass; slices in parallel) plus margin; full image if there is no foreground
+template<class TImage>
+bool boundingBox(typename TImage::Pointer image, ImageInfo &imageInfo, double threshold, int margin) {
+  using ImageType = TImage;
+  using PixelType = typename ImageType::PixelType;
+  static_assert(ImageType::ImageDimension == 3, "Only 3D images are supported");
+
+  const typename ImageType::SizeType size = image->GetBufferedRegion().GetSize();
+  const size_t sx = size[0], sy = size[1], sz = size[2];
+  const PixelType *buffer = image->GetBufferPointer();
+
+  // per slice: [minX, maxX, minY, maxY]; -1 if slice has no foreground
+  std::vector<std::array<long, 4>> slices(sz, std::array<long, 4> { { -1, -1, -1, -1 } });
+  Utils::parallelFor(sz, [&](size_t z) {
+    long minX = sx, maxX = -1, minY = sy, maxY = -1;
+    for (size_t y = 0; y < sy; y++) {
+      const PixelType *row = buffer + (z * sy + y) * sx;
+
+      long first = -1;
+      for (size_t x = 0; x < sx; x++) {
+        if (row[x] > threshold) {
+          first = x;
+          break;
+        }
       }
-      return postProcessImage<ImageType>(image, outputImage, imageInfo);
+      if (first < 0) {
+        continue;
+      }
+
+      long last = first;
+      for (size_t x = sx; x-- > static_cast<size_t>(first);) {
+        if (row[x] > threshold) {
+          last = x;
+          break;
+        }
+      }
+
+      minX = std::min(minX, first);
+      maxX = std::max(maxX, last);
+      minY = std::min(minY, static_cast<long>(y));
+      maxY = static_cast<long>(y);
+    }
+    if (maxX >= 0) {
+      slices[z] = { { minX, maxX, minY, maxY } };
+    }
+  });
+
+  long indexMin[3] = { static_cast<long>(sx), static_cast<long>(sy), static_cast<long>(sz) };
+  long indexMax[3] = { -1, -1, -1 };
+  for (size_t z = 0; z < sz; z++) {
+    if (slices[z][1] < 0) {
+      continue;
     }
+    indexMin[0] = std::min(indexMin[0], slices[z][0]);
+    indexMax[0] = std::max(indexMax[0], slices[z][1]);
+    indexMin[1] = std::min(indexMin[1], slices[z][2]);
+    indexMax[1] = std::max(indexMax[1], slices[z][3]);
+    indexMin[2] = std::min(indexMin[2], static_cast<long>(z));
+    indexMax[2] = static_cast<long>(z);
+  }
+
+  for (unsigned int i = 0; i < 3; i++) {
+    if (indexMax[i] < 0) {
+      indexMin[i] = 0;
+      indexMax[i] = size[i] - 1;
+    }
+
+    imageInfo.cropIndex[i] = std::max(indexMin[i] - margin, 0L);
+    imageInfo.cropSize[i] = std::min(indexMax[i] + margin, static_cast<long>(size[i]) - 1) - imageInfo.cropIndex[i] + 1;
+    imageInfo.imageSize[i] = size[i];
+  }
+  AIAA_LOG_DEBUG("BoundingBox ImageInfo >>>> " << imageInfo.dump());
+  return indexMax[2] >= 0;
+}
+
+// Extracts crop region (imageInfo.cropIndex/cropSize) as is; no resampling
+template<class TImage>
+void cropImage(typename TImage::Pointer image, const std::string &outputImage, const ImageInfo &imageInfo) {
+  using ImageType = TImage;
+
+  typename ImageType::IndexType cropIndex;
+  typename ImageType::SizeType cropSize;
+  for (unsigned int i = 0; i < 3; i++) {
+    cropIndex[i] = imageInfo.cropIndex[i];
+    cropSize[i] = imageInfo.cropSize[i];
+  }
+
+  auto cropFilter = itk::RegionOfInterestImageFilter<ImageType, ImageType>::New();
+  cropFilter->SetInput(image);
+  cropFilter->SetRegionOfInterest(typename ImageType::RegionType(cropIndex, cropSize));
+  cropFilter->Update();
+
+  writeImage<ImageType>(cropFilter->GetOutput(), outputImage);
+}
+
+template<class TImage>
+typename TImage::Pointer loadImage(const std::string &fileName) {
+  typename TImage::Pointer image = TImage::New();
+  readImage<TImage>(fileName, image, true);
+  return image;
+}
+
+// Calls func with a (null) pointer tag of the scalar 3D image type matching the image file
+template<class TFunc>
+void withImageType(const std::string &inputImage, TFunc func) {
+  try {
+    itk::ImageIOBase::Pointer imageIO = itk::ImageIOFactory::CreateImageIO(inputImage.c_str(), itk::ImageIOFactory::FileModeType::ReadMode);
+    if (!imageIO) {
+      throw exception(exception::ITK_PROCESS_ERROR, ("Unsupported Image: " + inputImage).c_str());
+    }
+
+    imageIO->SetFileName(inputImage);
+    imageIO->ReadImageInformation();
+    if (imageIO->GetPixelType() != itk::ImageIOBase::SCALAR || imageIO->GetNumberOfDimensions() != 3) {
+      AIAA_LOG_ERROR("Only scalar 3D images are supported!");
+      throw exception(exception::ITK_PROCESS_ERROR, "Only scalar 3D images are supported!");
+    }
+
+    switch (imageIO->GetComponentType()) {
+      case itk::ImageIOBase::UCHAR:
+        return func(static_cast<itk::Image<unsigned char, 3>*>(nullptr));
+      case itk::ImageIOBase::CHAR:
+        return func(static_cast<itk::Image<char, 3>*>(nullptr));
+      case itk::ImageIOBase::USHORT:
+        return func(static_cast<itk::Image<unsigned short, 3>*>(nullptr));
+      case itk::ImageIOBase::SHORT:
+        return func(static_cast<itk::Image<short, 3>*>(nullptr));
+      case itk::ImageIOBase::UINT:
+        return func(static_cast<itk::Image<unsigned int, 3>*>(nullptr));
+      case itk::ImageIOBase::INT:
+        return func(static_cast<itk::Image<int, 3>*>(nullptr));
+      case itk::ImageIOBase::ULONG:
+        return func(static_cast<itk::Image<unsigned long, 3>*>(nullptr));
+      case itk::ImageIOBase::LONG:
+        return func(static_cast<itk::Image<long, 3>*>(nullptr));
+      case itk::ImageIOBase::FLOAT:
+        return func(static_cast<itk::Image<float, 3>*>(nullptr));
+      case itk::ImageIOBase::DOUBLE:
+        return func(static_cast<itk::Image<double, 3>*>(nullptr));
+      default:
+        break;
+    }
+
+    AIAA_LOG_ERROR("Unknown and unsupported component type!");
+    throw exception(exception::ITK_PROCESS_ERROR, "Unknown and unsupported component type!");
+  } catch (itk::ExceptionObject &e) {
+    AIAA_LOG_ERROR(e.what());
+    throw exception(exception::ITK_PROCESS_ERROR, e.what());
+  }
+}
+
+// Reads scalar 3D image (using image cache) and calls func with it
+template<class TFunc>
+void withImage(const std::string &inputImage, TFunc func) {
+  withImageType(inputImage, [&](auto tag) {
+    func(loadImage<typename std::remove_pointer<decltype(tag)>::type>(inputImage));
+  });
+}
+
+void AiaaUtils::imageForegroundCrop(const std::string &inputImage, const std::string &outputImage, ImageInfo &imageInfo, double threshold,
+                                    int margin) {
+  AIAA_LOG_DEBUG("Foreground Crop: " << inputImage << " => " << outputImage << "; Threshold: " << threshold << "; Margin: " << margin);
+  withImage(inputImage, [&](auto image) {
+    using ImageType = typename decltype(image)::ObjectType;
+    boundingBox<ImageType>(image, imageInfo, threshold, margin);
+    cropImage<ImageType>(image, outputImage, imageInfo);
+  });
+}
+
+bool AiaaUtils::imageBoundingBox(const std::string &inputImage, ImageInfo &imageInfo, double threshold, int margin) {
+  AIAA_LOG_DEBUG("Bounding Box: " << inputImage << "; Threshold: " << threshold << "; Margin: " << margin);
+  bool found = false;
+  withImage(inputImage, [&](auto image) {
+    found = boundingBox<typename decltype(image)::ObjectType>(image, imageInfo, threshold, margin);
+  });
+  return found;
+}
+
+void AiaaUtils::imageCrop(const std::string &inputImage, const std::string &outputImage, const ImageInfo &imageInfo) {
+  AIAA_LOG_DEBUG("Crop: " << inputImage << " => " << outputImage);
+  withImage(inputImage, [&](auto image) {
+    cropImage<typename decltype(image)::ObjectType>(image, outputImage, imageInfo);
+  });
+}
+
+void AiaaUtils::imageDownsample(const std::string &inputImage, const std::string &outputImage, ImageInfo &imageInfo, int factor) {
+  AIAA_LOG_DEBUG("Downsample: " << inputImage << " => " << outputImage << "; Factor: " << factor);
+  if (factor < 1) {
+    throw exception(exception::INVALID_ARGS_ERROR, "Downsample factor should be >= 1");
+  }
+
+  withImage(inputImage, [&](auto image) {
+    using ImageType = typename decltype(image)::ObjectType;
+
+    // Whole image is the "crop" region; roi (coarse) size is image size / factor
+    const typename ImageType::RegionType region = image->GetLargestPossibleRegion();
+    typename ImageType::SizeType roiSize;
+    for (unsigned int i = 0; i < 3; i++) {
+      imageInfo.cropIndex[i] = 0;
+      imageInfo.cropSize[i] = region.GetSize()[i];
+      imageInfo.imageSize[i] = region.GetSize()[i];
+      roiSize[i] = std::max<size_t>((region.GetSize()[i] + factor - 1) / factor, 1);
+    }
+    AIAA_LOG_DEBUG("Downsample ImageInfo >>>> " << imageInfo.dump());
+
+    writeImage<ImageType>(cropAndResizeImage<ImageType>(image, region, roiSize), outputImage);
+  });
+}
+
+void AiaaUtils::imageSliceWindow(const std::string &inputImage, const std::string &outputImage, int firstSlice, int sliceCount,
+                                 ImageInfo &imageInfo) {
+  AIAA_LOG_DEBUG("Slice Window: " << inputImage << " => " << outputImage << "; First: " << firstSlice << "; Count: " << sliceCount);
+  withImage(inputImage, [&](auto image) {
+    const auto size = image->GetLargestPossibleRegion().GetSize();
+    const int depth = static_cast<int>(size[2]);
+    if (firstSlice < 0 || sliceCount < 1 || firstSlice >= depth) {
+      throw exception(exception::INVALID_ARGS_ERROR, "Slice window is outside of image");
+    }
+
+    imageInfo = ImageInfo();
+    for (int i = 0; i < 3; i++) {
+      imageInfo.imageSize[i] = static_cast<int>(size[i]);
+      imageInfo.cropSize[i] = static_cast<int>(size[i]);
+    }
+    imageInfo.cropIndex[2] = firstSlice;
+    imageInfo.cropSize[2] = std::min(sliceCount, depth - firstSlice);
+    cropImage<typename decltype(image)::ObjectType>(image, outputImage, imageInfo);
+  });
+}
+
+//////////////////////////
+// Connected Components //
+//////////////////////////
+
+const uint32_t NO_COMPONENT = std::numeric_limits<uint32_t>::max();
 
-    case itk::ImageIOBase::UINT: {
-      using PixelType = unsigned int;
-      using ImageType = itk::Image<PixelType, VDimension>;
+// Root with path halving
+inline uint32_t findRoot(std::vector<uint32_t> &parent, uint32_t i) {
+  while (parent[i] != i) {
+    parent[i] = parent[parent[i]];
+    i = parent[i];
+  }
+  return i;
+}
+
+// Smaller index becomes the root (deterministic labelling)
+inline void unionRoots(std::vector<uint32_t> &parent, uint32_t a, uint32_t b) {
+  a = findRoot(parent, a);
+  b = findRoot(parent, b);
+  if (a < b) {
+    parent[b] = a;
+  } else if (b < a) {
+    parent[a] = b;
+  }
+}
 
-      typename ImageType::Pointer image = ImageType::New();
-      readImage<ImageType>(inputFileName, image);
-      if (pre) {
-        return preProcessImage<ImageType>(pointSet, image, outputImage, imageInfo, PAD, ROI);
+// 6-connected labelling of voxels (within box of size bx * by * bz) for which inside(i) is true
+// Slabs along Z are labelled in parallel (each thread only touches its own slab); slab borders are merged afterwards and
+// finally label[i] is the root of voxel i (NO_COMPONENT for voxels which are not inside)
+template<class TInside>
+void labelComponents(size_t bx, size_t by, size_t bz, TInside inside, std::vector<uint32_t> &label) {
+  const size_t plane = bx * by;
+  std::vector<uint32_t> parent(plane * bz, NO_COMPONENT);
+
+  const size_t slabs = std::min<size_t>(bz, std::max(1u, std::thread::hardware_concurrency()));
+  const size_t slabDepth = (bz + slabs - 1) / slabs;
+
+  Utils::parallelFor(slabs, [&](size_t s) {
+    const size_t z0 = s * slabDepth, z1 = std::min(bz, z0 + slabDepth);
+    for (size_t z = z0; z < z1; z++) {
+      for (size_t y = 0; y < by; y++) {
+        for (size_t x = 0; x < bx; x++) {
+          const uint32_t i = static_cast<uint32_t>(z * plane + y * bx + x);
+          if (!inside(i)) {
+            continue;
+          }
+
+          parent[i] = i;
+          if (x > 0 && parent[i - 1] != NO_COMPONENT) {
+            unionRoots(parent, i - 1, i);
+          }
+          if (y > 0 && parent[i - bx] != NO_COMPONENT) {
+            unionRoots(parent, i - bx, i);
+          }
+          if (z > z0 && parent[i - plane] != NO_COMPONENT) {
+            unionRoots(parent, i - plane, i);
+          }
+        }
       }
-      return postProcessImage<ImageType>(image, outputImage, imageInfo);
     }
+  });
 
-    case itk::ImageIOBase::INT: {
-      using PixelType = int;
-      using ImageType = itk::Image<PixelType, VDimension>;
+  for (size_t s = 1; s < slabs; s++) {
+    const size_t z = s * slabDepth;
+    if (z >= bz) {
+      break;
+    }
+    for (size_t j = 0; j < plane; j++) {
+      const uint32_t i = static_cast<uint32_t>(z * plane + j);
+      if (parent[i] != NO_COMPONENT && parent[i - plane] != NO_COMPONENT) {
+        unionRoots(parent, i - plane, i);
+      }
+    }
+  }
 
-      typename ImageType::Pointer image = ImageType::New();
-      readImage<ImageType>(inputFileName, image);
-      if (pre) {
-        return preProcessImage<ImageType>(pointSet, image, outputImage, imageInfo, PAD, ROI);
+  // No more unions; parent is only read from here on (paths may cross slabs), roots are written into label
+  label.resize(parent.size());
+  Utils::parallelFor(slabs, [&](size_t s) {
+    const size_t begin = s * slabDepth * plane, end = std::min(bz, (s + 1) * slabDepth) * plane;
+    for (size_t i = begin; i < end; i++) {
+      uint32_t r = parent[i];
+      if (r != NO_COMPONENT) {
+        while (parent[r] != r) {
+          r = parent[r];
+        }
       }
-      return postProcessImage<ImageType>(image, outputImage, imageInfo);
+      label[i] = r;
     }
+  });
+}
 
-    case itk::ImageIOBase::ULONG: {
-      using PixelType = unsigned long;
-      using ImageType = itk::Image<PixelType, VDimension>;
+// Keeps largest N components / removes components smaller than minSize / fills holes of a mask; only the bounding box
+// of the mask is scanned
+template<class TImage>
+void filterComponents(typename TImage::Pointer image, int keepLargest, int minSize, bool fillHoles) {
+  using ImageType = TImage;
+  using PixelType = typename ImageType::PixelType;
+
+  ImageInfo box;
+  boundingBox<ImageType>(image, box, 0, 0);
+
+  const size_t sx = box.imageSize[0], sy = box.imageSize[1];
+  const size_t ox = box.cropIndex[0], oy = box.cropIndex[1], oz = box.cropIndex[2];
+  const size_t bx = box.cropSize[0], by = box.cropSize[1], bz = box.cropSize[2];
+  if (static_cast<double>(bx) * by * bz >= NO_COMPONENT) {
+    throw exception(exception::ITK_PROCESS_ERROR, "Mask bounding box is too large for component filter");
+  }
 
-      typename ImageType::Pointer image = ImageType::New();
-      readImage<ImageType>(inputFileName, image);
-      if (pre) {
-        return preProcessImage<ImageType>(pointSet, image, outputImage, imageInfo, PAD, ROI);
+  // Calls func(boxIndex, pixel) for each voxel of the bounding box (slices in parallel)
+  PixelType *buffer = image->GetBufferPointer();
+  auto forEachVoxel = [&](auto func) {
+    Utils::parallelFor(bz, [&](size_t z) {
+      size_t i = z * bx * by;
+      for (size_t y = 0; y < by; y++) {
+        PixelType *row = buffer + ((z + oz) * sy + (y + oy)) * sx + ox;
+        for (size_t x = 0; x < bx; x++, i++) {
+          func(i, row[x]);
+        }
+      }
+    });
+  };
+
+  std::vector<char> mask(bx * by * bz);
+  forEachVoxel([&mask](size_t i, PixelType &p) {
+    mask[i] = p != 0;
+  });
+
+  std::vector<uint32_t> label;
+  if (keepLargest > 0 || minSize > 0) {
+    labelComponents(bx, by, bz, [&mask](uint32_t i) {
+      return mask[i] != 0;
+    }, label);
+
+    std::vector<uint32_t> size(label.size(), 0);
+    std::vector<uint32_t> roots;
+    for (size_t i = 0; i < label.size(); i++) {
+      if (label[i] != NO_COMPONENT && size[label[i]]++ == 0) {
+        roots.push_back(label[i]);
       }
-      return postProcessImage<ImageType>(image, outputImage, imageInfo);
     }
 
-    case itk::ImageIOBase::LONG: {
-      using PixelType = long;
-      using ImageType = itk::Image<PixelType, VDimension>;
+    std::vector<char> keep(label.size(), 0);
+    std::sort(roots.begin(), roots.end(), [&size](uint32_t a, uint32_t b) {
+      return size[a] != size[b] ? size[a] > size[b] : a < b;
+    });
+    for (size_t k = 0; k < roots.size(); k++) {
+      keep[roots[k]] = (keepLargest <= 0 || k < static_cast<size_t>(keepLargest)) && size[roots[k]] >= static_cast<uint32_t>(minSize);
+    }
+    AIAA_LOG_DEBUG("Components: " << roots.size() << "; Largest: " << (roots.empty() ? 0 : size[roots[0]]));
 
-      typename ImageType::Pointer image = ImageType::New();
-      readImage<ImageType>(inputFileName, image);
-      if (pre) {
-        return preProcessImage<ImageType>(pointSet, image, outputImage, imageInfo, PAD, ROI);
+    forEachVoxel([&](size_t i, PixelType &p) {
+      if (label[i] != NO_COMPONENT && !keep[label[i]]) {
+        p = 0;
+        mask[i] = 0;
+      }
+    });
+  }
+
+  if (fillHoles) {
+    // Background components which do not touch the bounding box faces are holes
+    labelComponents(bx, by, bz, [&mask](uint32_t i) {
+      return mask[i] == 0;
+    }, label);
+
+    std::vector<char> outside(label.size(), 0);
+    for (size_t z = 0, i = 0; z < bz; z++) {
+      for (size_t y = 0; y < by; y++) {
+        for (size_t x = 0; x < bx; x++, i++) {
+          if (label[i] != NO_COMPONENT && (x == 0 || y == 0 || z == 0 || x == bx - 1 || y == by - 1 || z == bz - 1)) {
+            outside[label[i]] = 1;
+          }
+        }
       }
-      return postProcessImage<ImageType>(image, outputImage, imageInfo);
     }
 
-    case itk::ImageIOBase::FLOAT: {
-      using PixelType = float;
-      using ImageType = itk::Image<PixelType, VDimension>;
+    // Hole voxel takes the value of its -x neighbour (foreground or already filled); it always exists as holes never touch
+    // the bounding box faces. Rows are independent, so slices are filled in parallel
+    forEachVoxel([&](size_t i, PixelType &p) {
+      if (label[i] != NO_COMPONENT && !outside[label[i]]) {
+        p = *(&p - 1);
+      }
+    });
+  }
+}
+
+void AiaaUtils::imageComponentFilter(const std::string &inputImage, const std::string &outputImage, int keepLargest, int minSize,
+                                     bool fillHoles) {
+  AIAA_LOG_DEBUG("Component Filter: " << inputImage << " => " << outputImage << "; KeepLargest: " << keepLargest << "; MinSize: " << minSize
+      << "; FillHoles: " << fillHoles);
+
+  withImageType(inputImage, [&](auto tag) {
+    using ImageType = typename std::remove_pointer<decltype(tag)>::type;
+
+    // Mask is modified in place; read it without the image cache so that its buffer is private (never a cached decoded image)
+    typename ImageType::Pointer image = ImageType::New();
+    readImage<ImageType>(inputImage, image, false);
 
-      typename ImageType::Pointer image = ImageType::New();
-      readImage<ImageType>(inputFileName, image);
-      if (pre) {
-        return preProcessImage<ImageType>(pointSet, image, outputImage, imageInfo, PAD, ROI);
+    filterComponents<ImageType>(image, keepLargest, minSize, fillHoles);
+    writeImage<ImageType>(image, outputImage);
+  });
+}
+
+/////////////////////
+// Mask To Polygon //
+/////////////////////
+
+// Calls init(slices) and then func(z, mask, width, height) in parallel for every Z slice of inputImage that has foreground
+// (mask is 1 for non-zero voxels)
+template<class TInit, class TFunc>
+void forEachMaskSlice(const std::string &inputImage, TInit init, TFunc func) {
+  withImage(inputImage, [&](auto image) {
+    using ImageType = typename decltype(image)::ObjectType;
+    using PixelType = typename ImageType::PixelType;
+
+    const typename ImageType::SizeType size = image->GetLargestPossibleRegion().GetSize();
+    const size_t sliceSize = size[0] * size[1];
+    const PixelType *buffer = image->GetBufferPointer();
+
+    init(size[2]);
+    Utils::parallelFor(size[2], [&](size_t z) {
+      const PixelType *slice = buffer + z * sliceSize;
+
+      std::vector<unsigned char> mask(sliceSize);
+      bool foreground = false;
+      for (size_t i = 0; i < sliceSize; i++) {
+        mask[i] = slice[i] != PixelType() ? 1 : 0;
+        foreground |= mask[i] != 0;
+      }
+      if (foreground) {
+        func(z, mask.data(), static_cast<int>(size[0]), static_cast<int>(size[1]));
       }
-      return postProcessImage<ImageType>(image, outputImage, imageInfo);
+    });
+  });
+}
+
+PolygonsList AiaaUtils::imageMaskToPolygon(const std::string &inputImage, int pointRatio) {
+  AIAA_LOG_DEBUG("Mask To Polygon: " << inputImage << "; PointRatio: " << pointRatio);
+
+  PolygonsList polygonsList;
+  forEachMaskSlice(inputImage, [&](size_t slices) {
+    polygonsList.list.resize(slices);
+  }, [&](size_t z, const unsigned char *mask, int width, int height) {
+    polygonsList.list[z] = Polygons::fromMask(mask, width, height, pointRatio);
+  });
+  return polygonsList;
+}
+
+FlatPolygonsList AiaaUtils::imageMaskToFlatPolygons(const std::string &inputImage, int pointRatio) {
+  AIAA_LOG_DEBUG("Mask To Flat Polygons: " << inputImage << "; PointRatio: " << pointRatio);
+
+  // Each slice is traced into its own flat buffer (in parallel) and then concatenated
+  std::vector<FlatPolygonsList> slices;
+  forEachMaskSlice(inputImage, [&](size_t n) {
+    slices.resize(n);
+  }, [&](size_t z, const unsigned char *mask, int width, int height) {
+    slices[z].addSlice(mask, width, height, pointRatio);
+  });
+
+  FlatPolygonsList flat;
+  size_t polygons = 0, coords = 0;
+  for (auto &s : slices) {
+    polygons += s.polygonOffsets.size() - 1;
+    coords += s.coords.size();
+  }
+  flat.coords.reserve(coords);
+  flat.polygonOffsets.reserve(polygons + 1);
+  flat.sliceOffsets.reserve(slices.size() + 1);
+  for (auto &s : slices) {
+    if (s.empty()) {
+      flat.addSlice();
+    } else {
+      flat.append(s);
     }
+  }
+  return flat;
+}
 
-    case itk::ImageIOBase::DOUBLE: {
-      using PixelType = double;
-      using ImageType = itk::Image<PixelType, VDimension>;
+////////////
+// Tiling //
+////////////
 
-      typename ImageType::Pointer image = ImageType::New();
-      readImage<ImageType>(inputFileName, image);
-      if (pre) {
-        return preProcessImage<ImageType>(pointSet, image, outputImage, imageInfo, PAD, ROI);
+std::vector<ImageInfo> AiaaUtils::imageTiles(const std::string &inputImage, const std::vector<int> &tileSize, int overlap) {
+  AIAA_LOG_DEBUG("Tiles: " << inputImage << "; Overlap: " << overlap);
+  if (tileSize.size() < 3 || overlap < 0) {
+    throw exception(exception::INVALID_ARGS_ERROR, "Tile size should be [x,y,z] and overlap should be >= 0");
+  }
+
+  int imageSize[3];
+  try {
+    itk::ImageIOBase::Pointer imageIO = itk::ImageIOFactory::CreateImageIO(inputImage.c_str(), itk::ImageIOFactory::FileModeType::ReadMode);
+    if (!imageIO) {
+      throw exception(exception::ITK_PROCESS_ERROR, ("Unsupported Image: " + inputImage).c_str());
+    }
+
+    imageIO->SetFileName(inputImage);
+    imageIO->ReadImageInformation();
+    if (imageIO->GetNumberOfDimensions() != 3) {
+      throw exception(exception::ITK_PROCESS_ERROR, "Only 3D images are supported!");
+    }
+    for (unsigned int i = 0; i < 3; i++) {
+      imageSize[i] = imageIO->GetDimensions(i);
+    }
+  } catch (itk::ExceptionObject &e) {
+    AIAA_LOG_ERROR(e.what());
+    throw exception(exception::ITK_PROCESS_ERROR, e.what());
+  }
+
+  // Regular grid per axis; last tile is aligned to the image border
+  std::vector<int> starts[3];
+  int tile[3];
+  for (unsigned int i = 0; i < 3; i++) {
+    tile[i] = std::min(tileSize[i], imageSize[i]);
+    int stride = tile[i] - overlap;
+    if (stride < 1) {
+      throw exception(exception::INVALID_ARGS_ERROR, "Overlap should be less than tile size");
+    }
+
+    for (int start = 0;; start += stride) {
+      if (start + tile[i] >= imageSize[i]) {
+        starts[i].push_back(imageSize[i] - tile[i]);
+        break;
       }
-      return postProcessImage<ImageType>(image, outputImage, imageInfo);
+      starts[i].push_back(start);
     }
   }
 
-  AIAA_LOG_ERROR("Unknown and unsupported component type!");
-  throw exception(exception::ITK_PROCESS_ERROR, "Unknown and unsupported component type!");
+  std::vector<ImageInfo> tiles;
+  for (int z : starts[2]) {
+    for (int y : starts[1]) {
+      for (int x : starts[0]) {
+        ImageInfo info;
+        int index[3] = { x, y, z };
+        for (unsigned int i = 0; i < 3; i++) {
+          info.imageSize[i] = imageSize[i];
+          info.cropIndex[i] = index[i];
+          info.cropSize[i] = tile[i];
+        }
+        tiles.push_back(info);
+      }
+    }
+  }
+
+  AIAA_LOG_DEBUG("Total Tiles: " << tiles.size() << " (" << starts[0].size() << "x" << starts[1].size() << "x" << starts[2].size() << ")");
+  return tiles;
 }
 
-PointSet processImage(const PointSet &pointSet, const std::string &inputImage, const std::string &outputImage, ImageInfo &imageInfo, double PAD,
-                      const Point &ROI, bool pre = true) {
+void AiaaUtils::imageCrop(const std::string &inputImage, const std::vector<std::string> &outputImages, const std::vector<ImageInfo> &imageInfos) {
+  AIAA_LOG_DEBUG("Crop: " << inputImage << " => " << outputImages.size() << " images");
+  if (outputImages.size() != imageInfos.size()) {
+    throw exception(exception::INVALID_ARGS_ERROR, "Mismatch in number of OutputImages/ImageInfos");
+  }
 
-  try {
-    AIAA_LOG_DEBUG("Input Image: " << inputImage);
+  // Image is read once; crops are written in parallel
+  withImage(inputImage, [&](auto image) {
+    using ImageType = typename decltype(image)::ObjectType;
+    Utils::parallelFor(outputImages.size(), [&](size_t i) {
+      cropImage<ImageType>(image, outputImages[i], imageInfos[i]);
+    });
+  });
+}
 
-    const char *inputFileName = inputImage.c_str();
-    itk::ImageIOBase::Pointer imageIO = itk::ImageIOFactory::CreateImageIO(inputFileName, itk::ImageIOFactory::FileModeType::ReadMode);
+// One axis of the tile grid: sorted unique tile starts and, for each image index, range of covering tiles and the tile
+// whose center is nearest
+struct TileAxis {
+  std::vector<int> starts;
+  std::vector<int> first, last, center;
 
-    imageIO->SetFileName(inputFileName);
-    imageIO->ReadImageInformation();
+  TileAxis(const std::vector<ImageInfo> &tiles, unsigned int axis) {
+    for (auto &t : tiles) {
+      starts.push_back(t.cropIndex[axis]);
+    }
+    std::sort(starts.begin(), starts.end());
+    starts.erase(std::unique(starts.begin(), starts.end()), starts.end());
+
+    const int size = tiles[0].imageSize[axis];
+    const int tile = tiles[0].cropSize[axis];
+    first.assign(size, -1);
+    last.assign(size, -1);
+    center.assign(size, -1);
+
+    for (int k = 0; k < static_cast<int>(starts.size()); k++) {
+      for (int x = starts[k]; x < starts[k] + tile && x < size; x++) {
+        if (first[x] < 0) {
+          first[x] = k;
+        }
+        last[x] = k;
+
+        double d = std::abs(x - (starts[k] + tile / 2.0));
+        if (center[x] < 0 || d < std::abs(x - (starts[center[x]] + tile / 2.0))) {
+          center[x] = k;
+        }
+      }
+    }
+  }
 
-    using IOPixelType = itk::ImageIOBase::IOPixelType;
-    const IOPixelType pixelType = imageIO->GetPixelType();
+  int find(int start) const {
+    return static_cast<int>(std::lower_bound(starts.begin(), starts.end(), start) - starts.begin());
+  }
+};
 
-    AIAA_LOG_DEBUG("Pixel Type is " << itk::ImageIOBase::GetPixelTypeAsString(pixelType));
+template<class TImage>
+void stitchTiles(const std::vector<std::string> &tileImages, const std::vector<ImageInfo> &tiles, const std::string &outputImage,
+                 AiaaUtils::TileStitching stitching) {
+  using ImageType = TImage;
+  using PixelType = typename ImageType::PixelType;
 
-    using IOComponentType = itk::ImageIOBase::IOComponentType;
-    const IOComponentType componentType = imageIO->GetComponentType();
-    AIAA_LOG_DEBUG("Component Type is " << imageIO->GetComponentTypeAsString(componentType));
+  // Tiles must form a complete regular grid (as returned by imageTiles) which covers every voxel of the image
+  for (auto &t : tiles) {
+    for (unsigned int i = 0; i < 3; i++) {
+      if (t.imageSize[i] != tiles[0].imageSize[i] || t.cropSize[i] != tiles[0].cropSize[i]) {
+        throw exception(exception::INVALID_ARGS_ERROR, "Tiles should be of same size and from same image");
+      }
+      if (t.cropSize[i] < 1 || t.cropIndex[i] < 0 || t.cropIndex[i] + t.cropSize[i] > t.imageSize[i]) {
+        throw exception(exception::INVALID_ARGS_ERROR, "Tile is outside of the image");
+      }
+    }
+  }
 
-    const unsigned int imageDimension = imageIO->GetNumberOfDimensions();
-    AIAA_LOG_DEBUG("Image Dimension is " << imageDimension);
+  const TileAxis ax(tiles, 0), ay(tiles, 1), az(tiles, 2);
+  for (auto axis : { &ax, &ay, &az }) {
+    if (std::find(axis->first.begin(), axis->first.end(), -1) != axis->first.end()) {
+      throw exception(exception::INVALID_ARGS_ERROR, "Tiles do not cover the whole image");
+    }
+  }
 
-    if (pixelType == itk::ImageIOBase::SCALAR) {
-      if (imageDimension == 3) {
-        return processImage<3>(componentType, pointSet, inputImage, outputImage, imageInfo, PAD, ROI, pre);
+  const size_t nx = ax.starts.size(), ny = ay.starts.size();
+  std::vector<int> grid(nx * ny * az.starts.size(), -1);
+  for (size_t t = 0; t < tiles.size(); t++) {
+    grid[(az.find(tiles[t].cropIndex[2]) * ny + ay.find(tiles[t].cropIndex[1])) * nx + ax.find(tiles[t].cropIndex[0])] = t;
+  }
+  if (std::find(grid.begin(), grid.end(), -1) != grid.end()) {
+    throw exception(exception::INVALID_ARGS_ERROR, "Tiles do not form a complete grid");
+  }
+
+  std::vector<typename ImageType::Pointer> images(tileImages.size());
+  Utils::parallelFor(tileImages.size(), [&](size_t t) {
+    images[t] = ImageType::New();
+    readImage<ImageType>(tileImages[t], images[t], false);
+
+    auto size = images[t]->GetLargestPossibleRegion().GetSize();
+    for (unsigned int i = 0; i < 3; i++) {
+      if (static_cast<int>(size[i]) != tiles[t].cropSize[i]) {
+        throw exception(exception::ITK_PROCESS_ERROR, ("Tile size mismatch for: " + tileImages[t]).c_str());
+      }
+    }
+  });
+
+  const int sx = tiles[0].imageSize[0], sy = tiles[0].imageSize[1], sz = tiles[0].imageSize[2];
+  typename ImageType::RegionType region;
+  region.SetSize(0, sx);
+  region.SetSize(1, sy);
+  region.SetSize(2, sz);
+
+  // Geometry of the whole image derived from first tile (same as post-processing of crop region)
+  typename ImageType::Pointer output = ImageType::New();
+  typename ImageType::PointType origin = images[0]->GetOrigin();
+  for (unsigned int i = 0; i < 3; i++) {
+    for (unsigned int j = 0; j < 3; j++) {
+      origin[i] -= images[0]->GetDirection()[i][j] * tiles[0].cropIndex[j] * images[0]->GetSpacing()[j];
+    }
+  }
+  output->SetRegions(region);
+  output->SetOrigin(origin);
+  output->SetSpacing(images[0]->GetSpacing());
+  output->SetDirection(images[0]->GetDirection());
+  output->Allocate();
+
+  PixelType *dst = output->GetBufferPointer();
+  Utils::parallelFor(sz, [&](size_t z) {
+    // Values of all covering tiles of a voxel; reused for the whole slice (any overlap, no fixed limit)
+    std::vector<PixelType> values;
+    for (int y = 0; y < sy; y++) {
+      PixelType *row = dst + (z * sy + y) * sx;
+      for (int x = 0; x < sx; x++) {
+        auto value = [&](int kx, int ky, int kz) {
+          const ImageInfo &t = tiles[grid[(kz * ny + ky) * nx + kx]];
+          const PixelType *src = images[grid[(kz * ny + ky) * nx + kx]]->GetBufferPointer();
+          return src[((z - t.cropIndex[2]) * t.cropSize[1] + (y - t.cropIndex[1])) * t.cropSize[0] + (x - t.cropIndex[0])];
+        };
+
+        if (stitching == AiaaUtils::STITCH_CENTER_CROP) {
+          row[x] = value(ax.center[x], ay.center[y], az.center[z]);
+          continue;
+        }
+
+        // Majority vote (ties resolved to larger label) or max value over all covering tiles
+        values.clear();
+        for (int kz = az.first[z]; kz <= az.last[z]; kz++) {
+          for (int ky = ay.first[y]; ky <= ay.last[y]; ky++) {
+            for (int kx = ax.first[x]; kx <= ax.last[x]; kx++) {
+              values.push_back(value(kx, ky, kz));
+            }
+          }
+        }
+
+        if (stitching == AiaaUtils::STITCH_MAX_PROBABILITY) {
+          row[x] = *std::max_element(values.begin(), values.end());
+          continue;
+        }
+
+        std::sort(values.begin(), values.end());
+        const int count = static_cast<int>(values.size());
+        PixelType best = values[0];
+        int bestVotes = 0;
+        for (int i = 0; i < count;) {
+          int j = i;
+          while (j < count && values[j] == values[i]) {
+            j++;
+          }
+          if (j - i >= bestVotes) {
+            best = values[i];
+            bestVotes = j - i;
+          }
+          i = j;
+        }
+        row[x] = best;
       }
     }
+  });
 
-    AIAA_LOG_ERROR("ImageReader: not implemented yet!");
-    throw exception(exception::ITK_PROCESS_ERROR, "ImageReader: not implemented yet!");
+  writeImage<ImageType>(output, outputImage);
+}
 
-  } catch (itk::ExceptionObject &e) {
-    AIAA_LOG_ERROR(e.what());
-    throw exception(exception::ITK_PROCESS_ERROR, e.what());
+void AiaaUtils::imageTileStitch(const std::vector<std::string> &tileImages, const std::vector<ImageInfo> &tiles, const std::string &outputImage,
+                                TileStitching stitching) {
+  AIAA_LOG_DEBUG("Stitch: " << tileImages.size() << " tiles => " << outputImage << "; Stitching: " << stitching);
+  if (tileImages.empty() || tileImages.size() != tiles.size()) {
+    throw exception(exception::INVALID_ARGS_ERROR, "Mismatch in number of TileImages/Tiles");
   }
+
+  // Tile images are expected to be of same type (type of first tile is used)
+  withImageType(tileImages[0], [&](auto tag) {
+    stitchTiles<typename std::remove_pointer<decltype(tag)>::type>(tileImages, tiles, outputImage, stitching);
+  });
 }
 
 PointSet AiaaUtils::imagePreProcess(const PointSet &pointSet, const std::string &inputImage, const std::string &outputImage, ImageInfo &imageInfo,
                                     double PAD, const Point &ROI) {
-  return processImage(pointSet, inputImage, outputImage, imageInfo, PAD, ROI, true);
+  std::vector<ImageInfo> imageInfos(1, imageInfo);
+  std::vector<PointSet> pointSetROIs = processImage( { pointSet }, inputImage, { outputImage }, imageInfos, { PAD }, { ROI }, true);
+
+  imageInfo = imageInfos[0];
+  return pointSetROIs[0];
+}
+
+std::vector<PointSet> AiaaUtils::imagePreProcess(const std::vector<PointSet> &pointSets, const std::string &inputImage,
+                                                 const std::vector<std::string> &outputImages, std::vector<ImageInfo> &imageInfos,
+                                                 const std::vector<double> &PAD, const std::vector<Point> &ROI) {
+  if (pointSets.size() != outputImages.size() || PAD.size() != outputImages.size() || ROI.size() != outputImages.size()) {
+    AIAA_LOG_ERROR("Mismatch in number of PointSets/OutputImages/PAD/ROI");
+    throw exception(exception::INVALID_ARGS_ERROR, "Mismatch in number of PointSets/OutputImages/PAD/ROI");
+  }
+
+  imageInfos.resize(outputImages.size());
+  return processImage(pointSets, inputImage, outputImages, imageInfos, PAD, ROI, true);
 }
 
 void AiaaUtils::imagePostProcess(const std::string &inputImage, const std::string &outputImage, const ImageInfo &imageInfo) {
-  ImageInfo info = imageInfo;
-  processImage(PointSet(), inputImage, outputImage, info, 0.0, Point(), false);
+  std::vector<ImageInfo> imageInfos(1, imageInfo);
+  processImage( { PointSet() }, inputImage, { outputImage }, imageInfos, { 0.0 }, { Point() }, false);
+}
+
+void AiaaUtils::imagePostProcess(const std::string &inputImage, unsigned char *labelBuffer, const ImageInfo &imageInfo) {
+  postProcessImage<unsigned char>(inputImage, labelBuffer, imageInfo);
+}
+
+void AiaaUtils::imagePostProcess(const std::string &inputImage, unsigned short *labelBuffer, const ImageInfo &imageInfo) {
+  postProcessImage<unsigned short>(inputImage, labelBuffer, imageInfo);
+}
+
+void AiaaUtils::imagePostProcessROI(const std::string &inputImage, const std::string &outputImage, const ImageInfo &imageInfo) {
+  std::vector<ImageInfo> imageInfos(1, imageInfo);
+  processImage( { PointSet() }, inputImage, { outputImage }, imageInfos, { 0.0 }, { Point() }, false, true);
 }
 
 }
@@ -32,8 +32,16 @@
 #include "../include/nvidia/aiaa/log.h"
 #include "../include/nvidia/aiaa/utils.h"
 #include "../include/nvidia/aiaa/curlutils.h"
+#include "../include/nvidia/aiaa/jsonwriter.h"
+#include "../include/nvidia/aiaa/binarycodec.h"
+#include "../include/nvidia/aiaa/niftidecoder.h"
+#include "../include/nvidia/aiaa/imagecache.h"
 
 #include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <mutex>
 #include <set>
 
 namespace nvidia {
@@ -51,6 +59,9 @@ const std::string EP_SESSION = "/session/";
 const std::string IMAGE_FILE_EXTENSION = ".nii.gz";
 
 const int Client::MIN_POINTS_FOR_SEGMENTATION = 6;
+const double Client::DEFAULT_FOREGROUND_THRESHOLD = -500.0;
+const int Client::DEFAULT_FOREGROUND_MARGIN = 10;
+const int Client::DEFAULT_PROGRESSIVE_FACTOR = 4;
 
 class AutoRemoveFiles {
   std::set<std::string> files;
@@ -62,11 +73,96 @@ class AutoRemoveFiles {
 
   ~AutoRemoveFiles() {
     for (auto it = files.begin(); it != files.end(); it++) {
+      ImageCache::instance().erase(*it);
       std::remove((*it).c_str());
     }
   }
 };
 
+// Prepares input image for upload: quantize (clip to model's intensity window) or re-encode slab by slab into a temporary .nii.gz
+// so that upload never holds the whole volume in memory; otherwise input image is uploaded as is
+std::string uploadImageFile(const std::string &inputImageFile, const Model &model, AiaaUtils::QuantizationType quantization,
+                            unsigned int streamDivisions, AutoRemoveFiles &autoRemoveFiles) {
+  const std::string ext = IMAGE_FILE_EXTENSION;
+  bool niftiGz = inputImageFile.size() > ext.size() && inputImageFile.compare(inputImageFile.size() - ext.size(), ext.size(), ext) == 0;
+  bool quantize = quantization != AiaaUtils::QUANTIZE_NONE && model.intensity_window.size() == 2;
+  if (inputImageFile.empty() || (!quantize && (!streamDivisions || niftiGz))) {
+    return inputImageFile;
+  }
+
+  std::string uploadFile = Utils::tempfilename() + IMAGE_FILE_EXTENSION;
+  autoRemoveFiles.add(uploadFile);
+
+  if (quantize) {
+    AiaaUtils::imageQuantize(inputImageFile, uploadFile, model.intensity_window[0], model.intensity_window[1], quantization,
+                             std::max(streamDivisions, 1u));
+  } else {
+    AiaaUtils::imageConvert(inputImageFile, uploadFile, streamDivisions);
+  }
+  return uploadFile;
+}
+
+// Shifts points (index within crop region) back to index within original image
+void shiftPoints(PointSet &pointSet, const ImageInfo &imageInfo) {
+  for (auto &point : pointSet.points) {
+    for (size_t i = 0; i < point.size() && i < 3; i++) {
+      point[i] += imageInfo.cropIndex[i];
+    }
+  }
+}
+
+// Adds quantization (scale/offset) into params if model publishes an intensity window; quantization which rescales intensities
+// is applied only if explicitly allowed (server has to de-quantize the input)
+bool quantizationParams(const Model &model, AiaaUtils::QuantizationType type, bool allowRescale, const std::string &inputImageFile,
+                        std::string &paramStr) {
+  if (type == AiaaUtils::QUANTIZE_NONE || inputImageFile.empty() || model.intensity_window.size() != 2) {
+    return false;
+  }
+
+  double scale, offset;
+  AiaaUtils::quantizationScale(model.intensity_window[0], model.intensity_window[1], type, scale, offset);
+  if (scale != 1 || offset != 0) {
+    if (!allowRescale) {
+      AIAA_LOG_WARN("Skip Quantization for Model: " << model.name << "; it rescales intensities (Scale: " << scale << "; Offset: " << offset
+          << ") and rescaling is not enabled");
+      return false;
+    }
+    AIAA_LOG_WARN("Quantization rescales intensities (Scale: " << scale << "; Offset: " << offset << "); server must de-quantize input");
+  }
+
+  try {
+    nlohmann::json j = nlohmann::json::parse(paramStr.empty() ? "{}" : paramStr);
+    nlohmann::json q;
+    q["type"] = type == AiaaUtils::QUANTIZE_INT16 ? "int16" : "uint8";
+    q["scale"] = scale;
+    q["offset"] = offset;
+    q["window"] = model.intensity_window;
+    j["quantization"] = q;
+    paramStr = j.dump();
+  } catch (nlohmann::json::parse_error &e) {
+    AIAA_LOG_ERROR(e.what());
+    throw exception(exception::INVALID_ARGS_ERROR, e.what());
+  }
+  return true;
+}
+
+// Accept header for polygon responses (binary preferred; JSON as fallback)
+std::string polygonAccept(bool binary) {
+  return binary ? std::string(BINARY_ARRAY_CONTENT_TYPE) + ", application/json;q=0.5" : std::string();
+}
+
+// Decodes polygon response as binary (if server honored Accept header) or JSON
+template<class TPolygons>
+TPolygons polygonResponse(const std::string &response, const std::string &contentType, const std::string &key) {
+  if (contentType.compare(0, sizeof(BINARY_ARRAY_CONTENT_TYPE) - 1, BINARY_ARRAY_CONTENT_TYPE) == 0 || isBinaryArray(response)) {
+    AIAA_LOG_DEBUG("Response (binary): " << response.size() << " bytes");
+    return TPolygons::fromBinary(response);
+  }
+
+  AIAA_LOG_DEBUG("Response: \n" << response);
+  return TPolygons::fromJson(response, key);
+}
+
 Client::Client(const std::string &uri, int timeout)
     :
     serverUri(uri),
@@ -76,6 +172,54 @@ Client::Client(const std::string &uri, int timeout)
   }
 }
 
+void Client::setUploadStreamDivisions(unsigned int streamDivisions) {
+  uploadStreamDivisions = streamDivisions;
+}
+
+void Client::setUploadQuantization(AiaaUtils::QuantizationType type, bool allowRescale) {
+  uploadQuantization = type;
+  uploadQuantizationRescale = allowRescale;
+}
+
+void Client::setResultCleanup(int keepLargest, int minComponentSize, bool fillHoles) {
+  cleanupKeepLargest = keepLargest;
+  cleanupMinSize = minComponentSize;
+  cleanupFillHoles = fillHoles;
+}
+
+void Client::setBinaryPolygons(bool enable) {
+  binaryPolygons = enable;
+}
+
+void Client::setBatchedVertexEdits(bool enable) {
+  batchedVertexEdits = enable;
+}
+
+void Client::setPolygonSimplification(double tolerance, Polygons::SimplifyMethod method) {
+  simplifyTolerance = tolerance;
+  simplifyMethod = method;
+}
+
+void Client::cleanupResult(const std::string &outputImageFile) const {
+  if (cleanupKeepLargest > 0 || cleanupMinSize > 0 || cleanupFillHoles) {
+    AiaaUtils::imageComponentFilter(outputImageFile, outputImageFile, cleanupKeepLargest, cleanupMinSize, cleanupFillHoles);
+  }
+}
+
+void Client::setForegroundCrop(bool enable, double threshold, int marginInVoxels) {
+  foregroundCrop = enable;
+  foregroundThreshold = threshold;
+  foregroundMargin = marginInVoxels;
+}
+
+void Client::setResultCache(const std::string &cacheDir, size_t maxSizeInBytes) {
+  if (cacheDir.empty()) {
+    resultCache.reset();
+  } else {
+    resultCache = std::make_shared<ResultCache>(cacheDir, maxSizeInBytes);
+  }
+}
+
 Model Client::model(const std::string &name) const {
   if (name.empty()) {
     AIAA_LOG_ERROR("Model Name is empty");
@@ -129,9 +273,143 @@ PointSet Client::segmentation(const Model &model, const std::string &inputImageF
     inputImage = "";
   }
   std::string paramStr = "{}";
+  bool quantize = quantizationParams(model, uploadQuantization, uploadQuantizationRescale, inputImage, paramStr);
+  bool crop = foregroundCrop && !inputImage.empty();
+  bool cleanup = cleanupKeepLargest > 0 || cleanupMinSize > 0 || cleanupFillHoles;
+
+  std::string cacheKey;
+  std::string response;
+  if (resultCache && !inputImage.empty()) {
+    std::string op = "segmentation";
+    if (crop) {
+      op += "|crop=" + Utils::lexical_cast<std::string>(foregroundThreshold) + "," + Utils::lexical_cast<std::string>(foregroundMargin);
+    }
+    if (cleanup) {
+      op += "|cleanup=" + Utils::lexical_cast<std::string>(cleanupKeepLargest) + "," + Utils::lexical_cast<std::string>(cleanupMinSize) + ","
+          + Utils::lexical_cast<std::string>(cleanupFillHoles);
+    }
+    cacheKey = ResultCache::key(serverUri, op, model, paramStr, inputImage);
+    if (resultCache->get(cacheKey, outputImageFile, response)) {
+      AIAA_LOG_INFO("Using cached result for: " << inputImage);
+      return PointSet::fromJson(response, "points");
+    }
+  }
 
-  std::string response = CurlUtils::doMethod("POST", uri, paramStr, inputImage, outputImageFile, timeoutInSec);
-  return PointSet::fromJson(response, "points");
+  AutoRemoveFiles autoRemoveFiles;
+
+  // Foreground (body) crop; only the bounding box is uploaded and result mask is re-embedded into original image space
+  ImageInfo imageInfo;
+  std::string croppedOutputFile = outputImageFile;
+  if (crop) {
+    std::string croppedInputFile = Utils::tempfilename() + IMAGE_FILE_EXTENSION;
+    croppedOutputFile = Utils::tempfilename() + IMAGE_FILE_EXTENSION;
+    autoRemoveFiles.add(croppedInputFile);
+    autoRemoveFiles.add(croppedOutputFile);
+
+    AiaaUtils::imageForegroundCrop(inputImage, croppedInputFile, imageInfo, foregroundThreshold, foregroundMargin);
+    inputImage = croppedInputFile;
+  }
+
+  std::string uploadFile = uploadImageFile(inputImage, model, quantize ? uploadQuantization : AiaaUtils::QUANTIZE_NONE, uploadStreamDivisions,
+                                           autoRemoveFiles);
+
+  // Result mask is decoded while it downloads if it is processed further on client side
+  NiftiStreamDecoder decoder;
+  std::function<void(const char*, size_t)> onData;
+  if (crop || cleanup) {
+    onData = [&decoder](const char *data, size_t size) {
+      decoder.write(data, size);
+    };
+  }
+
+  bool resultWritten = false;
+  response = CurlUtils::doMethod("POST", uri, paramStr, uploadFile, croppedOutputFile, timeoutInSec, onData, "", nullptr, &resultWritten);
+  PointSet pointSet = PointSet::fromJson(response, "points");
+  if (onData) {
+    decoder.publish(croppedOutputFile);
+  }
+
+  if (crop) {
+    AiaaUtils::imagePostProcess(croppedOutputFile, outputImageFile, imageInfo);
+    shiftPoints(pointSet, imageInfo);
+    response = "{\"points\":" + pointSet.toJson() + "}";
+  }
+  cleanupResult(outputImageFile);
+  if (onData && !crop) {
+    // Published image was outputImageFile itself, which cleanup has rewritten
+    ImageCache::instance().erase(outputImageFile);
+  }
+
+  // Result image is cached only if this request produced it (never a stale file which already existed)
+  if (!cacheKey.empty()) {
+    resultCache->put(cacheKey, resultWritten ? outputImageFile : std::string(), response);
+  }
+  return pointSet;
+}
+
+PointSet Client::segmentationProgressive(const Model &model, const std::string &inputImageFile, const std::string &outputImageFile,
+                                         const std::function<void(const PointSet &coarsePoints)> &onCoarse, int downsampleFactor) const {
+  if (model.name.empty()) {
+    AIAA_LOG_WARN("Selected model is EMPTY");
+    throw exception(exception::INVALID_ARGS_ERROR, "Model is EMPTY");
+  }
+
+  AIAA_LOG_DEBUG("Model: " << model.toJson());
+  AIAA_LOG_DEBUG("InputImageFile: " << inputImageFile);
+  AIAA_LOG_DEBUG("OutputImageFile: " << outputImageFile);
+  AIAA_LOG_DEBUG("DownsampleFactor: " << downsampleFactor);
+
+  std::string uri = serverUri + EP_SEGMENTATION + "?model=" + CurlUtils::encode(model.name);
+  std::string paramStr = "{}";
+  bool quantize = quantizationParams(model, uploadQuantization, uploadQuantizationRescale, inputImageFile, paramStr);
+  AiaaUtils::QuantizationType quantization = quantize ? uploadQuantization : AiaaUtils::QUANTIZE_NONE;
+
+  AutoRemoveFiles autoRemoveFiles;
+  std::string coarseInputFile = Utils::tempfilename() + IMAGE_FILE_EXTENSION;
+  std::string coarseOutputFile = Utils::tempfilename() + IMAGE_FILE_EXTENSION;
+  std::string fineInputFile = Utils::tempfilename() + IMAGE_FILE_EXTENSION;
+  std::string fineOutputFile = Utils::tempfilename() + IMAGE_FILE_EXTENSION;
+  autoRemoveFiles.add(coarseInputFile);
+  autoRemoveFiles.add(coarseOutputFile);
+  autoRemoveFiles.add(fineInputFile);
+  autoRemoveFiles.add(fineOutputFile);
+
+  // Coarse: downsampled image; result is upsampled (nearest neighbour) into outputImageFile
+  ImageInfo coarseInfo;
+  AiaaUtils::imageDownsample(inputImageFile, coarseInputFile, coarseInfo, downsampleFactor);
+
+  std::string uploadFile = uploadImageFile(coarseInputFile, model, quantization, 0, autoRemoveFiles);
+  std::string response = CurlUtils::doMethod("POST", uri, paramStr, uploadFile, coarseOutputFile, timeoutInSec);
+  AiaaUtils::imagePostProcess(coarseOutputFile, outputImageFile, coarseInfo);
+
+  if (onCoarse) {
+    // Coarse index to original index; coarse size is ceil(size / factor), same as AiaaUtils::imageDownsample
+    PointSet coarsePoints = PointSet::fromJson(response, "points");
+    for (auto &point : coarsePoints.points) {
+      for (size_t i = 0; i < point.size() && i < 3; i++) {
+        int roiSize = std::max((coarseInfo.imageSize[i] + downsampleFactor - 1) / downsampleFactor, 1);
+        int index = static_cast<int>(std::lround(point[i] * (coarseInfo.imageSize[i] / static_cast<double>(roiSize))));
+        point[i] = std::min(std::max(index, 0), coarseInfo.imageSize[i] - 1);
+      }
+    }
+    onCoarse(coarsePoints);
+  }
+
+  // Refine: full resolution image restricted to bounding box of coarse mask (margin covers one coarse voxel on each side)
+  ImageInfo fineInfo;
+  if (!AiaaUtils::imageBoundingBox(outputImageFile, fineInfo, 0, 2 * downsampleFactor)) {
+    AIAA_LOG_INFO("Coarse mask is empty; running full resolution segmentation instead of refine");
+    return segmentation(model, inputImageFile, outputImageFile);
+  }
+  AiaaUtils::imageCrop(inputImageFile, fineInputFile, fineInfo);
+
+  uploadFile = uploadImageFile(fineInputFile, model, quantization, 0, autoRemoveFiles);
+  response = CurlUtils::doMethod("POST", uri, paramStr, uploadFile, fineOutputFile, timeoutInSec);
+  AiaaUtils::imagePostProcess(fineOutputFile, outputImageFile, fineInfo);
+
+  PointSet pointSet = PointSet::fromJson(response, "points");
+  shiftPoints(pointSet, fineInfo);
+  return pointSet;
 }
 
 int Client::dextr3D(const Model &model, const PointSet &pointSet, const std::string &inputImageFile, const std::string &outputImageFile,
@@ -181,12 +459,80 @@ int Client::dextr3D(const Model &model, const PointSet &pointSet, const std::str
   }
   std::string paramStr = "{\"points\":" + pointSetROI.toJson() + "}";
 
-  CurlUtils::doMethod("POST", uri, paramStr, inputImage, croppedOutputFile, timeoutInSec);
-  if (preProcess) {
-    autoRemoveFiles.add(croppedOutputFile);
-    AiaaUtils::imagePostProcess(croppedInputFile, croppedOutputFile, imageInfo);
+  if (!preProcess) {
+    CurlUtils::doMethod("POST", uri, paramStr, inputImage, croppedOutputFile, timeoutInSec);
+    cleanupResult(outputImageFile);
+    return 0;
   }
 
+  // Result mask is decoded while it downloads; post-process then picks it up from decoded image cache
+  NiftiStreamDecoder decoder;
+  CurlUtils::doMethod("POST", uri, paramStr, inputImage, croppedOutputFile, timeoutInSec, [&decoder](const char *data, size_t size) {
+    decoder.write(data, size);
+  });
+  autoRemoveFiles.add(croppedOutputFile);
+
+  decoder.publish(croppedOutputFile);
+  AiaaUtils::imagePostProcess(croppedOutputFile, outputImageFile, imageInfo);
+  cleanupResult(outputImageFile);
+
+  return 0;
+}
+
+int Client::dextr3D(const std::vector<Model> &models, const std::vector<PointSet> &pointSets, const std::string &inputImageFile,
+                    const std::vector<std::string> &outputImageFiles) const {
+  if (models.size() != pointSets.size() || models.size() != outputImageFiles.size()) {
+    AIAA_LOG_ERROR("Mismatch in number of Models/PointSets/OutputImageFiles");
+    throw exception(exception::INVALID_ARGS_ERROR, "Mismatch in number of Models/PointSets/OutputImageFiles");
+  }
+
+  std::vector<double> padding;
+  std::vector<Point> roi;
+  for (size_t i = 0; i < models.size(); i++) {
+    if (models[i].name.empty()) {
+      AIAA_LOG_WARN("Selected model is EMPTY (organ: " << i << ")");
+      return -1;
+    }
+    if (pointSets[i].points.size() < MIN_POINTS_FOR_SEGMENTATION) {
+      AIAA_LOG_WARN("Minimum Points required for input PointSet: " << MIN_POINTS_FOR_SEGMENTATION << " (organ: " << i << ")");
+      return -2;
+    }
+    padding.push_back(models[i].padding);
+    roi.push_back(models[i].roi);
+  }
+
+  AIAA_LOG_DEBUG("Total Organs: " << models.size());
+  AIAA_LOG_DEBUG("InputImageFile: " << inputImageFile);
+
+  // Pre process (input image is decoded only once for all organs)
+  AutoRemoveFiles autoRemoveFiles;
+  std::vector<std::string> croppedInputFiles;
+  std::vector<std::string> croppedOutputFiles;
+  for (size_t i = 0; i < models.size(); i++) {
+    croppedInputFiles.push_back(Utils::tempfilename() + IMAGE_FILE_EXTENSION);
+    croppedOutputFiles.push_back(Utils::tempfilename() + IMAGE_FILE_EXTENSION);
+    autoRemoveFiles.add(croppedInputFiles.back());
+    autoRemoveFiles.add(croppedOutputFiles.back());
+  }
+
+  std::vector<ImageInfo> imageInfos;
+  std::vector<PointSet> pointSetROIs = AiaaUtils::imagePreProcess(pointSets, inputImageFile, croppedInputFiles, imageInfos, padding, roi);
+
+  // Requests to AIAA + post process run concurrently per organ
+  Utils::parallelFor(models.size(), [&](size_t i) {
+    std::string uri = serverUri + EP_DEXTRA_3D + "?model=" + CurlUtils::encode(models[i].name);
+    std::string paramStr = "{\"points\":" + pointSetROIs[i].toJson() + "}";
+
+    NiftiStreamDecoder decoder;
+    CurlUtils::doMethod("POST", uri, paramStr, croppedInputFiles[i], croppedOutputFiles[i], timeoutInSec, [&decoder](const char *data, size_t size) {
+      decoder.write(data, size);
+    });
+
+    decoder.publish(croppedOutputFiles[i]);
+    AiaaUtils::imagePostProcess(croppedOutputFiles[i], outputImageFiles[i], imageInfos[i]);
+    cleanupResult(outputImageFiles[i]);
+  });
+
   return 0;
 }
 
@@ -247,68 +593,378 @@ std::string Client::inference(const Model &model, const std::string &params, con
   }
 
   std::string paramsStr = params.empty() ? "{}" : params;
-  return CurlUtils::doMethod("POST", uri, paramsStr, inputImage, outputImageFile, timeoutInSec);
+  bool quantize = quantizationParams(model, uploadQuantization, uploadQuantizationRescale, inputImage, paramsStr);
+
+  std::string cacheKey;
+  std::string response;
+  if (resultCache && !inputImage.empty()) {
+    cacheKey = ResultCache::key(serverUri, "inference", model, paramsStr, inputImage);
+    if (resultCache->get(cacheKey, outputImageFile, response)) {
+      AIAA_LOG_INFO("Using cached result for: " << inputImage);
+      return response;
+    }
+  }
+
+  AutoRemoveFiles autoRemoveFiles;
+  std::string uploadFile = uploadImageFile(inputImage, model, quantize ? uploadQuantization : AiaaUtils::QUANTIZE_NONE, uploadStreamDivisions,
+                                           autoRemoveFiles);
+
+  bool resultWritten = false;
+  response = CurlUtils::doMethod("POST", uri, paramsStr, uploadFile, outputImageFile, timeoutInSec, nullptr, "", nullptr, &resultWritten);
+  if (!cacheKey.empty()) {
+    resultCache->put(cacheKey, resultWritten ? outputImageFile : std::string(), response);
+  }
+  return response;
+}
+
+std::vector<std::string> Client::inferenceTiled(const Model &model, const std::string &params, const std::string &inputImageFile,
+                                                const std::string &outputImageFile, const TileOptions &options) const {
+  AIAA_LOG_DEBUG("Model: " << model.toJson());
+  AIAA_LOG_DEBUG("Params: " << params);
+  AIAA_LOG_DEBUG("InputImageFile: " << inputImageFile);
+  AIAA_LOG_DEBUG("OutputImageFile: " << outputImageFile);
+  AIAA_LOG_DEBUG("Overlap: " << options.overlap << "; Stitching: " << options.stitching << "; Concurrency: " << options.concurrency);
+
+  std::vector<ImageInfo> tiles = AiaaUtils::imageTiles(inputImageFile, options.tileSize, options.overlap);
+
+  AutoRemoveFiles autoRemoveFiles;
+  std::vector<std::string> tileInputs, tileOutputs;
+  for (size_t i = 0; i < tiles.size(); i++) {
+    tileInputs.push_back(Utils::tempfilename() + IMAGE_FILE_EXTENSION);
+    tileOutputs.push_back(Utils::tempfilename() + IMAGE_FILE_EXTENSION);
+    autoRemoveFiles.add(tileInputs.back());
+    autoRemoveFiles.add(tileOutputs.back());
+  }
+  AiaaUtils::imageCrop(inputImageFile, tileInputs, tiles);
+
+  // One client per server (same settings except result cache; tiles are temporary files); tiles are dispatched round robin
+  std::vector<Client> clients;
+  for (auto &uri : options.serverUris) {
+    clients.push_back(Client(uri, timeoutInSec));
+  }
+  if (clients.empty()) {
+    clients.push_back(Client(serverUri, timeoutInSec));
+  }
+  for (auto &client : clients) {
+    client.uploadQuantization = uploadQuantization;
+    client.uploadQuantizationRescale = uploadQuantizationRescale;
+  }
+
+  std::vector<std::string> responses(tiles.size());
+  Utils::parallelFor(tiles.size(), [&](size_t i) {
+    responses[i] = clients[i % clients.size()].inference(model, params, tileInputs[i], tileOutputs[i]);
+  }, options.concurrency);
+
+  AiaaUtils::imageTileStitch(tileOutputs, tiles, outputImageFile, options.stitching);
+  return responses;
 }
 
-PolygonsList Client::maskToPolygon(int pointRatio, const std::string &inputImageFile) const {
+PolygonsList Client::maskToPolygon(int pointRatio, const std::string &inputImageFile, bool local) const {
+  PolygonsList result;
+  if (local) {
+    result = AiaaUtils::imageMaskToPolygon(inputImageFile, pointRatio);
+  } else {
+    std::string uri = serverUri + EP_MASK_TO_POLYGON;
+    std::string paramStr = "{\"more_points\":" + Utils::lexical_cast<std::string>(pointRatio) + "}";
+
+    AIAA_LOG_DEBUG("Parameters: " << paramStr);
+    AIAA_LOG_DEBUG("InputImageFile: " << inputImageFile);
+
+    std::string contentType;
+    std::string response = CurlUtils::doMethod("POST", uri, paramStr, inputImageFile, timeoutInSec, polygonAccept(binaryPolygons), &contentType);
+    result = polygonResponse<PolygonsList>(response, contentType, "");
+  }
+
+  if (simplifyTolerance > 0) {
+    result.simplify(simplifyTolerance, simplifyMethod);
+  }
+  return result;
+}
+
+FlatPolygonsList Client::maskToFlatPolygons(int pointRatio, const std::string &inputImageFile, bool local) const {
+  if (local) {
+    return AiaaUtils::imageMaskToFlatPolygons(inputImageFile, pointRatio);
+  }
+
   std::string uri = serverUri + EP_MASK_TO_POLYGON;
   std::string paramStr = "{\"more_points\":" + Utils::lexical_cast<std::string>(pointRatio) + "}";
 
   AIAA_LOG_DEBUG("Parameters: " << paramStr);
   AIAA_LOG_DEBUG("InputImageFile: " << inputImageFile);
 
-  std::string response = CurlUtils::doMethod("POST", uri, paramStr, inputImageFile, timeoutInSec);
-  AIAA_LOG_DEBUG("Response: \n" << response);
+  std::string contentType;
+  std::string response = CurlUtils::doMethod("POST", uri, paramStr, inputImageFile, timeoutInSec, polygonAccept(binaryPolygons), &contentType);
+  return polygonResponse<FlatPolygonsList>(response, contentType, "");
+}
+
+// Single edit as legacy fields (polygon_index, vertex_index, vertex_offset) or many edits as "vertex_edits"; slice index of each
+// edit is relative to firstSlice (3D only)
+void writeVertexEdits(JsonWriter &writer, const std::vector<VertexEdit> &edits, bool is3D, int firstSlice) {
+  if (edits.size() == 1) {
+    const VertexEdit &e = edits[0];
+    if (is3D) {
+      writer.key("slice_index").value(e.sliceIndex - firstSlice);
+    }
+    writer.key("polygon_index").value(e.polyIndex);
+    writer.key("vertex_index").value(e.vertexIndex);
+    writer.key("vertex_offset").beginArray().value(e.vertexOffset[0]).value(e.vertexOffset[1]).endArray();
+    return;
+  }
 
-  PolygonsList polygonsList = PolygonsList::fromJson(response);
-  return polygonsList;
+  writer.key("vertex_edits").beginArray();
+  for (auto &e : edits) {
+    writer.beginObject();
+    if (is3D) {
+      writer.key("slice_index").value(e.sliceIndex - firstSlice);
+    }
+    writer.key("polygon_index").value(e.polyIndex);
+    writer.key("vertex_index").value(e.vertexIndex);
+    writer.key("vertex_offset").beginArray().value(e.vertexOffset[0]).value(e.vertexOffset[1]).endArray();
+    writer.endObject();
+  }
+  writer.endArray();
+}
+
+void checkVertexEdits(const std::vector<VertexEdit> &edits) {
+  if (edits.empty()) {
+    AIAA_LOG_ERROR("No Vertex Edits");
+    throw exception(exception::INVALID_ARGS_ERROR, "No Vertex Edits");
+  }
 }
 
 Polygons Client::fixPolygon(const Polygons &poly, int neighborhoodSize, int polyIndex, int vertexIndex, const int vertexOffset[2],
                             const std::string &inputImageFile, const std::string &outputImageFile) const {
+  VertexEdit edit;
+  edit.polyIndex = polyIndex;
+  edit.vertexIndex = vertexIndex;
+  edit.vertexOffset[0] = vertexOffset[0];
+  edit.vertexOffset[1] = vertexOffset[1];
+  return fixPolygon(poly, neighborhoodSize, std::vector<VertexEdit> { edit }, inputImageFile, outputImageFile);
+}
+
+Polygons Client::fixPolygon(const Polygons &poly, int neighborhoodSize, const std::vector<VertexEdit> &edits, const std::string &inputImageFile,
+                            const std::string &outputImageFile) const {
+  checkVertexEdits(edits);
+  if (edits.size() > 1 && !batchedVertexEdits) {
+    Polygons result = poly;
+    VertexEdit::applySequential(result, edits, [&](Polygons &p, const VertexEdit &e) {
+      p = fixPolygon(p, neighborhoodSize, std::vector<VertexEdit> { e }, inputImageFile, outputImageFile);
+    });
+    return result;
+  }
+
   std::string uri = serverUri + EP_FIX_POLYGON;
 
-  std::string paramStr = "{\"propagate_neighbor\":" + Utils::lexical_cast<std::string>(neighborhoodSize) + ",";
-  paramStr = paramStr + "\"dimension\":2,";
-  paramStr = paramStr + "\"polygon_index\":" + Utils::lexical_cast<std::string>(polyIndex) + ",";
-  paramStr = paramStr + "\"vertex_index\":" + Utils::lexical_cast<std::string>(vertexIndex) + ",";
-  paramStr = paramStr + "\"vertex_offset\":[" + Utils::lexical_cast<std::string>(vertexOffset[0]) + ","
-      + Utils::lexical_cast<std::string>(vertexOffset[1]) + "],";
-  paramStr = paramStr + "\"poly\":" + poly.toJson() + "}";
+  JsonWriter writer(JsonWriter::estimate(poly.polys) + 128 + edits.size() * 64);
+  writer.beginObject();
+  writer.key("propagate_neighbor").value(neighborhoodSize);
+  writer.key("dimension").value(2);
+  writeVertexEdits(writer, edits, false, 0);
+  writer.key("poly").value(poly.polys);
+  writer.endObject();
+  std::string paramStr = writer.release();
 
   AIAA_LOG_DEBUG("Parameters: " << paramStr);
   AIAA_LOG_DEBUG("InputImageFile: " << inputImageFile);
   AIAA_LOG_DEBUG("OutputImageFile: " << outputImageFile);
 
-  std::string response = CurlUtils::doMethod("POST", uri, paramStr, inputImageFile, outputImageFile, timeoutInSec);
-  AIAA_LOG_DEBUG("Response: \n" << response);
+  std::string contentType;
+  std::string response = CurlUtils::doMethod("POST", uri, paramStr, inputImageFile, outputImageFile, timeoutInSec, nullptr,
+                                             polygonAccept(binaryPolygons), &contentType);
+  return polygonResponse<Polygons>(response, contentType, "poly");
+}
+
+// fixPolygon (3D) params for slices [first, first + count) of poly; slice index of edits is made relative to first
+std::string fixPolygon3DParams(const PolygonsList &poly, size_t first, size_t count, int neighborhoodSize, int neighborhoodSize3D,
+                               const std::vector<VertexEdit> &edits) {
+  // Whole payload (all slices) is written in one pass into a single pre-sized string
+  size_t size = 128 + edits.size() * 64;
+  for (size_t i = first; i < first + count; i++) {
+    size += JsonWriter::estimate(poly.list[i].polys) + 1;
+  }
 
-  return Polygons::fromJson(response, "poly");
+  JsonWriter writer(size);
+  writer.beginObject();
+  writer.key("propagate_neighbor").value(neighborhoodSize);
+  writer.key("propagate_neighbor_3d").value(neighborhoodSize3D);
+  writer.key("dimension").value(3);
+  writeVertexEdits(writer, edits, true, static_cast<int>(first));
+  if (first > 0 || count < poly.list.size()) {
+    writer.key("slice_offset").value(static_cast<int>(first));
+  }
+  writer.key("poly").beginArray();
+  for (size_t i = first; i < first + count; i++) {
+    writer.value(poly.list[i].polys);
+  }
+  writer.endArray();
+  writer.endObject();
+  return writer.release();
+}
+
+// Single edit of 3D fixPolygon APIs
+std::vector<VertexEdit> vertexEdit3D(int sliceIndex, int polyIndex, int vertexIndex, const int vertexOffset[2]) {
+  VertexEdit edit;
+  edit.sliceIndex = sliceIndex;
+  edit.polyIndex = polyIndex;
+  edit.vertexIndex = vertexIndex;
+  edit.vertexOffset[0] = vertexOffset[0];
+  edit.vertexOffset[1] = vertexOffset[1];
+  return { edit };
 }
 
 PolygonsList Client::fixPolygon(const PolygonsList &poly, int neighborhoodSize, int neighborhoodSize3D, int sliceIndex, int polyIndex,
                                 int vertexIndex, const int vertexOffset[2], const std::string &inputImageFile,
                                 const std::string &outputImageFile) const {
-  std::string uri = serverUri + EP_FIX_POLYGON;
+  return fixPolygon(poly, neighborhoodSize, neighborhoodSize3D, vertexEdit3D(sliceIndex, polyIndex, vertexIndex, vertexOffset), inputImageFile,
+                    outputImageFile);
+}
 
-  std::string paramStr = "{\"propagate_neighbor\":" + Utils::lexical_cast<std::string>(neighborhoodSize) + ",";
-  paramStr = paramStr + "\"propagate_neighbor_3d\":" + Utils::lexical_cast<std::string>(neighborhoodSize3D) + ",";
-  paramStr = paramStr + "\"dimension\":3,";
-  paramStr = paramStr + "\"slice_index\":" + Utils::lexical_cast<std::string>(sliceIndex) + ",";
-  paramStr = paramStr + "\"polygon_index\":" + Utils::lexical_cast<std::string>(polyIndex) + ",";
-  paramStr = paramStr + "\"vertex_index\":" + Utils::lexical_cast<std::string>(vertexIndex) + ",";
-  paramStr = paramStr + "\"vertex_offset\":[" + Utils::lexical_cast<std::string>(vertexOffset[0]) + ","
-      + Utils::lexical_cast<std::string>(vertexOffset[1]) + "],";
-  paramStr = paramStr + "\"poly\":" + poly.toJson() + "}";
+PolygonsList Client::fixPolygon(const PolygonsList &poly, int neighborhoodSize, int neighborhoodSize3D, const std::vector<VertexEdit> &edits,
+                                const std::string &inputImageFile, const std::string &outputImageFile) const {
+  checkVertexEdits(edits);
+  if (edits.size() > 1 && !batchedVertexEdits) {
+    PolygonsList result = poly;
+    VertexEdit::applySequential(result, edits, [&](PolygonsList &p, const VertexEdit &e) {
+      p = fixPolygon(p, neighborhoodSize, neighborhoodSize3D, std::vector<VertexEdit> { e }, inputImageFile, outputImageFile);
+    });
+    return result;
+  }
+
+  std::string uri = serverUri + EP_FIX_POLYGON;
+  std::string paramStr = fixPolygon3DParams(poly, 0, poly.list.size(), neighborhoodSize, neighborhoodSize3D, edits);
 
   AIAA_LOG_DEBUG("Parameters: " << paramStr);
   AIAA_LOG_DEBUG("InputImageFile: " << inputImageFile);
   AIAA_LOG_DEBUG("OutputImageFile: " << outputImageFile);
 
-  std::string response = CurlUtils::doMethod("POST", uri, paramStr, inputImageFile, outputImageFile, timeoutInSec);
-  AIAA_LOG_DEBUG("Response: \n" << response);
+  std::string contentType;
+  std::string response = CurlUtils::doMethod("POST", uri, paramStr, inputImageFile, outputImageFile, timeoutInSec, nullptr,
+                                             polygonAccept(binaryPolygons), &contentType);
+  return polygonResponse<PolygonsList>(response, contentType, "poly");
+}
+
+void Client::fixPolygonIncremental(PolygonsList &poly, int neighborhoodSize, int neighborhoodSize3D, int sliceIndex, int polyIndex,
+                                   int vertexIndex, const int vertexOffset[2], const std::string &inputImageFile,
+                                   const std::string &outputImageFile) const {
+  fixPolygonIncremental(poly, neighborhoodSize, neighborhoodSize3D, vertexEdit3D(sliceIndex, polyIndex, vertexIndex, vertexOffset), inputImageFile,
+                        outputImageFile);
+}
+
+void Client::fixPolygonIncremental(PolygonsList &poly, int neighborhoodSize, int neighborhoodSize3D, const std::vector<VertexEdit> &edits,
+                                   const std::string &inputImageFile, const std::string &outputImageFile) const {
+  checkVertexEdits(edits);
+  if (edits.size() > 1 && !batchedVertexEdits) {
+    VertexEdit::applySequential(poly, edits, [&](PolygonsList &p, const VertexEdit &e) {
+      fixPolygonIncremental(p, neighborhoodSize, neighborhoodSize3D, std::vector<VertexEdit> { e }, inputImageFile, outputImageFile);
+    });
+    return;
+  }
+
+  int minSlice = edits[0].sliceIndex, maxSlice = edits[0].sliceIndex;
+  for (auto &e : edits) {
+    if (e.sliceIndex < 0 || static_cast<size_t>(e.sliceIndex) >= poly.list.size()) {
+      AIAA_LOG_ERROR("Invalid Slice Index: " << e.sliceIndex << "; Total Slices: " << poly.list.size());
+      throw exception(exception::INVALID_ARGS_ERROR, "Invalid Slice Index");
+    }
+    minSlice = std::min(minSlice, e.sliceIndex);
+    maxSlice = std::max(maxSlice, e.sliceIndex);
+  }
 
-  return PolygonsList::fromJson(response, "poly");
+  // Only slices within neighborhoodSize3D of edited slices can change; window of polygons and image is sent with slice index relative to it
+  const int first = std::max(minSlice - std::max(neighborhoodSize3D, 0), 0);
+  const int last = std::min(maxSlice + std::max(neighborhoodSize3D, 0), static_cast<int>(poly.list.size()) - 1);
+  const size_t count = last - first + 1;
+  AIAA_LOG_DEBUG("Slice Window: [" << first << ", " << last << "]");
+
+  AutoRemoveFiles autoRemoveFiles;
+  std::string windowImageFile = Utils::tempfilename() + IMAGE_FILE_EXTENSION;
+  std::string windowOutputFile = outputImageFile.empty() ? std::string() : Utils::tempfilename() + IMAGE_FILE_EXTENSION;
+  autoRemoveFiles.add(windowImageFile);
+  if (!windowOutputFile.empty()) {
+    autoRemoveFiles.add(windowOutputFile);
+  }
+
+  ImageInfo windowInfo;
+  AiaaUtils::imageSliceWindow(inputImageFile, windowImageFile, first, static_cast<int>(count), windowInfo);
+
+  std::string uri = serverUri + EP_FIX_POLYGON;
+  std::string paramStr = fixPolygon3DParams(poly, first, count, neighborhoodSize, neighborhoodSize3D, edits);
+
+  AIAA_LOG_DEBUG("Parameters: " << paramStr);
+  AIAA_LOG_DEBUG("InputImageFile: " << inputImageFile << " => " << windowImageFile);
+  AIAA_LOG_DEBUG("OutputImageFile: " << outputImageFile);
+
+  std::string contentType;
+  std::string response = CurlUtils::doMethod("POST", uri, paramStr, windowImageFile, windowOutputFile, timeoutInSec, nullptr,
+                                             polygonAccept(binaryPolygons), &contentType);
+  PolygonsList window = polygonResponse<PolygonsList>(response, contentType, "poly");
+  if (window.list.size() != count) {
+    AIAA_LOG_ERROR("Expected " << count << " slices in response; but received " << window.list.size());
+    throw exception(exception::RESPONSE_PARSE_ERROR, "Mismatch in number of slices of fixPolygon response");
+  }
+
+  // Result mask of the window is pasted (at slice_offset) into a full size mask; slices outside the window are empty
+  if (!windowOutputFile.empty()) {
+    AiaaUtils::imagePostProcess(windowOutputFile, outputImageFile, windowInfo);
+  }
+
+  // Merge updated slices back in place
+  for (size_t i = 0; i < count; i++) {
+    poly.list[first + i] = std::move(window.list[i]);
+  }
+}
+
+std::vector<BatchResult> Client::batch(const std::vector<BatchJob> &jobs, int concurrency,
+                                       const std::function<void(size_t, const BatchResult &)> &onComplete,
+                                       const std::vector<std::string> &serverUris) const {
+  AIAA_LOG_DEBUG("Total Jobs: " << jobs.size() << "; Concurrency: " << concurrency << "; Servers: " << serverUris.size());
+
+  // One client per server (same settings and result cache); jobs are dispatched round robin, concurrency applies per server
+  std::vector<Client> clients;
+  for (auto &uri : serverUris) {
+    Client client(*this);
+    client.serverUri = Client(uri, timeoutInSec).serverUri;
+    clients.push_back(client);
+  }
+  if (clients.empty()) {
+    clients.push_back(*this);
+  }
+
+  std::vector<BatchResult> results(jobs.size());
+  std::mutex callbackMutex;
+
+  Utils::parallelFor(jobs.size(), [&](size_t i) {
+    const BatchJob &job = jobs[i];
+    const Client &client = clients[i % clients.size()];
+    BatchResult &result = results[i];
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    try {
+      if (job.type == BatchJob::SEGMENTATION) {
+        result.points = client.segmentation(job.model, job.inputImageFile, job.outputImageFile);
+      } else {
+        result.response = client.inference(job.model, job.params, job.inputImageFile, job.outputImageFile);
+      }
+      result.success = true;
+    } catch (exception &e) {
+      AIAA_LOG_WARN("Job " << i << " (" << job.inputImageFile << ") failed: " << e.what());
+      result.errorId = e.id;
+      result.errorMessage = e.what();
+    } catch (std::exception &e) {
+      AIAA_LOG_WARN("Job " << i << " (" << job.inputImageFile << ") failed: " << e.what());
+      result.errorId = exception::SYSTEM_ERROR;
+      result.errorMessage = e.what();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    result.latencyInMs = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
+
+    if (onComplete) {
+      std::lock_guard<std::mutex> lock(callbackMutex);
+      onComplete(i, result);
+    }
+  }, concurrency > 0 ? concurrency * static_cast<int>(clients.size()) : 0);
+
+  return results;
 }
 
 std::string Client::createSession(const std::string &inputImageFile, const int expiry) const {
@@ -318,7 +974,10 @@ std::string Client::createSession(const std::string &inputImageFile, const int e
   std::string uri = serverUri + EP_SESSION;
   std::string paramStr = "{}";
 
-  std::string response = CurlUtils::doMethod("PUT", uri, paramStr, inputImageFile, timeoutInSec);
+  AutoRemoveFiles autoRemoveFiles;
+  std::string uploadFile = uploadImageFile(inputImageFile, Model(), AiaaUtils::QUANTIZE_NONE, uploadStreamDivisions, autoRemoveFiles);
+
+  std::string response = CurlUtils::doMethod("PUT", uri, paramStr, uploadFile, timeoutInSec);
   AIAA_LOG_DEBUG("Response: \n" << response);
 
   std::string sessionID;
@@ -32,6 +32,7 @@
 
 #include <sstream>
 #include <fstream>
+#include <vector>
 
 #include <Poco/Net/HTTPClientSession.h>
 #include <Poco/Net/HTTPRequest.h>
@@ -52,6 +53,7 @@ namespace aiaa {
 const int CURL_CONNECT_TIMEOUT_IN_SEC = 5;
 const std::string MULTI_PART_FIELD_PARAMS = "params";
 const std::string MULTI_PART_FIELD_IMAGE = "image";
+const size_t CURL_READ_BUFFER_SIZE = 64 * 1024;
 
 std::string CurlUtils::doMethod(const std::string &method, const std::string &uri, int timeoutInSec) {
   AIAA_LOG_DEBUG(method << ": " << uri << "; Timeout: " << timeoutInSec);
@@ -96,7 +98,7 @@ std::string CurlUtils::doMethod(const std::string &method, const std::string &ur
 }
 
 std::string CurlUtils::doMethod(const std::string &method, const std::string &uri, const std::string &paramStr, const std::string &uploadFilePath,
-                                int timeoutInSec) {
+                                int timeoutInSec, const std::string &accept, std::string *contentType) {
   AIAA_LOG_DEBUG(method << ": " << uri << "; Timeout: " << timeoutInSec);
   AIAA_LOG_DEBUG("ParamStr: " << paramStr);
   AIAA_LOG_DEBUG("UploadFilePath: " << uploadFilePath);
@@ -116,6 +118,9 @@ std::string CurlUtils::doMethod(const std::string &method, const std::string &ur
     // send request
     AIAA_LOG_DEBUG("Request Path: " << path);
     Poco::Net::HTTPRequest req(method, path, Poco::Net::HTTPMessage::HTTP_1_0);
+    if (!accept.empty()) {
+      req.set("Accept", accept);
+    }
 
     Poco::Net::HTMLForm form;
     form.setEncoding(Poco::Net::HTMLForm::ENCODING_MULTIPART);
@@ -139,6 +144,10 @@ std::string CurlUtils::doMethod(const std::string &method, const std::string &ur
       throw exception(exception::AIAA_SERVER_ERROR, res.getReason().c_str());
     }
 
+    if (contentType) {
+      *contentType = res.getContentType();
+    }
+
     Poco::StreamCopier::copyStream(is, response);
     AIAA_LOG_DEBUG("Received response from server: \n" << response.str());
   } catch (Poco::Exception &e) {
@@ -150,12 +159,16 @@ std::string CurlUtils::doMethod(const std::string &method, const std::string &ur
 }
 
 std::string CurlUtils::doMethod(const std::string &method, const std::string &uri, const std::string &paramStr, const std::string &uploadFilePath,
-                                const std::string &resultFileName, int timeoutInSec) {
+                                const std::string &resultFileName, int timeoutInSec, const std::function<void(const char*, size_t)> &onData,
+                                const std::string &accept, std::string *contentType, bool *resultWritten) {
   AIAA_LOG_DEBUG(method << ": " << uri << "; Timeout: " << timeoutInSec);
   AIAA_LOG_DEBUG("ParamStr: " << paramStr);
   AIAA_LOG_DEBUG("UploadFilePath: " << uploadFilePath);
   AIAA_LOG_DEBUG("ResultFileName: " << resultFileName);
   std::string textReponse;
+  if (resultWritten) {
+    *resultWritten = false;
+  }
 
   try {
     Poco::URI u(uri);
@@ -171,6 +184,9 @@ std::string CurlUtils::doMethod(const std::string &method, const std::string &ur
     // send request
     AIAA_LOG_DEBUG("Request Path: " << path);
     Poco::Net::HTTPRequest req(method, path, Poco::Net::HTTPMessage::HTTP_1_0);
+    if (!accept.empty()) {
+      req.set("Accept", accept);
+    }
 
     Poco::Net::HTMLForm form;
     form.setEncoding(Poco::Net::HTMLForm::ENCODING_MULTIPART);
@@ -187,28 +203,32 @@ std::string CurlUtils::doMethod(const std::string &method, const std::string &ur
     std::istream &is = session.receiveResponse(res);
     AIAA_LOG_DEBUG("Status: " << res.getStatus() << "; Reason: " << res.getReason() << "; Content-type: " << res.getContentType());
 
-    std::stringstream response;
-    Poco::StreamCopier::copyStream(is, response);
+    if (res.getStatus() != 200 || res.getContentType().find("multipart") == std::string::npos) {
+      std::stringstream response;
+      Poco::StreamCopier::copyStream(is, response);
 
-    if (res.getStatus() == 440) {
-      throw exception(exception::AIAA_SESSION_TIMEOUT, response.str().c_str());
-    }
-    if (res.getStatus() != 200) {
-      AIAA_LOG_INFO("Response: " << response.str());
-      throw exception(exception::AIAA_RESPONSE_ERROR, (res.getReason() + " => " + response.str()).c_str());
-    }
+      if (res.getStatus() == 440) {
+        throw exception(exception::AIAA_SESSION_TIMEOUT, response.str().c_str());
+      }
+      if (res.getStatus() != 200) {
+        AIAA_LOG_INFO("Response: " << response.str());
+        throw exception(exception::AIAA_RESPONSE_ERROR, (res.getReason() + " => " + response.str()).c_str());
+      }
 
-    if (res.getContentType().find("multipart") == std::string::npos) {
       if (!resultFileName.empty()) {
         AIAA_LOG_INFO("Expected Multipart Response but received: " << res.getContentType());
       }
       AIAA_LOG_DEBUG("Received response from server: \n" << response.str());
 
+      if (contentType) {
+        *contentType = res.getContentType();
+      }
       textReponse = response.str();
       return textReponse;
     }
 
-    Poco::Net::MultipartReader r(response);
+    // Parts are read directly from the connection; binary part is written (and passed to onData) while it downloads
+    Poco::Net::MultipartReader r(is);
     int i = 0;
     while (r.hasNextPart()) {
       Poco::Net::MessageHeader h;
@@ -225,21 +245,44 @@ std::string CurlUtils::doMethod(const std::string &method, const std::string &ur
       AIAA_LOG_DEBUG("PART-" << i << ":: Is Type Text: " << (isText ? "TRUE" : "FALSE"));
 
       std::istream &ii = r.stream();
-      std::stringstream part;
-      Poco::StreamCopier::copyStream(ii, part);
-
       if (isText) {
+        std::stringstream part;
+        Poco::StreamCopier::copyStream(ii, part);
+
         AIAA_LOG_DEBUG("PART-" << i << ":: Data: " << part.str());
         textReponse = part.str();
+        if (contentType) {
+          *contentType = h.get("Content-Type", "");
+        }
       } else {
-        AIAA_LOG_DEBUG("PART-" << i << ":: DataSize: " << part.str().size());
-
+        // Result image is drained (not written) if caller does not need it
         std::ofstream file;
-        file.open(resultFileName, std::ios::out | std::ios::binary | std::ios_base::trunc);
+        if (!resultFileName.empty()) {
+          file.open(resultFileName, std::ios::out | std::ios::binary | std::ios_base::trunc);
+        }
 
-        std::string data = part.str();
-        file.write(data.c_str(), data.size());
+        std::vector<char> buffer(CURL_READ_BUFFER_SIZE);
+        size_t total = 0;
+        while (ii) {
+          ii.read(buffer.data(), buffer.size());
+          std::streamsize n = ii.gcount();
+          if (n <= 0) {
+            break;
+          }
+
+          if (file.is_open()) {
+            file.write(buffer.data(), n);
+          }
+          if (onData) {
+            onData(buffer.data(), static_cast<size_t>(n));
+          }
+          total += n;
+        }
         file.flush();
+        if (resultWritten && file.is_open()) {
+          *resultWritten = file.good();
+        }
+        AIAA_LOG_DEBUG("PART-" << i << ":: DataSize: " << total);
       }
       i++;
     }
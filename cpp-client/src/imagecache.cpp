@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/nvidia/aiaa/imagecache.h"
+#include "../include/nvidia/aiaa/log.h"
+
+namespace nvidia {
+namespace aiaa {
+
+ImageCache& ImageCache::instance() {
+  static ImageCache cache;
+  return cache;
+}
+
+void ImageCache::evict() {
+  while (totalSize > maxSize && !entries.empty()) {
+    AIAA_LOG_DEBUG("Evict decoded image: " << entries.back().key);
+    totalSize -= entries.back().size;
+    entries.pop_back();
+  }
+}
+
+void ImageCache::setMaxSize(size_t size) {
+  std::lock_guard<std::mutex> guard(lock);
+  maxSize = size;
+  evict();
+}
+
+size_t ImageCache::getMaxSize() {
+  std::lock_guard<std::mutex> guard(lock);
+  return maxSize;
+}
+
+itk::DataObject::Pointer ImageCache::get(const std::string &key) {
+  std::lock_guard<std::mutex> guard(lock);
+  for (auto it = entries.begin(); it != entries.end(); it++) {
+    if (it->key == key) {
+      entries.splice(entries.begin(), entries, it);
+      return it->image;
+    }
+  }
+  return nullptr;
+}
+
+void ImageCache::put(const std::string &key, itk::DataObject::Pointer image, size_t size) {
+  std::lock_guard<std::mutex> guard(lock);
+  if (size > maxSize) {
+    return;
+  }
+
+  for (auto it = entries.begin(); it != entries.end(); it++) {
+    if (it->key == key) {
+      totalSize -= it->size;
+      entries.erase(it);
+      break;
+    }
+  }
+
+  entries.push_front(Entry { key, image, size });
+  totalSize += size;
+  evict();
+}
+
+void ImageCache::erase(const std::string &fileName) {
+  const std::string prefix = fileName + '|';
+  std::lock_guard<std::mutex> guard(lock);
+  for (auto it = entries.begin(); it != entries.end();) {
+    if (it->key.compare(0, prefix.size(), prefix) == 0) {
+      totalSize -= it->size;
+      it = entries.erase(it);
+    } else {
+      it++;
+    }
+  }
+}
+
+}
+}
@@ -30,6 +30,7 @@
 #include "../include/nvidia/aiaa/log.h"
 #include "../include/nvidia/aiaa/utils.h"
 #include "../include/nvidia/aiaa/exception.h"
+#include "../include/nvidia/aiaa/jsonsax.h"
 
 #include <nlohmann/json.hpp>
 
@@ -48,26 +49,85 @@ Model::Model() {
 
 // {"labels": ["brain_tumor_core"], "internal name": "Dextr3dCroppedEngine", "description": "", "name": "Dextr3DBrainTC", "padding": 20.0 "roi": [128,128,128], "sigma": 3.0}
 
-Model Model::fromJson(const std::string &json) {
-  try {
-    nlohmann::json j = nlohmann::json::parse(json);
-
-    Model model;
-    model.name = j["name"].get<std::string>();
-    model.internal_name = j.find("internal name") != j.end() ? j["internal name"].get<std::string>() : std::string();
-    model.description = j.find("description") != j.end() ? j["description"].get<std::string>() : std::string();
+// Builds Models directly from SAX events; a single model object or an array of model objects.  Unknown keys are skipped
+class ModelSax : public JsonSax {
+ public:
+  std::vector<Model> models;
 
-    for (auto e : j["labels"]) {
-      model.labels.insert(e.get<std::string>());
+  bool null() {
+    return skip ? true : value();
+  }
+  bool boolean(bool) {
+    return skip ? true : value();
+  }
+  bool number_integer(number_integer_t v) {
+    return number(static_cast<double>(v));
+  }
+  bool number_unsigned(number_unsigned_t v) {
+    return number(static_cast<double>(v));
+  }
+  bool number_float(number_float_t v, const string_t&) {
+    return number(v);
+  }
+  bool string(string_t &s) {
+    if (skip) {
+      return true;
+    }
+    if (!inModel) {
+      return unexpected("string");
     }
 
-    model.padding = j.find("padding") != j.end() ? j["padding"].get<double>() : DEFAULT_PADDING;
-    model.roi.clear();
-    if (j.find("roi") != j.end()) {
-      for (auto n : j["roi"]) {
-        model.roi.push_back(n);
+    Model &model = models.back();
+    if (inArray) {
+      if (field == "labels") {
+        model.labels.insert(s);
       }
+    } else if (field == "labels") {
+      model.labels.insert(s);  // single label (not in array)
+    } else if (field == "name") {
+      model.name = s;
+      hasName = true;
+    } else if (field == "internal name") {
+      model.internal_name = s;
+    } else if (field == "description") {
+      model.description = s;
+    } else if (field == "type") {
+      model.type = Model::toModelType(s);
+    } else if (field == "version") {
+      model.version = s;
+    }
+    return true;
+  }
+  bool start_object(std::size_t) {
+    if (skip || inModel) {
+      skip++;
+      return true;
     }
+
+    models.emplace_back();
+    models.back().roi.clear();
+    inModel = true;
+    hasName = false;
+    return true;
+  }
+  bool key(string_t &k) {
+    if (!skip) {
+      field = k;
+    }
+    return true;
+  }
+  bool end_object() {
+    if (skip) {
+      skip--;
+      return true;
+    }
+
+    inModel = false;
+    if (!hasName) {
+      return unexpected("model (name is missing)");
+    }
+
+    Model &model = models.back();
     if (model.roi.empty()) {
       model.roi.push_back(DEFAULT_ROI);
     }
@@ -75,19 +135,79 @@ Model Model::fromJson(const std::string &json) {
     while (model.roi.size() < 4) {
       model.roi.push_back(model.roi[model.roi.size() - 1]);
     }
+    return true;
+  }
+  bool start_array(std::size_t) {
+    if (skip || inArray) {
+      skip++;
+      return true;
+    }
+    if (!inModel) {
+      if (inList) {
+        return unexpected("array");
+      }
+      inList = true;
+      return true;
+    }
+
+    inArray = true;
+    return true;
+  }
+  bool end_array() {
+    if (skip) {
+      skip--;
+    } else if (inArray) {
+      inArray = false;
+    } else {
+      inList = false;
+    }
+    return true;
+  }
 
-    std::string type = j.find("type") != j.end() ? j["type"].get<std::string>() : std::string();
-    model.type = Model::toModelType(type);
-    model.version = j.find("version") != j.end() ? j["version"].get<std::string>() : std::string();
+ private:
+  std::string field;
+  int skip = 0;
+  bool inList = false;
+  bool inModel = false;
+  bool inArray = false;
+  bool hasName = false;
 
-    return model;
-  } catch (nlohmann::json::parse_error &e) {
-    AIAA_LOG_ERROR(e.what());
-    throw exception(exception::RESPONSE_PARSE_ERROR, e.what());
-  } catch (nlohmann::json::type_error &e) {
-    AIAA_LOG_ERROR(e.what());
-    throw exception(exception::RESPONSE_PARSE_ERROR, e.what());
+  bool value() {
+    return inModel ? true : unexpected("value");
   }
+
+  bool number(double v) {
+    if (skip) {
+      return true;
+    }
+    if (!inModel) {
+      return unexpected("number");
+    }
+
+    Model &model = models.back();
+    if (inArray) {
+      if (field == "roi") {
+        model.roi.push_back(static_cast<int>(v));
+      } else if (field == "intensity_window") {
+        model.intensity_window.push_back(v);
+      }
+    } else if (field == "padding") {
+      model.padding = v;
+    } else if (field == "roi") {
+      model.roi.push_back(static_cast<int>(v));  // same roi for all dimensions
+    }
+    return true;
+  }
+};
+
+Model Model::fromJson(const std::string &json) {
+  ModelSax handler;
+  jsonSaxParse(json, handler);
+  if (handler.models.size() != 1) {
+    AIAA_LOG_ERROR("Expected one Model; JSON: " << json);
+    throw exception(exception::RESPONSE_PARSE_ERROR, "Expected one Model");
+  }
+  return handler.models[0];
 }
 
 std::string Model::toJson(int space) const {
@@ -102,6 +222,9 @@ std::string Model::toJson(int space) const {
     j["padding"] = padding;
     j["roi"] = roi;
   }
+  if (!intensity_window.empty()) {
+    j["intensity_window"] = intensity_window;
+  }
 
   std::string str = j.dump(space);
   if (!space) {
@@ -153,20 +276,12 @@ std::string Model::toString(Model::ModelType type) {
 // ]
 
 ModelList ModelList::fromJson(const std::string &json) {
-  try {
-    nlohmann::json j = nlohmann::json::parse(json);
-    ModelList modelList;
-    for (auto e : j) {
-      modelList.models.push_back(Model::fromJson(e.dump()));
-    }
-    return modelList;
-  } catch (nlohmann::json::parse_error &e) {
-    AIAA_LOG_ERROR(e.what());
-    throw exception(exception::RESPONSE_PARSE_ERROR, e.what());
-  } catch (nlohmann::json::type_error &e) {
-    AIAA_LOG_ERROR(e.what());
-    throw exception(exception::RESPONSE_PARSE_ERROR, e.what());
-  }
+  ModelSax handler;
+  jsonSaxParse(json, handler);
+
+  ModelList modelList;
+  modelList.models = std::move(handler.models);
+  return modelList;
 }
 
 std::string ModelList::toJson(int space) const {
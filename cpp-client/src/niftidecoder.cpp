@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/nvidia/aiaa/niftidecoder.h"
+#include "../include/nvidia/aiaa/imagecache.h"
+#include "../include/nvidia/aiaa/log.h"
+
+#include <itkImage.h>
+#include <itkImageIOFactory.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace nvidia {
+namespace aiaa {
+
+const size_t NIFTI_HEADER_SIZE = 348;
+const size_t NIFTI_MIN_VOX_OFFSET = 352;
+const size_t NIFTI_INFLATE_CHUNK = 64 * 1024;
+
+template<class T>
+T niftiValue(const std::vector<char> &header, size_t offset, bool swap) {
+  T v;
+  char *b = reinterpret_cast<char*>(&v);
+  std::memcpy(b, header.data() + offset, sizeof(T));
+  if (swap) {
+    std::reverse(b, b + sizeof(T));
+  }
+  return v;
+}
+
+NiftiStreamDecoder::NiftiStreamDecoder() {
+  std::memset(&zs, 0, sizeof(zs));
+}
+
+NiftiStreamDecoder::~NiftiStreamDecoder() {
+  if (started && gzip) {
+    inflateEnd(&zs);
+  }
+}
+
+void NiftiStreamDecoder::write(const char *data, size_t size) {
+  if (failed || !size) {
+    return;
+  }
+
+  if (!started) {
+    started = true;
+    if (!ImageCache::instance().getMaxSize()) {
+      AIAA_LOG_DEBUG("NIfTI Stream: decoded image cache is disabled; skip decoding");
+      failed = true;
+      return;
+    }
+    gzip = static_cast<unsigned char>(data[0]) == 0x1f;
+    if (gzip && inflateInit2(&zs, 15 + 32) != Z_OK) {
+      gzip = false;
+      failed = true;
+      return;
+    }
+  }
+
+  if (!gzip) {
+    consume(data, size);
+    return;
+  }
+
+  char out[NIFTI_INFLATE_CHUNK];
+  zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+  zs.avail_in = static_cast<uInt>(size);
+  while (zs.avail_in > 0 && !failed) {
+    zs.next_out = reinterpret_cast<Bytef*>(out);
+    zs.avail_out = sizeof(out);
+
+    int ret = inflate(&zs, Z_NO_FLUSH);
+    size_t produced = sizeof(out) - zs.avail_out;
+    consume(out, produced);
+
+    if (ret == Z_STREAM_END) {
+      inflateReset(&zs);  // next gzip member (if any)
+    } else if (ret != Z_OK) {
+      AIAA_LOG_DEBUG("NIfTI Stream inflate failed: " << ret);
+      failed = true;
+    }
+  }
+}
+
+void NiftiStreamDecoder::consume(const char *data, size_t size) {
+  while (size > 0 && !failed) {
+    size_t n;
+    if (header.size() < NIFTI_HEADER_SIZE) {
+      n = std::min(NIFTI_HEADER_SIZE - header.size(), size);
+      header.insert(header.end(), data, data + n);
+      if (header.size() == NIFTI_HEADER_SIZE && !parseHeader()) {
+        failed = true;
+      }
+    } else if (position < voxOffset) {
+      n = std::min(voxOffset - position, size);
+    } else {
+      n = std::min(expected - voxels.size(), size);
+      voxels.insert(voxels.end(), data, data + n);
+      if (!n) {
+        return;  // extra trailing bytes
+      }
+    }
+
+    position += n;
+    data += n;
+    size -= n;
+  }
+}
+
+bool NiftiStreamDecoder::parseHeader() {
+  int sizeofHdr = niftiValue<int>(header, 0, false);
+  swap = sizeofHdr != static_cast<int>(NIFTI_HEADER_SIZE);
+  if (swap && niftiValue<int>(header, 0, true) != static_cast<int>(NIFTI_HEADER_SIZE)) {
+    return false;
+  }
+  if (std::memcmp(header.data() + 344, "n+1", 4) != 0) {
+    return false;  // only single file NIfTI-1
+  }
+
+  short ndim = niftiValue<short>(header, 40, swap);
+  if (ndim < 1 || ndim > 7) {
+    return false;
+  }
+
+  size_t count = 1;
+  for (short i = 1; i <= ndim; i++) {
+    short d = niftiValue<short>(header, 40 + 2 * i, swap);
+    if (d < 1 || (i > 3 && d != 1)) {
+      return false;
+    }
+    if (i <= 3) {
+      dims[i - 1] = d;
+    }
+    count *= d;
+  }
+
+  bitpix = niftiValue<short>(header, 72, swap);
+  if (bitpix <= 0 || bitpix % 8) {
+    return false;
+  }
+
+  sclSlope = niftiValue<float>(header, 112, swap);
+  sclInter = niftiValue<float>(header, 116, swap);
+  voxOffset = std::max(static_cast<size_t>(niftiValue<float>(header, 108, swap)), NIFTI_MIN_VOX_OFFSET);
+  expected = count * (bitpix / 8);
+  voxels.reserve(expected);
+
+  AIAA_LOG_DEBUG("NIfTI Stream => Dims: " << dims[0] << "x" << dims[1] << "x" << dims[2] << "; BitPix: " << bitpix << "; Offset: " << voxOffset);
+  return true;
+}
+
+bool NiftiStreamDecoder::complete() const {
+  return header.size() == NIFTI_HEADER_SIZE && expected && voxels.size() == expected;
+}
+
+template<class TImage>
+bool publishImage(itk::ImageIOBase *imageIO, const std::string &fileName, const std::vector<char> &voxels, bool swap) {
+  using ImageType = TImage;
+  using PixelType = typename ImageType::PixelType;
+
+  if (imageIO->GetComponentSize() != sizeof(PixelType) || voxels.size() != imageIO->GetImageSizeInBytes()) {
+    return false;
+  }
+
+  typename ImageType::Pointer image = ImageType::New();
+  typename ImageType::RegionType region;
+  typename ImageType::SpacingType spacing;
+  typename ImageType::PointType origin;
+  typename ImageType::DirectionType direction;
+  for (unsigned int i = 0; i < ImageType::ImageDimension; i++) {
+    region.SetSize(i, imageIO->GetDimensions(i));
+    spacing[i] = imageIO->GetSpacing(i);
+    origin[i] = imageIO->GetOrigin(i);
+
+    std::vector<double> axis = imageIO->GetDirection(i);
+    for (unsigned int j = 0; j < ImageType::ImageDimension; j++) {
+      direction[j][i] = axis[j];
+    }
+  }
+
+  image->SetRegions(region);
+  image->SetSpacing(spacing);
+  image->SetOrigin(origin);
+  image->SetDirection(direction);
+  image->Allocate();
+
+  char *buffer = reinterpret_cast<char*>(image->GetBufferPointer());
+  std::memcpy(buffer, voxels.data(), voxels.size());
+  if (swap) {
+    for (size_t i = 0; i < voxels.size(); i += sizeof(PixelType)) {
+      std::reverse(buffer + i, buffer + i + sizeof(PixelType));
+    }
+  }
+
+  ImageCache::instance().put(ImageCache::key<ImageType>(fileName), image.GetPointer(), voxels.size());
+  return true;
+}
+
+bool NiftiStreamDecoder::publish(const std::string &fileName) const {
+  if (!complete() || !ImageCache::instance().getMaxSize()) {
+    return false;
+  }
+
+  // ITK applies intensity scaling (and changes pixel type) in such case; let the reader handle it
+  if (sclSlope != 0 && (sclSlope != 1 || sclInter != 0)) {
+    return false;
+  }
+
+  try {
+    // Geometry (qform/sform => LPS) exactly as ITK reader computes it; only the header is read
+    itk::ImageIOBase::Pointer imageIO = itk::ImageIOFactory::CreateImageIO(fileName.c_str(), itk::ImageIOFactory::FileModeType::ReadMode);
+    if (!imageIO) {
+      return false;
+    }
+    imageIO->SetFileName(fileName);
+    imageIO->ReadImageInformation();
+
+    if (imageIO->GetPixelType() != itk::ImageIOBase::SCALAR || imageIO->GetNumberOfDimensions() != 3) {
+      return false;
+    }
+
+    switch (imageIO->GetComponentType()) {
+      case itk::ImageIOBase::UCHAR:
+        return publishImage<itk::Image<unsigned char, 3>>(imageIO, fileName, voxels, swap);
+      case itk::ImageIOBase::CHAR:
+        return publishImage<itk::Image<char, 3>>(imageIO, fileName, voxels, swap);
+      case itk::ImageIOBase::USHORT:
+        return publishImage<itk::Image<unsigned short, 3>>(imageIO, fileName, voxels, swap);
+      case itk::ImageIOBase::SHORT:
+        return publishImage<itk::Image<short, 3>>(imageIO, fileName, voxels, swap);
+      case itk::ImageIOBase::UINT:
+        return publishImage<itk::Image<unsigned int, 3>>(imageIO, fileName, voxels, swap);
+      case itk::ImageIOBase::INT:
+        return publishImage<itk::Image<int, 3>>(imageIO, fileName, voxels, swap);
+      case itk::ImageIOBase::ULONG:
+        return publishImage<itk::Image<unsigned long, 3>>(imageIO, fileName, voxels, swap);
+      case itk::ImageIOBase::LONG:
+        return publishImage<itk::Image<long, 3>>(imageIO, fileName, voxels, swap);
+      case itk::ImageIOBase::FLOAT:
+        return publishImage<itk::Image<float, 3>>(imageIO, fileName, voxels, swap);
+      case itk::ImageIOBase::DOUBLE:
+        return publishImage<itk::Image<double, 3>>(imageIO, fileName, voxels, swap);
+      default:
+        break;
+    }
+  } catch (itk::ExceptionObject &e) {
+    AIAA_LOG_DEBUG("NIfTI Stream publish failed: " << e.what());
+  }
+  return false;
+}
+
+}
+}
@@ -29,6 +29,9 @@
 #include "../include/nvidia/aiaa/pointset.h"
 #include "../include/nvidia/aiaa/log.h"
 #include "../include/nvidia/aiaa/exception.h"
+#include "../include/nvidia/aiaa/jsonsax.h"
+#include "../include/nvidia/aiaa/jsonwriter.h"
+#include "../include/nvidia/aiaa/binarycodec.h"
 
 #include <nlohmann/json.hpp>
 
@@ -46,41 +49,69 @@ size_t PointSet::size() const {
 }
 
 void PointSet::push_back(Point point) {
-  points.push_back(point);
+  points.push_back(std::move(point));
 }
 
-PointSet PointSet::fromJson(const std::string &json, const std::string &key) {
-  try {
-    nlohmann::json j = nlohmann::json::parse(json);
-    if (!key.empty() && j.find(key) != j.end()) {
-      j = j[key];
-    }
-
-    PointSet pointSet;
-    for (auto e : j) {
-      if (e.empty()) {
-        continue;
-      }
+// Builds PointSet directly from SAX events; empty points are skipped
+struct PointSetBuilder {
+  PointSet &pointSet;
+  size_t dims = 3;
 
-      Point point;
-      for (auto n : e) {
-        point.push_back(n);
+  void open(int level) {
+    if (level == 1) {
+      pointSet.points.emplace_back();
+      pointSet.points.back().reserve(dims);
+    }
+  }
+  void close(int level) {
+    if (level == 1) {
+      if (pointSet.points.back().empty()) {
+        pointSet.points.pop_back();
+      } else {
+        dims = pointSet.points.back().size();
       }
-      pointSet.push_back(point);
     }
-    return pointSet;
-  } catch (nlohmann::json::parse_error &e) {
-    AIAA_LOG_ERROR(e.what() << "; JSON: " << json);
-    throw exception(exception::RESPONSE_PARSE_ERROR, e.what());
-  } catch (nlohmann::json::type_error &e) {
-    AIAA_LOG_ERROR(e.what());
-    throw exception(exception::RESPONSE_PARSE_ERROR, e.what());
   }
+  void value(int v) {
+    pointSet.points.back().push_back(v);
+  }
+};
+
+PointSet PointSet::fromJson(const std::string &json, const std::string &key) {
+  PointSet pointSet;
+  PointSetBuilder builder { pointSet };
+  JsonArraySax<2, PointSetBuilder> handler(builder, key);
+  jsonSaxParse(json, handler);
+  return pointSet;
 }
 
 std::string PointSet::toJson(int space) const {
-  nlohmann::json j = points;
-  return space ? j.dump(space) : j.dump();
+  if (space) {
+    nlohmann::json j = points;
+    return j.dump(space);
+  }
+
+  JsonWriter writer(JsonWriter::estimate(points));
+  writer.value(points);
+  return writer.release();
+}
+
+PointSet PointSet::fromBinary(const std::string &data) {
+  PointSet pointSet;
+  PointSetBuilder builder { pointSet };
+  BinaryArrayDecoder<2, PointSetBuilder> decoder(data, builder);
+  decoder.decode();
+  return pointSet;
+}
+
+std::string PointSet::toBinary() const {
+  int dims = -1;
+  binaryArrayDims(points, dims);
+
+  BinaryWriter writer(16 + points.size() * 8);
+  writer.header(2, dims);
+  writer.vertices(points);
+  return writer.release();
 }
 
 }
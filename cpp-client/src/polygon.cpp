@@ -27,10 +27,20 @@
  */
 
 #include "../include/nvidia/aiaa/polygon.h"
+#include "../include/nvidia/aiaa/pointset.h"
 #include "../include/nvidia/aiaa/log.h"
 #include "../include/nvidia/aiaa/exception.h"
+#include "../include/nvidia/aiaa/jsonsax.h"
+#include "../include/nvidia/aiaa/jsonwriter.h"
+#include "../include/nvidia/aiaa/binarycodec.h"
+#include "../include/nvidia/aiaa/utils.h"
 
 #include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <queue>
 
 namespace nvidia {
 namespace aiaa {
@@ -65,7 +75,7 @@ bool Polygons::findFirstNonMatching(const Polygons &polygons, int &polyIndex, in
     const Polygon &p1 = polys[i];
     const Polygon &p2 = polygons.polys[i];
 
-    for (size_t j = 0; j < p1.size() && p2.size(); j++) {
+    for (size_t j = 0; j < p1.size() && j < p2.size(); j++) {
       const Point &pt1 = p1[j];
       const Point &pt2 = p2[j];
 
@@ -82,43 +92,475 @@ bool Polygons::findFirstNonMatching(const Polygons &polygons, int &polyIndex, in
   return false;
 }
 
+bool Polygons::findNearestVertex(const Point &point, int &polyIndex, int &vertexIndex) const {
+  if (point.size() < 2) {
+    return false;
+  }
+
+  long best = -1;
+  for (size_t i = 0; i < polys.size(); i++) {
+    for (size_t j = 0; j < polys[i].size(); j++) {
+      const Point &v = polys[i][j];
+      if (v.size() < 2) {
+        continue;
+      }
+
+      long dx = v[0] - point[0], dy = v[1] - point[1];
+      long d = dx * dx + dy * dy;
+      if (best < 0 || d < best) {
+        best = d;
+        polyIndex = static_cast<int>(i);
+        vertexIndex = static_cast<int>(j);
+      }
+    }
+  }
+  return best >= 0;
+}
+
+std::vector<VertexEdit> Polygons::diff(const Polygons &older, int sliceIndex) const {
+  std::vector<VertexEdit> edits;
+  for (size_t i = 0; i < polys.size() && i < older.polys.size(); i++) {
+    const Polygon &p1 = polys[i];
+    const Polygon &p2 = older.polys[i];
+
+    for (size_t j = 0; j < p1.size() && j < p2.size(); j++) {
+      const Point &pt1 = p1[j];
+      const Point &pt2 = p2[j];
+      if (pt1.size() < 2 || pt2.size() < 2 || (pt1[0] == pt2[0] && pt1[1] == pt2[1])) {
+        continue;
+      }
+
+      VertexEdit edit;
+      edit.sliceIndex = sliceIndex;
+      edit.polyIndex = static_cast<int>(i);
+      edit.vertexIndex = static_cast<int>(j);
+      edit.vertexOffset[0] = pt1[0] - pt2[0];
+      edit.vertexOffset[1] = pt1[1] - pt2[1];
+      edits.push_back(edit);
+    }
+  }
+  return edits;
+}
+
+// Builds Polygons directly from SAX events (arrays at level base + 1/2 are polygon/point); each new polygon/point reserves
+// the size of its previous sibling
+struct PolygonsBuilder {
+  std::vector<Polygons::Polygon> *polys;
+  int base;
+  size_t polygonSize = 0;
+  size_t pointSize = 2;
+
+  void open(int level) {
+    level -= base;
+    if (level == 1) {
+      polys->emplace_back();
+      polys->back().reserve(polygonSize);
+    } else if (level == 2) {
+      polys->back().emplace_back();
+      polys->back().back().reserve(pointSize);
+    }
+  }
+  void close(int level) {
+    level -= base;
+    if (level == 1) {
+      polygonSize = polys->back().size();
+    } else if (level == 2) {
+      pointSize = std::max(pointSize, polys->back().back().size());
+    }
+  }
+  void value(int v) {
+    polys->back().back().push_back(v);
+  }
+};
+
 Polygons Polygons::fromJson(const std::string &json, const std::string &key) {
-  try {
-    nlohmann::json j = nlohmann::json::parse(json);
-    if (!key.empty() && j.find(key) != j.end()) {
-      j = j[key];
-    }
-
-    Polygons polygons;
-    for (auto poly : j) {
-      Polygons::Polygon polygon;
-      if (!poly.empty()) {
-        for (auto pt : poly) {
-          Polygons::Point point;
-          if (!pt.empty()) {
-            for (auto n : pt) {
-              point.push_back(n);
-            }
+  Polygons polygons;
+  PolygonsBuilder builder { &polygons.polys, 0 };
+  JsonArraySax<3, PolygonsBuilder> handler(builder, key);
+  jsonSaxParse(json, handler);
+  return polygons;
+}
+
+std::string Polygons::toJson(int space) const {
+  if (space) {
+    nlohmann::json j = polys;
+    return j.dump(space);
+  }
+
+  JsonWriter writer(JsonWriter::estimate(polys));
+  writer.value(polys);
+  return writer.release();
+}
+
+// Traces contours of 2D mask (see Polygons::fromMask); sink.polygon(n) starts a polygon of n vertices and sink.vertex(y, x)
+// appends a vertex to it
+template<class TSink>
+void traceContours(const unsigned char *mask, int width, int height, int pointRatio, TSink &sink) {
+  if (!mask || width <= 0 || height <= 0) {
+    return;
+  }
+  pointRatio = std::max(pointRatio, 1);
+
+  // Mask padded with background so that every contour is closed
+  const size_t pw = width + 2, ph = height + 2;
+  std::vector<unsigned char> padded(pw * ph, 0);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      padded[(y + 1) * pw + x + 1] = mask[static_cast<size_t>(y) * width + x] ? 1 : 0;
+    }
+  }
+
+  // Edge between pixel p and its right (2p) or bottom (2p+1) neighbour; next[e] is the following crossing edge of contour
+  std::vector<int> next(2 * pw * ph, -1);
+  for (size_t cy = 0; cy + 1 < ph; cy++) {
+    for (size_t cx = 0; cx + 1 < pw; cx++) {
+      const size_t p = cy * pw + cx;
+      const unsigned char corner[4] = { padded[p], padded[p + 1], padded[p + pw + 1], padded[p + pw] };
+      if ((corner[0] & corner[1] & corner[2] & corner[3]) || !(corner[0] | corner[1] | corner[2] | corner[3])) {
+        continue;
+      }
+
+      // Cell edges in clockwise order (top, right, bottom, left); contour enters foreground and leaves at next crossing
+      const int edge[4] = { static_cast<int>(2 * p), static_cast<int>(2 * (p + 1) + 1), static_cast<int>(2 * (p + pw)),
+          static_cast<int>(2 * p + 1) };
+      for (int k = 0; k < 4; k++) {
+        if (!corner[k] && corner[(k + 1) % 4]) {
+          int j = (k + 1) % 4;
+          while (corner[j] == corner[(j + 1) % 4]) {
+            j = (j + 1) % 4;
           }
-          polygon.push_back(point);
+          next[edge[k]] = edge[j];
         }
       }
-      polygons.push_back(polygon);
     }
-    return polygons;
+  }
+
+  // Foreground pixel [y,x] of crossing edge
+  auto vertex = [&](int e) {
+    size_t p = e / 2;
+    if (!padded[p]) {
+      p += (e % 2) ? pw : 1;
+    }
+    return Point2D { { static_cast<int>(p / pw) - 1, static_cast<int>(p % pw) - 1 } };
+  };
+
+  std::vector<Point2D> contour;
+  for (size_t start = 0; start < next.size(); start++) {
+    if (next[start] < 0) {
+      continue;
+    }
+
+    contour.clear();
+    int e = static_cast<int>(start);
+    while (next[e] >= 0) {
+      Point2D v = vertex(e);
+      if (contour.empty() || contour.back() != v) {
+        contour.push_back(v);
+      }
+
+      int n = next[e];
+      next[e] = -1;
+      e = n;
+    }
+    if (contour.size() > 1 && contour.front() == contour.back()) {
+      contour.pop_back();
+    }
 
-  } catch (nlohmann::json::parse_error &e) {
-    AIAA_LOG_ERROR(e.what());
-    throw exception(exception::RESPONSE_PARSE_ERROR, e.what());
-  } catch (nlohmann::json::type_error &e) {
-    AIAA_LOG_ERROR(e.what());
-    throw exception(exception::RESPONSE_PARSE_ERROR, e.what());
+    sink.polygon((contour.size() + pointRatio - 1) / pointRatio);
+    for (size_t i = 0; i < contour.size(); i += pointRatio) {
+      sink.vertex(contour[i][0], contour[i][1]);
+    }
   }
 }
 
-std::string Polygons::toJson(int space) const {
-  nlohmann::json j = polys;
-  return space ? j.dump(space) : j.dump();
+struct PolygonsSink {
+  Polygons &polygons;
+
+  void polygon(size_t n) {
+    polygons.polys.emplace_back();
+    polygons.polys.back().reserve(n);
+  }
+  void vertex(int y, int x) {
+    polygons.polys.back().push_back(Polygons::Point { y, x });
+  }
+};
+
+Polygons Polygons::fromMask(const unsigned char *mask, int width, int height, int pointRatio) {
+  Polygons polygons;
+  PolygonsSink sink { polygons };
+  traceContours(mask, width, height, pointRatio, sink);
+  return polygons;
+}
+
+// Polygon edge for scanline fill; covers rows [yMin, yMax) and x is the crossing at yMin
+struct ScanEdge {
+  int yMin;
+  int yMax;
+  double x;
+  double dxdy;
+};
+
+// Marks pixels of line (y0,x0) -> (y1,x1) which are inside the mask
+void drawLine(unsigned char *mask, int width, int height, unsigned char label, int y0, int x0, int y1, int x1) {
+  const int dx = std::abs(x1 - x0), dy = -std::abs(y1 - y0);
+  const int sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1;
+  int err = dx + dy;
+  while (true) {
+    if (x0 >= 0 && x0 < width && y0 >= 0 && y0 < height) {
+      mask[static_cast<size_t>(y0) * width + x0] = label;
+    }
+    if (x0 == x1 && y0 == y1) {
+      break;
+    }
+    int e2 = 2 * err;
+    if (e2 >= dy) {
+      err += dy;
+      x0 += sx;
+    }
+    if (e2 <= dx) {
+      err += dx;
+      y0 += sy;
+    }
+  }
+}
+
+void Polygons::toMask(unsigned char *mask, int width, int height, unsigned char label) const {
+  if (!mask || width <= 0 || height <= 0) {
+    return;
+  }
+
+  // Edge table of all polygons (even-odd rule across polygons; so holes are cut out)
+  std::vector<ScanEdge> edges;
+  for (auto &poly : polys) {
+    for (size_t i = 0; i < poly.size(); i++) {
+      const Point &p0 = poly[i];
+      const Point &p1 = poly[(i + 1) % poly.size()];
+      if (p0.size() < 2 || p1.size() < 2 || p0[0] == p1[0]) {
+        continue;
+      }
+
+      const Point &a = p0[0] < p1[0] ? p0 : p1;
+      const Point &b = p0[0] < p1[0] ? p1 : p0;
+      double dxdy = static_cast<double>(b[1] - a[1]) / (b[0] - a[0]);
+      edges.push_back(ScanEdge { a[0], b[0], static_cast<double>(a[1]), dxdy });
+    }
+  }
+  std::sort(edges.begin(), edges.end(), [](const ScanEdge &e1, const ScanEdge &e2) {
+    return e1.yMin < e2.yMin;
+  });
+
+  // Active edge list per row; spans between pairs of crossings are filled (contiguous fill is vectorized by the compiler)
+  std::vector<const ScanEdge*> active;
+  std::vector<double> xs;
+  size_t nextEdge = 0;
+  const int yStart = edges.empty() ? height : std::max(edges.front().yMin, 0);
+  for (int y = yStart; y < height && (nextEdge < edges.size() || !active.empty()); y++) {
+    while (nextEdge < edges.size() && edges[nextEdge].yMin <= y) {
+      active.push_back(&edges[nextEdge++]);
+    }
+    active.erase(std::remove_if(active.begin(), active.end(), [y](const ScanEdge *e) {
+      return e->yMax <= y;
+    }), active.end());
+
+    xs.clear();
+    for (auto e : active) {
+      xs.push_back(e->x + (y - e->yMin) * e->dxdy);
+    }
+    std::sort(xs.begin(), xs.end());
+
+    unsigned char *row = mask + static_cast<size_t>(y) * width;
+    for (size_t i = 0; i + 1 < xs.size(); i += 2) {
+      int x0 = std::max(static_cast<int>(std::ceil(xs[i])), 0);
+      int x1 = std::min(static_cast<int>(std::floor(xs[i + 1])), width - 1);
+      if (x0 <= x1) {
+        std::fill(row + x0, row + x1 + 1, label);
+      }
+    }
+  }
+
+  // Outline (vertices are boundary pixels)
+  for (auto &poly : polys) {
+    for (size_t i = 0; i < poly.size(); i++) {
+      const Point &p0 = poly[i];
+      const Point &p1 = poly[(i + 1) % poly.size()];
+      if (p0.size() >= 2 && p1.size() >= 2) {
+        drawLine(mask, width, height, label, p0[0], p0[1], p1[0], p1[1]);
+      }
+    }
+  }
+}
+
+// Distance of point p from segment (a, b); only first two coordinates are used
+double segmentDistance(const Polygons::Point &p, const Polygons::Point &a, const Polygons::Point &b) {
+  const double dx = b[0] - a[0], dy = b[1] - a[1];
+  const double len2 = dx * dx + dy * dy;
+  double t = len2 > 0 ? ((p[0] - a[0]) * dx + (p[1] - a[1]) * dy) / len2 : 0;
+  t = std::max(0.0, std::min(1.0, t));
+  const double ex = a[0] + t * dx - p[0], ey = a[1] + t * dy - p[1];
+  return std::sqrt(ex * ex + ey * ey);
+}
+
+// Area of triangle (a, b, c); only first two coordinates are used
+double triangleArea(const Polygons::Point &a, const Polygons::Point &b, const Polygons::Point &c) {
+  return std::abs(double(b[0] - a[0]) * (c[1] - a[1]) - double(c[0] - a[0]) * (b[1] - a[1])) / 2;
+}
+
+// Douglas-Peucker on closed polygon; split at vertex 0 and the vertex farthest from it, each chain is simplified iteratively
+void simplifyDouglasPeucker(const Polygons::Polygon &poly, double tolerance, std::vector<bool> &keep) {
+  const size_t n = poly.size();
+  size_t far = 0;
+  double farDistance = -1;
+  for (size_t i = 1; i < n; i++) {
+    double d = segmentDistance(poly[i], poly[0], poly[0]);
+    if (d > farDistance) {
+      farDistance = d;
+      far = i;
+    }
+  }
+
+  keep[0] = keep[far] = true;
+  std::vector<std::pair<size_t, size_t>> stack = { { 0, far }, { far, n } };  // index n is vertex 0 (closing edge)
+  while (!stack.empty()) {
+    size_t first = stack.back().first, last = stack.back().second;
+    stack.pop_back();
+
+    const Polygons::Point &a = poly[first], &b = poly[last % n];
+    size_t index = 0;
+    double maxDistance = tolerance;
+    for (size_t i = first + 1; i < last; i++) {
+      double d = segmentDistance(poly[i], a, b);
+      if (d > maxDistance) {
+        maxDistance = d;
+        index = i;
+      }
+    }
+
+    if (index) {
+      keep[index] = true;
+      stack.push_back( { first, index });
+      stack.push_back( { index, last });
+    }
+  }
+
+  // Polygon collapsed to a line; keep the vertex farthest from it
+  if (std::count(keep.begin(), keep.end(), true) < 3) {
+    size_t index = 0;
+    double maxDistance = -1;
+    for (size_t i = 1; i < n; i++) {
+      double d = segmentDistance(poly[i], poly[0], poly[far]);
+      if (i != far && d > maxDistance) {
+        maxDistance = d;
+        index = i;
+      }
+    }
+    keep[index] = true;
+  }
+}
+
+// Visvalingam-Whyatt on closed polygon; vertex with smallest effective area is removed until all areas exceed the threshold
+void simplifyVisvalingamWhyatt(const Polygons::Polygon &poly, double tolerance, std::vector<bool> &keep) {
+  const size_t n = poly.size();
+  const double threshold = tolerance * tolerance;
+  std::vector<size_t> prev(n), next(n);
+  std::vector<double> area(n);
+
+  typedef std::pair<double, size_t> Entry;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+  for (size_t i = 0; i < n; i++) {
+    prev[i] = (i + n - 1) % n;
+    next[i] = (i + 1) % n;
+    area[i] = triangleArea(poly[prev[i]], poly[i], poly[next[i]]);
+    heap.push( { area[i], i });
+    keep[i] = true;
+  }
+
+  size_t remaining = n;
+  while (!heap.empty() && remaining > 3) {
+    Entry e = heap.top();
+    heap.pop();
+    if (!keep[e.second] || e.first != area[e.second]) {
+      continue;  // removed or stale entry
+    }
+    if (e.first > threshold) {
+      break;
+    }
+
+    size_t i = e.second, p = prev[i], q = next[i];
+    keep[i] = false;
+    remaining--;
+    next[p] = q;
+    prev[q] = p;
+
+    // Effective area of neighbors never drops below the removed one (keeps removal order monotonic)
+    area[p] = std::max(e.first, triangleArea(poly[prev[p]], poly[p], poly[q]));
+    area[q] = std::max(e.first, triangleArea(poly[p], poly[q], poly[next[q]]));
+    heap.push( { area[p], p });
+    heap.push( { area[q], q });
+  }
+}
+
+void Polygons::simplify(double tolerance, SimplifyMethod method) {
+  if (tolerance <= 0) {
+    return;
+  }
+
+  std::vector<bool> keep;
+  for (auto &poly : polys) {
+    if (poly.size() <= 3 || std::any_of(poly.begin(), poly.end(), [](const Point &p) {return p.size() < 2;})) {
+      continue;
+    }
+
+    keep.assign(poly.size(), false);
+    if (method == SIMPLIFY_VISVALINGAM_WHYATT) {
+      simplifyVisvalingamWhyatt(poly, tolerance, keep);
+    } else {
+      simplifyDouglasPeucker(poly, tolerance, keep);
+    }
+
+    size_t k = 0;
+    for (size_t i = 0; i < poly.size(); i++) {
+      if (keep[i]) {
+        if (k != i) {
+          poly[k] = std::move(poly[i]);
+        }
+        k++;
+      }
+    }
+    poly.resize(k);
+  }
+}
+
+Polygons Polygons::fromBinary(const std::string &data) {
+  Polygons polygons;
+  PolygonsBuilder builder { &polygons.polys, 0 };
+  BinaryArrayDecoder<3, PolygonsBuilder> decoder(data, builder);
+  decoder.decode();
+  return polygons;
+}
+
+std::string Polygons::toBinary() const {
+  int dims = -1;
+  for (auto &poly : polys) {
+    binaryArrayDims(poly, dims);
+  }
+
+  // Each polygon is a level 0 element; sizes go into the offset table
+  BinaryWriter body(JsonWriter::estimate(polys) / 2);
+  body.setDims(dims < 0 ? 2 : dims);
+  std::vector<size_t> sizes;
+  sizes.reserve(polys.size());
+  for (auto &poly : polys) {
+    size_t start = body.size();
+    body.vertices(poly);
+    sizes.push_back(body.size() - start);
+  }
+
+  BinaryWriter writer(body.size() + polys.size() * 2 + 16);
+  writer.header(3, dims).varint(polys.size());
+  for (auto size : sizes) {
+    writer.varint(size);
+  }
+  return writer.raw(body.release()).release();
 }
 
 bool PolygonsList::empty() const {
@@ -140,40 +582,460 @@ void PolygonsList::flipXY() {
 }
 
 // [[ [[170, 66],[162, 73],[169, 77],[180, 76],[185, 68],[175, 66]], [[1,2]], [] ]]
+// Builds PolygonsList (one Polygons per slice) directly from SAX events
+struct PolygonsListBuilder {
+  std::vector<Polygons> &list;
+  PolygonsBuilder polygons { nullptr, 1 };
+
+  void open(int level) {
+    if (level == 1) {
+      list.emplace_back();
+      polygons.polys = &list.back().polys;
+    } else if (level > 1) {
+      polygons.open(level);
+    }
+  }
+  void close(int level) {
+    if (level > 1) {
+      polygons.close(level);
+    }
+  }
+  void value(int v) {
+    polygons.value(v);
+  }
+};
+
 PolygonsList PolygonsList::fromJson(const std::string &json, const std::string &key) {
-  try {
-    nlohmann::json j = nlohmann::json::parse(json);
-    if (!key.empty() && j.find(key) != j.end()) {
-      j = j[key];
+  PolygonsList polygonsList;
+  PolygonsListBuilder builder { polygonsList.list };
+  JsonArraySax<4, PolygonsListBuilder> handler(builder, key);
+  jsonSaxParse(json, handler);
+  return polygonsList;
+}
+
+std::vector<VertexEdit> PolygonsList::diff(const PolygonsList &older) const {
+  std::vector<VertexEdit> edits;
+  for (size_t i = 0; i < list.size() && i < older.list.size(); i++) {
+    std::vector<VertexEdit> e = list[i].diff(older.list[i], static_cast<int>(i));
+    edits.insert(edits.end(), e.begin(), e.end());
+  }
+  return edits;
+}
+
+/////////////////
+// VertexEdit //
+/////////////////
+
+// Polygons of edit's slice (nullptr if slice index is not valid)
+const Polygons* editSlice(const Polygons &poly, const VertexEdit &) {
+  return &poly;
+}
+
+const Polygons* editSlice(const PolygonsList &poly, const VertexEdit &e) {
+  return e.sliceIndex >= 0 && static_cast<size_t>(e.sliceIndex) < poly.list.size() ? &poly.list[e.sliceIndex] : nullptr;
+}
+
+template<class TPolygons>
+void applyVertexEditsSequential(TPolygons &poly, const std::vector<VertexEdit> &edits,
+                                const std::function<void(TPolygons &poly, const VertexEdit &edit)> &apply) {
+  // Original (pre-edit) vertex and its target position for each edit
+  struct Target {
+    VertexEdit edit;
+    Polygons::Point from;
+    Polygons::Point to;
+  };
+
+  std::vector<Target> targets;
+  targets.reserve(edits.size());
+  for (const auto &e : edits) {
+    const Polygons *slice = editSlice(poly, e);
+    const Polygons::Polygon *polygon = slice && e.polyIndex >= 0 && static_cast<size_t>(e.polyIndex) < slice->polys.size() ?
+        &slice->polys[e.polyIndex] : nullptr;
+    if (!polygon || e.vertexIndex < 0 || static_cast<size_t>(e.vertexIndex) >= polygon->size() || (*polygon)[e.vertexIndex].size() < 2) {
+      AIAA_LOG_ERROR("Invalid Vertex Edit (slice: " << e.sliceIndex << "; polygon: " << e.polyIndex << "; vertex: " << e.vertexIndex << ")");
+      throw exception(exception::INVALID_ARGS_ERROR, "Invalid Vertex Edit");
     }
 
-    PolygonsList polygonsList;
-    for (auto p : j) {
-      if (!p.empty()) {
-        Polygons polygons = Polygons::fromJson(p.dump());
-        polygonsList.push_back(polygons);
-      } else {
-        polygonsList.push_back(Polygons());
-      }
+    const Polygons::Point &v = (*polygon)[e.vertexIndex];
+    targets.push_back(Target { e, { v[0], v[1] }, { v[0] + e.vertexOffset[0], v[1] + e.vertexOffset[1] } });
+  }
+
+  for (const auto &t : targets) {
+    VertexEdit edit = t.edit;
+    const Polygons *slice = editSlice(poly, edit);
+    if (!slice || !slice->findNearestVertex(t.from, edit.polyIndex, edit.vertexIndex)) {
+      AIAA_LOG_WARN("Vertex Edit no longer matches updated polygons (slice: " << edit.sliceIndex << ")");
+      continue;
     }
 
-    return polygonsList;
-  } catch (nlohmann::json::parse_error &e) {
-    AIAA_LOG_ERROR(e.what());
-    throw exception(exception::RESPONSE_PARSE_ERROR, e.what());
-  } catch (nlohmann::json::type_error &e) {
-    AIAA_LOG_ERROR(e.what());
-    throw exception(exception::RESPONSE_PARSE_ERROR, e.what());
+    const Polygons::Point &v = slice->polys[edit.polyIndex][edit.vertexIndex];
+    edit.vertexOffset[0] = t.to[0] - v[0];
+    edit.vertexOffset[1] = t.to[1] - v[1];
+    apply(poly, edit);
   }
 }
 
+void VertexEdit::applySequential(Polygons &poly, const std::vector<VertexEdit> &edits,
+                                 const std::function<void(Polygons &poly, const VertexEdit &edit)> &apply) {
+  applyVertexEditsSequential(poly, edits, apply);
+}
+
+void VertexEdit::applySequential(PolygonsList &poly, const std::vector<VertexEdit> &edits,
+                                 const std::function<void(PolygonsList &poly, const VertexEdit &edit)> &apply) {
+  applyVertexEditsSequential(poly, edits, apply);
+}
+
+void PolygonsList::toMask(unsigned char *mask, int width, int height, int depth, unsigned char label) const {
+  const size_t slices = std::min(list.size(), static_cast<size_t>(std::max(depth, 0)));
+  const size_t sliceSize = static_cast<size_t>(std::max(width, 0)) * std::max(height, 0);
+  Utils::parallelFor(slices, [&](size_t z) {
+    list[z].toMask(mask + z * sliceSize, width, height, label);
+  });
+}
+
+void PolygonsList::simplify(double tolerance, Polygons::SimplifyMethod method) {
+  Utils::parallelFor(list.size(), [&](size_t z) {
+    list[z].simplify(tolerance, method);
+  });
+}
+
+PolygonsList PolygonsList::fromBinary(const std::string &data) {
+  PolygonsList polygonsList;
+  PolygonsListBuilder builder { polygonsList.list };
+  BinaryArrayDecoder<4, PolygonsListBuilder> decoder(data, builder);
+  decoder.decode();
+  return polygonsList;
+}
+
+std::string PolygonsList::toBinary() const {
+  int dims = -1;
+  size_t estimate = 0;
+  for (auto &p : list) {
+    for (auto &poly : p.polys) {
+      binaryArrayDims(poly, dims);
+    }
+    estimate += JsonWriter::estimate(p.polys) / 2;
+  }
+
+  BinaryWriter body(estimate);
+  body.setDims(dims < 0 ? 2 : dims);
+  std::vector<size_t> sizes;
+  sizes.reserve(list.size());
+  for (auto &p : list) {
+    size_t start = body.size();
+    body.varint(p.polys.size());
+    for (auto &poly : p.polys) {
+      body.vertices(poly);
+    }
+    sizes.push_back(body.size() - start);
+  }
+
+  BinaryWriter writer(body.size() + list.size() * 2 + 16);
+  writer.header(4, dims).varint(list.size());
+  for (auto size : sizes) {
+    writer.varint(size);
+  }
+  return writer.raw(body.release()).release();
+}
+
 std::string PolygonsList::toJson(int space) const {
-  nlohmann::json j;
-  for (auto p : list) {
-    j.push_back(nlohmann::json::parse(p.toJson()));
+  if (space) {
+    nlohmann::json j = nlohmann::json::array();
+    for (auto &p : list) {
+      j.push_back(p.polys);
+    }
+    return j.dump(space);
+  }
+
+  size_t size = 2;
+  for (auto &p : list) {
+    size += JsonWriter::estimate(p.polys) + 1;
+  }
+
+  JsonWriter writer(size);
+  writer.beginArray();
+  for (auto &p : list) {
+    writer.value(p.polys);
+  }
+  writer.endArray();
+  return writer.release();
+}
+
+bool FlatPolygonsList::empty() const {
+  return sliceOffsets.size() <= 1;
+}
+
+size_t FlatPolygonsList::size() const {
+  return sliceOffsets.size() - 1;
+}
+
+size_t FlatPolygonsList::polygons(size_t slice) const {
+  return sliceOffsets[slice + 1] - sliceOffsets[slice];
+}
+
+size_t FlatPolygonsList::vertices() const {
+  return polygonOffsets.back();
+}
+
+FlatPolygonsList::PolygonView FlatPolygonsList::polygon(size_t slice, size_t poly) const {
+  size_t p = sliceOffsets[slice] + poly;
+  return PolygonView { coords.data() + polygonOffsets[p] * dims, polygonOffsets[p + 1] - polygonOffsets[p], dims };
+}
+
+void FlatPolygonsList::addSlice() {
+  sliceOffsets.push_back(sliceOffsets.back());
+}
+
+void FlatPolygonsList::addPolygon() {
+  polygonOffsets.push_back(polygonOffsets.back());
+  sliceOffsets.back()++;
+}
+
+void FlatPolygonsList::addVertex(const int *point, size_t size) {
+  if (size != static_cast<size_t>(dims)) {
+    AIAA_LOG_ERROR("Vertex of size " << size << " in FlatPolygonsList of dims " << dims);
+    throw exception(exception::INVALID_ARGS_ERROR, "Vertex size does not match dims of FlatPolygonsList");
+  }
+  coords.insert(coords.end(), point, point + size);
+  polygonOffsets.back()++;
+}
+
+void FlatPolygonsList::append(const FlatPolygonsList &other) {
+  if (other.empty()) {
+    return;
+  }
+  if (other.dims != dims) {
+    throw exception(exception::INVALID_ARGS_ERROR, "Mismatch in dims of FlatPolygonsList");
+  }
+
+  const size_t polygonBase = polygonOffsets.size() - 1;
+  const size_t vertexBase = polygonOffsets.back();
+  coords.insert(coords.end(), other.coords.begin(), other.coords.end());
+  for (size_t p = 1; p < other.polygonOffsets.size(); p++) {
+    polygonOffsets.push_back(vertexBase + other.polygonOffsets[p]);
+  }
+  for (size_t s = 1; s < other.sliceOffsets.size(); s++) {
+    sliceOffsets.push_back(polygonBase + other.sliceOffsets[s]);
   }
+}
+
+// Appends traced contours as polygons of last slice
+struct FlatPolygonsSink {
+  FlatPolygonsList &flat;
+
+  void polygon(size_t n) {
+    flat.addPolygon();
+    flat.coords.reserve(flat.coords.size() + n * 2);
+  }
+  void vertex(int y, int x) {
+    const int point[2] = { y, x };
+    flat.addVertex(point, 2);
+  }
+};
+
+void FlatPolygonsList::addSlice(const unsigned char *mask, int width, int height, int pointRatio) {
+  if (dims != 2) {
+    throw exception(exception::INVALID_ARGS_ERROR, "Mask contours need FlatPolygonsList of dims 2");
+  }
+
+  addSlice();
+  FlatPolygonsSink sink { *this };
+  traceContours(mask, width, height, pointRatio, sink);
+}
 
-  return space ? j.dump(space) : j.dump();
+void FlatPolygonsList::flipXY() {
+  if (dims < 2) {
+    return;
+  }
+
+  // Single strided loop over all vertices of all slices
+  int *c = coords.data();
+  const size_t n = vertices();
+  for (size_t i = 0; i < n; i++) {
+    std::swap(c[i * dims], c[i * dims + 1]);
+  }
+}
+
+bool FlatPolygonsList::findFirstNonMatching(size_t slice, const FlatPolygonsList &other, int &polyIndex, int &vertexIndex) const {
+  if (slice >= size() || slice >= other.size()) {
+    return false;
+  }
+
+  const int d = std::min(dims, other.dims);
+  for (size_t p = 0; p < polygons(slice) && p < other.polygons(slice); p++) {
+    PolygonView p1 = polygon(slice, p);
+    PolygonView p2 = other.polygon(slice, p);
+
+    for (size_t v = 0; v < p1.size() && v < p2.size(); v++) {
+      if (!std::equal(p1[v], p1[v] + d, p2[v])) {
+        polyIndex = static_cast<int>(p);
+        vertexIndex = static_cast<int>(v);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+FlatPolygonsList FlatPolygonsList::fromPolygonsList(const PolygonsList &polygonsList) {
+  FlatPolygonsList flat;
+
+  size_t polygons = 0, vertices = 0;
+  bool dimsFound = false;
+  for (auto &p : polygonsList.list) {
+    polygons += p.polys.size();
+    for (auto &poly : p.polys) {
+      vertices += poly.size();
+      if (!dimsFound && !poly.empty()) {
+        flat.dims = static_cast<int>(poly[0].size());
+        dimsFound = true;
+      }
+    }
+  }
+
+  flat.coords.reserve(vertices * flat.dims);
+  flat.polygonOffsets.reserve(polygons + 1);
+  flat.sliceOffsets.reserve(polygonsList.list.size() + 1);
+  for (auto &p : polygonsList.list) {
+    flat.addSlice();
+    for (auto &poly : p.polys) {
+      flat.addPolygon();
+      for (auto &pt : poly) {
+        flat.addVertex(pt.data(), pt.size());
+      }
+    }
+  }
+  return flat;
+}
+
+Polygons FlatPolygonsList::toPolygons(size_t slice) const {
+  Polygons polygons;
+  polygons.polys.reserve(this->polygons(slice));
+  for (size_t p = 0; p < this->polygons(slice); p++) {
+    PolygonView view = polygon(slice, p);
+
+    Polygons::Polygon poly;
+    poly.reserve(view.size());
+    for (size_t v = 0; v < view.size(); v++) {
+      poly.emplace_back(view[v], view[v] + dims);
+    }
+    polygons.polys.push_back(std::move(poly));
+  }
+  return polygons;
+}
+
+PolygonsList FlatPolygonsList::toPolygonsList() const {
+  PolygonsList polygonsList;
+  polygonsList.list.reserve(size());
+  for (size_t s = 0; s < size(); s++) {
+    polygonsList.list.push_back(toPolygons(s));
+  }
+  return polygonsList;
+}
+
+// Builds FlatPolygonsList directly from SAX events (level 1/2/3 = slice/polygon/vertex)
+struct FlatPolygonsListBuilder {
+  FlatPolygonsList &flat;
+  std::vector<int> point;
+
+  void open(int level) {
+    if (level == 1) {
+      flat.addSlice();
+    } else if (level == 2) {
+      flat.addPolygon();
+    } else if (level == 3) {
+      point.clear();
+    }
+  }
+  void close(int level) {
+    if (level == 3) {
+      if (point.size() != static_cast<size_t>(flat.dims)) {
+        AIAA_LOG_ERROR("Vertex of size " << point.size() << " in FlatPolygonsList of dims " << flat.dims);
+        throw exception(exception::RESPONSE_PARSE_ERROR, "Vertex size does not match dims of FlatPolygonsList");
+      }
+      flat.addVertex(point.data(), point.size());
+    }
+  }
+  void value(int v) {
+    point.push_back(v);
+  }
+};
+
+FlatPolygonsList FlatPolygonsList::fromJson(const std::string &json, const std::string &key, int dims) {
+  FlatPolygonsList flat;
+  flat.dims = dims;
+
+  FlatPolygonsListBuilder builder { flat, std::vector<int>() };
+  JsonArraySax<4, FlatPolygonsListBuilder> handler(builder, key);
+  jsonSaxParse(json, handler);
+  return flat;
+}
+
+std::string FlatPolygonsList::toJson(int space) const {
+  if (space) {
+    return nlohmann::json::parse(toJson()).dump(space);
+  }
+
+  JsonWriter writer(coords.size() * 5 + polygonOffsets.size() * 3 + sliceOffsets.size() * 3);
+  writer.beginArray();
+  for (size_t s = 0; s < size(); s++) {
+    writer.beginArray();
+    for (size_t p = 0; p < polygons(s); p++) {
+      PolygonView view = polygon(s, p);
+      writer.beginArray();
+      for (size_t v = 0; v < view.size(); v++) {
+        writer.beginArray();
+        for (int d = 0; d < dims; d++) {
+          writer.value(view[v][d]);
+        }
+        writer.endArray();
+      }
+      writer.endArray();
+    }
+    writer.endArray();
+  }
+  writer.endArray();
+  return writer.release();
+}
+
+FlatPolygonsList FlatPolygonsList::fromBinary(const std::string &data) {
+  FlatPolygonsList flat;
+  flat.dims = BinaryReader(data).header(4);
+  if (flat.dims <= 0) {
+    BinaryReader::fail("FlatPolygonsList needs fixed dimension binary array");
+  }
+
+  FlatPolygonsListBuilder builder { flat, std::vector<int>() };
+  BinaryArrayDecoder<4, FlatPolygonsListBuilder> decoder(data, builder);
+  decoder.decode();
+  return flat;
+}
+
+std::string FlatPolygonsList::toBinary() const {
+  BinaryWriter body(coords.size() + polygonOffsets.size() + sliceOffsets.size());
+  body.setDims(dims);
+  std::vector<size_t> sizes;
+  sizes.reserve(size());
+  for (size_t s = 0; s < size(); s++) {
+    size_t start = body.size();
+    body.varint(polygons(s));
+    for (size_t p = 0; p < polygons(s); p++) {
+      PolygonView view = polygon(s, p);
+      body.varint(view.size());
+      body.resetDelta();
+      for (size_t v = 0; v < view.size(); v++) {
+        body.vertex(view[v], dims);
+      }
+    }
+    sizes.push_back(body.size() - start);
+  }
+
+  BinaryWriter writer(body.size() + size() * 2 + 16);
+  writer.header(4, dims).varint(size());
+  for (auto size : sizes) {
+    writer.varint(size);
+  }
+  return writer.raw(body.release()).release();
 }
 
 }
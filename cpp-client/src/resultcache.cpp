@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "../include/nvidia/aiaa/resultcache.h"
+#include "../include/nvidia/aiaa/log.h"
+#include "../include/nvidia/aiaa/exception.h"
+#include "../include/nvidia/aiaa/utils.h"
+
+#include <nlohmann/json.hpp>
+
+#include <Poco/DigestEngine.h>
+#include <Poco/DirectoryIterator.h>
+#include <Poco/Exception.h>
+#include <Poco/File.h>
+#include <Poco/NamedMutex.h>
+#include <Poco/Path.h>
+#include <Poco/SHA1Engine.h>
+#include <Poco/Timestamp.h>
+#include <Poco/UUIDGenerator.h>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+namespace nvidia {
+namespace aiaa {
+
+const size_t ResultCache::DEFAULT_MAX_SIZE = 1024 * 1024 * 1024;
+
+const std::string CACHE_RESPONSE_EXTENSION = ".json";
+const std::string CACHE_IMAGE_EXTENSION = ".bin";
+const std::string CACHE_TEMP_EXTENSION = ".tmp";
+const size_t CACHE_READ_BLOCK_SIZE = 1024 * 1024;
+const int CACHE_STALE_TEMP_IN_SEC = 3600;
+
+namespace {
+
+std::string sha1(const std::string &str) {
+  Poco::SHA1Engine engine;
+  engine.update(str);
+  return Poco::DigestEngine::digestToHex(engine.digest());
+}
+
+std::string sha1File(const std::string &file) {
+  std::ifstream in(file, std::ios::in | std::ios::binary);
+  if (!in) {
+    AIAA_LOG_ERROR("Failed to read: " << file);
+    throw exception(exception::SYSTEM_ERROR, ("Failed to read: " + file).c_str());
+  }
+
+  Poco::SHA1Engine engine;
+  std::vector<char> buffer(CACHE_READ_BLOCK_SIZE);
+  while (in) {
+    in.read(buffer.data(), buffer.size());
+    engine.update(buffer.data(), static_cast<unsigned>(in.gcount()));
+  }
+  return Poco::DigestEngine::digestToHex(engine.digest());
+}
+
+std::string tempName(const std::string &dir, const std::string &key) {
+  std::string uuid = Poco::UUIDGenerator::defaultGenerator().createRandom().toString();
+  return Poco::Path(dir, key + "." + uuid + CACHE_TEMP_EXTENSION).toString();
+}
+
+}
+
+ResultCache::ResultCache(const std::string &dir, size_t maxSize)
+    :
+    cacheDir(Poco::Path(dir).absolute().toString()),
+    maxSizeInBytes(maxSize) {
+  try {
+    Poco::File(cacheDir).createDirectories();
+  } catch (Poco::Exception &e) {
+    AIAA_LOG_ERROR(e.displayText());
+    throw exception(exception::SYSTEM_ERROR, e.displayText().c_str());
+  }
+}
+
+std::string ResultCache::key(const std::string &serverUri, const std::string &api, const Model &model, const std::string &params,
+                             const std::string &inputImageFile) {
+  std::string normalizedParams;
+  try {
+    // dump() of parsed json has sorted keys and compact separators
+    normalizedParams = nlohmann::json::parse(params.empty() ? "{}" : params).dump();
+  } catch (nlohmann::json::parse_error &e) {
+    AIAA_LOG_ERROR(e.what());
+    throw exception(exception::INVALID_ARGS_ERROR, e.what());
+  }
+
+  std::stringstream ss;
+  ss << serverUri << '\n' << api << '\n' << model.name << '\n' << model.version << '\n' << sha1File(inputImageFile) << '\n' << normalizedParams;
+  return sha1(ss.str());
+}
+
+bool ResultCache::get(const std::string &key, const std::string &outputImageFile, std::string &response) const {
+  std::string responseFile = Poco::Path(cacheDir, key + CACHE_RESPONSE_EXTENSION).toString();
+  std::string imageFile = Poco::Path(cacheDir, key + CACHE_IMAGE_EXTENSION).toString();
+
+  try {
+    // Response file is committed last; so an entry is valid only if it exists
+    Poco::File r(responseFile);
+    if (!r.exists()) {
+      return false;
+    }
+
+    if (!outputImageFile.empty()) {
+      Poco::File i(imageFile);
+      if (!i.exists()) {
+        return false;
+      }
+
+      // copy to (unique) temp in the same directory + rename; so that output is never partially written
+      Poco::Path tmpOutputPath(Poco::Path(outputImageFile).absolute().parent());
+      tmpOutputPath.setFileName(Poco::Path(Utils::tempfilename()).getFileName() + CACHE_TEMP_EXTENSION);
+      Poco::File tmpOutputFile(tmpOutputPath);
+      try {
+        i.copyTo(tmpOutputFile.path());
+        tmpOutputFile.renameTo(outputImageFile);
+      } catch (Poco::Exception&) {
+        if (tmpOutputFile.exists()) {
+          tmpOutputFile.remove();
+        }
+        throw;
+      }
+      i.setLastModified(Poco::Timestamp());
+    }
+
+    std::ifstream in(responseFile, std::ios::in | std::ios::binary);
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    if (!in) {
+      return false;
+    }
+
+    response = buffer.str();
+    r.setLastModified(Poco::Timestamp());
+  } catch (Poco::Exception &e) {
+    // Entry might have been evicted by some other process
+    AIAA_LOG_DEBUG("Cache Miss: " << key << " => " << e.displayText());
+    return false;
+  }
+
+  AIAA_LOG_DEBUG("Cache Hit: " << key);
+  return true;
+}
+
+void ResultCache::put(const std::string &key, const std::string &outputImageFile, const std::string &response) const {
+  std::string responseFile = Poco::Path(cacheDir, key + CACHE_RESPONSE_EXTENSION).toString();
+  std::string imageFile = Poco::Path(cacheDir, key + CACHE_IMAGE_EXTENSION).toString();
+
+  try {
+    if (!outputImageFile.empty()) {
+      std::string tmpImageFile = tempName(cacheDir, key);
+      Poco::File(outputImageFile).copyTo(tmpImageFile);
+      Poco::File(tmpImageFile).renameTo(imageFile);
+    } else if (Poco::File(imageFile).exists()) {
+      // Entry without result image; never serve an image of an older entry
+      Poco::File(imageFile).remove();
+    }
+
+    // Response file commits the entry; so it is renamed only if fully written (e.g. not on a full disk)
+    std::string tmpResponseFile = tempName(cacheDir, key);
+    std::ofstream out(tmpResponseFile, std::ios::out | std::ios::binary | std::ios::trunc);
+    out.write(response.c_str(), response.size());
+    out.close();
+    if (!out.good()) {
+      AIAA_LOG_WARN("Failed to write cache entry: " << tmpResponseFile);
+      Poco::File tmp(tmpResponseFile);
+      if (tmp.exists()) {
+        tmp.remove();
+      }
+      return;
+    }
+    Poco::File(tmpResponseFile).renameTo(responseFile);
+
+    AIAA_LOG_DEBUG("Cache Added: " << key);
+  } catch (Poco::Exception &e) {
+    // Failing to cache is not fatal for the actual request
+    AIAA_LOG_WARN("Failed to add cache entry: " << e.displayText());
+    return;
+  }
+
+  evict();
+}
+
+void ResultCache::clear() const {
+  Poco::NamedMutex mutex("aiaa-cache-" + sha1(cacheDir).substr(0, 16));
+  Poco::NamedMutex::ScopedLock lock(mutex);
+
+  try {
+    for (Poco::DirectoryIterator it(cacheDir), end; it != end; ++it) {
+      Poco::File(it->path()).remove();
+    }
+  } catch (Poco::Exception &e) {
+    AIAA_LOG_WARN("Failed to clear cache: " << e.displayText());
+  }
+}
+
+void ResultCache::evict() const {
+  struct Entry {
+    Poco::Timestamp lastUsed;
+    size_t size = 0;
+    std::vector<std::string> files;
+  };
+
+  // Only one process evicts at a time; readers are safe as they treat a missing file as cache miss
+  Poco::NamedMutex mutex("aiaa-cache-" + sha1(cacheDir).substr(0, 16));
+  Poco::NamedMutex::ScopedLock lock(mutex);
+
+  try {
+    std::map<std::string, Entry> entries;
+    size_t totalSize = 0;
+
+    for (Poco::DirectoryIterator it(cacheDir), end; it != end; ++it) {
+      std::string name = it.name();
+      if (name.find(CACHE_TEMP_EXTENSION) != std::string::npos) {
+        // Left over by a process which died while writing
+        if (it->getLastModified().isElapsed(CACHE_STALE_TEMP_IN_SEC * Poco::Timestamp::resolution())) {
+          Poco::File(it->path()).remove();
+        }
+        continue;
+      }
+
+      Entry &e = entries[name.substr(0, name.find('.'))];
+      e.size += static_cast<size_t>(it->getSize());
+      e.files.push_back(it->path());
+      if (e.files.size() == 1 || e.lastUsed < it->getLastModified()) {
+        e.lastUsed = it->getLastModified();
+      }
+      totalSize += static_cast<size_t>(it->getSize());
+    }
+
+    if (totalSize <= maxSizeInBytes) {
+      return;
+    }
+
+    std::vector<const Entry*> lru;
+    for (auto &e : entries) {
+      lru.push_back(&e.second);
+    }
+    std::sort(lru.begin(), lru.end(), [](const Entry *a, const Entry *b) {
+      return a->lastUsed < b->lastUsed;
+    });
+
+    for (auto e : lru) {
+      if (totalSize <= maxSizeInBytes) {
+        break;
+      }
+
+      // Remove response first; so that the entry becomes invalid before the image is gone
+      std::vector<std::string> files = e->files;
+      std::sort(files.begin(), files.end(), [](const std::string &a, const std::string &b) {
+        return a.find(CACHE_RESPONSE_EXTENSION) != std::string::npos && b.find(CACHE_RESPONSE_EXTENSION) == std::string::npos;
+      });
+      for (auto &f : files) {
+        Poco::File(f).remove();
+      }
+
+      totalSize -= e->size;
+      AIAA_LOG_DEBUG("Cache Evicted: " << files[0] << "; Size: " << e->size);
+    }
+  } catch (Poco::Exception &e) {
+    AIAA_LOG_WARN("Failed to evict cache entries: " << e.displayText());
+  }
+}
+
+}
+}
@@ -30,9 +30,13 @@
 #include "../include/nvidia/aiaa/log.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cstdio>
+#include <exception>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
 namespace nvidia {
 namespace aiaa {
@@ -66,6 +70,44 @@ std::vector<std::string> Utils::split(const std::string &str, char delim) {
   return strings;
 }
 
+void Utils::parallelFor(size_t n, const std::function<void(size_t)> &func, int threads) {
+  if (threads <= 0) {
+    threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  }
+  threads = static_cast<int>(std::min(static_cast<size_t>(threads), n));
+
+  std::atomic<size_t> next(0);
+  std::exception_ptr error;
+  std::mutex errorMutex;
+
+  auto worker = [&]() {
+    for (size_t i = next++; i < n; i = next++) {
+      try {
+        func(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+    }
+  };
+
+  // Current thread is one of the workers
+  std::vector<std::thread> workers;
+  for (int t = 1; t < threads; t++) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto &w : workers) {
+    w.join();
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
 Point Utils::stringToPoint(const std::string &str, char delim) {
   std::vector<std::string> pstr = split(str, delim);
   Point point;
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Tests use assert; keep them enabled in Release builds
+#undef NDEBUG
+
+#include <nvidia/aiaa/client.h>
+#include <nvidia/aiaa/resultcache.h>
+#include <nvidia/aiaa/utils.h>
+#include <nvidia/aiaa/exception.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cassert>
+
+// Offline tests; nothing listens on these servers (requests which are not served from cache fail)
+const std::string SERVER_URI_1 = "http://127.0.0.1:1";
+const std::string SERVER_URI_2 = "http://127.0.0.1:2";
+
+std::string writeFile(const std::string &content) {
+  std::string fileName = nvidia::aiaa::Utils::tempfilename();
+  std::ofstream out(fileName, std::ios::out | std::ios::binary);
+  out << content;
+  return fileName;
+}
+
+std::string readFile(const std::string &fileName) {
+  std::ifstream in(fileName, std::ios::in | std::ios::binary);
+  std::stringstream ss;
+  ss << in.rdbuf();
+  return ss.str();
+}
+
+nvidia::aiaa::Model cacheModel() {
+  nvidia::aiaa::Model model;
+  model.name = "segmentation_ct_spleen";
+  model.version = "1";
+  return model;
+}
+
+void testResultCacheKey() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  std::string image = writeFile("image-1");
+  std::string sameImage = writeFile("image-1");
+  std::string otherImage = writeFile("image-2");
+  nvidia::aiaa::Model model = cacheModel();
+
+  // Params are normalized (key order and whitespace); image is identified by content and not by name
+  std::string k = nvidia::aiaa::ResultCache::key(SERVER_URI_1, "inference", model, "{\"a\":1,\"b\":[1,2]}", image);
+  std::cout << "KEY: " << k << std::endl;
+  assert(k == nvidia::aiaa::ResultCache::key(SERVER_URI_1, "inference", model, " { \"b\" : [1, 2], \"a\" : 1 } ", sameImage));
+  assert(nvidia::aiaa::ResultCache::key(SERVER_URI_1, "inference", model, "", image)
+      == nvidia::aiaa::ResultCache::key(SERVER_URI_1, "inference", model, "{}", image));
+
+  // Server, api, model (version), params and image content are part of the key
+  nvidia::aiaa::Model otherVersion = model;
+  otherVersion.version = "2";
+  std::set<std::string> keys = { k };
+  keys.insert(nvidia::aiaa::ResultCache::key(SERVER_URI_2, "inference", model, "{\"a\":1,\"b\":[1,2]}", image));
+  keys.insert(nvidia::aiaa::ResultCache::key(SERVER_URI_1, "segmentation", model, "{\"a\":1,\"b\":[1,2]}", image));
+  keys.insert(nvidia::aiaa::ResultCache::key(SERVER_URI_1, "inference", otherVersion, "{\"a\":1,\"b\":[1,2]}", image));
+  keys.insert(nvidia::aiaa::ResultCache::key(SERVER_URI_1, "inference", model, "{\"a\":2,\"b\":[1,2]}", image));
+  keys.insert(nvidia::aiaa::ResultCache::key(SERVER_URI_1, "inference", model, "{\"a\":1,\"b\":[1,2]}", otherImage));
+  assert(keys.size() == 6);
+
+  try {
+    nvidia::aiaa::ResultCache::key(SERVER_URI_1, "inference", model, "{\"a\":", image);
+    assert(!"exception expected");
+  } catch (nvidia::aiaa::exception &e) {
+    assert(e.id == nvidia::aiaa::exception::INVALID_ARGS_ERROR);
+  }
+
+  std::remove(image.c_str());
+  std::remove(sameImage.c_str());
+  std::remove(otherImage.c_str());
+}
+
+void testResultCacheGetPut() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  nvidia::aiaa::ResultCache cache(nvidia::aiaa::Utils::tempfilename());
+  std::string result = writeFile("result-image");
+  std::string output = nvidia::aiaa::Utils::tempfilename();
+  std::string response;
+
+  assert(!cache.get("k1", output, response));
+
+  // Result image and response are restored
+  cache.put("k1", result, "{\"points\":[[1,2,3]]}");
+  assert(cache.get("k1", output, response));
+  assert(response == "{\"points\":[[1,2,3]]}");
+  assert(readFile(output) == "result-image");
+
+  // Entry without image (request produced none) is a miss if an image is needed; also for an entry which had one before
+  response.clear();
+  cache.put("k2", "", "{\"label\":\"spleen\"}");
+  assert(!cache.get("k2", output, response));
+  assert(cache.get("k2", "", response) && response == "{\"label\":\"spleen\"}");
+  cache.put("k1", "", "{}");
+  assert(!cache.get("k1", output, response));
+
+  cache.clear();
+  assert(!cache.get("k2", "", response));
+  std::remove(result.c_str());
+  std::remove(output.c_str());
+}
+
+void testResultCacheEviction() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  nvidia::aiaa::ResultCache cache(nvidia::aiaa::Utils::tempfilename(), 100);
+  const std::string response(40, ' ');
+  std::string r;
+
+  // Least recently used entry (b; a was looked up after it) is evicted once total size exceeds 100 bytes
+  cache.put("a", "", response);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  cache.put("b", "", response);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  assert(cache.get("a", "", r));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  cache.put("c", "", response);
+
+  assert(cache.get("a", "", r));
+  assert(!cache.get("b", "", r));
+  assert(cache.get("c", "", r));
+  cache.clear();
+}
+
+void testBatch() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  std::string cacheDir = nvidia::aiaa::Utils::tempfilename();
+  nvidia::aiaa::ResultCache cache(cacheDir);
+  nvidia::aiaa::Model model = cacheModel();
+  std::string result = writeFile("result-image");
+
+  // Jobs alternate over both servers (round robin); all but the last one are served from the cache of the assigned server
+  // Job 1 is an inference job without params (must not go to segmentation)
+  const std::vector<std::string> servers = { SERVER_URI_1, SERVER_URI_2 + "/" };
+  std::vector<nvidia::aiaa::BatchJob> jobs(5);
+  for (size_t i = 0; i < jobs.size(); i++) {
+    jobs[i].type = i % 3 == 1 ? nvidia::aiaa::BatchJob::INFERENCE : nvidia::aiaa::BatchJob::SEGMENTATION;
+    jobs[i].model = model;
+    jobs[i].params = i == 4 ? "{\"x\":1}" : "";
+    jobs[i].inputImageFile = writeFile("image-" + std::to_string(i));
+    jobs[i].outputImageFile = nvidia::aiaa::Utils::tempfilename();
+
+    if (i < 4) {
+      std::string server = i % 2 ? SERVER_URI_2 : SERVER_URI_1;
+      bool inference = jobs[i].type == nvidia::aiaa::BatchJob::INFERENCE;
+      std::string response = inference ? "{\"job\":" + std::to_string(i) + "}" : "{\"points\":[[" + std::to_string(i) + ",0,0]]}";
+      cache.put(nvidia::aiaa::ResultCache::key(server, inference ? "inference" : "segmentation", model, "{}", jobs[i].inputImageFile), result,
+                response);
+    }
+  }
+
+  nvidia::aiaa::Client client(SERVER_URI_1, 1);
+  client.setResultCache(cacheDir);
+
+  std::vector<int> completed(jobs.size(), 0);
+  auto results = client.batch(jobs, 2, [&](size_t i, const nvidia::aiaa::BatchResult &r) {
+    std::cout << "JOB " << i << ": " << (r.success ? "SUCCESS" : "FAILED") << " => " << r.response << r.points.toJson() << r.errorMessage
+              << std::endl;
+    completed[i]++;
+  }, servers);
+
+  assert(results.size() == jobs.size());
+  for (size_t i = 0; i < jobs.size(); i++) {
+    assert(completed[i] == 1);
+  }
+  assert(results[0].success && results[0].points.toJson() == "[[0,0,0]]");
+  assert(results[1].success && results[1].response == "{\"job\":1}");
+  assert(results[2].success && results[2].points.toJson() == "[[2,0,0]]");
+  assert(results[3].success && results[3].points.toJson() == "[[3,0,0]]");
+  assert(readFile(jobs[3].outputImageFile) == "result-image");
+
+  // Not cached; server is not reachable and the failure does not affect other jobs
+  assert(!results[4].success && results[4].errorId != 0);
+
+  for (auto &job : jobs) {
+    std::remove(job.inputImageFile.c_str());
+    std::remove(job.outputImageFile.c_str());
+  }
+  std::remove(result.c_str());
+  cache.clear();
+}
+
+int main(int argc, char **argv) {
+  testResultCacheKey();
+  testResultCacheGetPut();
+  testResultCacheEviction();
+  testBatch();
+  return 0;
+}
@@ -0,0 +1,537 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Tests use assert; keep them enabled in Release builds
+#undef NDEBUG
+
+#include <nvidia/aiaa/aiaautils.h>
+#include <nvidia/aiaa/exception.h>
+#include <nvidia/aiaa/imagecache.h>
+#include <nvidia/aiaa/niftidecoder.h>
+#include <nvidia/aiaa/pointset.h>
+#include <nvidia/aiaa/utils.h>
+
+#include <itkIdentityTransform.h>
+#include <itkImage.h>
+#include <itkImageFileReader.h>
+#include <itkLinearInterpolateImageFunction.h>
+#include <itkRegionOfInterestImageFilter.h>
+#include <itkResampleImageFilter.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <cassert>
+
+using MaskImageType = itk::Image<unsigned char, 3>;
+using IntensityImageType = itk::Image<short, 3>;
+
+MaskImageType::Pointer createMask(unsigned int sx, unsigned int sy, unsigned int sz) {
+  MaskImageType::RegionType region;
+  region.SetSize(0, sx);
+  region.SetSize(1, sy);
+  region.SetSize(2, sz);
+
+  auto image = MaskImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+  image->FillBuffer(0);
+  return image;
+}
+
+void fillBox(MaskImageType::Pointer image, int x0, int x1, int y0, int y1, int z0, int z1, unsigned char value) {
+  for (int z = z0; z <= z1; z++) {
+    for (int y = y0; y <= y1; y++) {
+      for (int x = x0; x <= x1; x++) {
+        image->SetPixel( { { x, y, z } }, value);
+      }
+    }
+  }
+}
+
+MaskImageType::Pointer readMask(const std::string &fileName) {
+  auto reader = itk::ImageFileReader<MaskImageType>::New();
+  reader->SetFileName(fileName);
+  reader->Update();
+  return reader->GetOutput();
+}
+
+size_t foreground(MaskImageType::Pointer image) {
+  size_t count = 0;
+  const unsigned char *buffer = image->GetBufferPointer();
+  for (size_t i = 0; i < image->GetPixelContainer()->Size(); i++) {
+    count += buffer[i] != 0;
+  }
+  return count;
+}
+
+unsigned char pixel(MaskImageType::Pointer image, int x, int y, int z) {
+  return image->GetPixel( { { x, y, z } });
+}
+
+// "U" spanning all slices (its two columns are only connected at the bottom, so labels from different slabs have to be
+// merged; more than one slab as soon as there is more than one core), a cube with an enclosed hole and a small island
+const size_t U_SIZE = 2 * 16 * 48 + 12 * 4 * 2 - 2 * 16 * 2;
+const size_t CUBE_SIZE = 8 * 8 * 8 - 2 * 2 * 2;
+const size_t ISLAND_SIZE = 4;
+
+MaskImageType::Pointer componentsMask() {
+  auto image = createMask(32, 32, 48);
+  fillBox(image, 2, 5, 2, 5, 0, 47, 1);
+  fillBox(image, 10, 13, 2, 5, 0, 47, 1);
+  fillBox(image, 2, 13, 2, 5, 0, 1, 1);
+
+  fillBox(image, 20, 27, 20, 27, 10, 17, 1);
+  fillBox(image, 23, 24, 23, 24, 13, 14, 0);
+
+  fillBox(image, 2, 3, 20, 21, 30, 30, 1);
+  return image;
+}
+
+MaskImageType::Pointer componentFilter(int keepLargest, int minSize, bool fillHoles) {
+  std::string inputFile = nvidia::aiaa::Utils::tempfilename() + ".nii.gz";
+  std::string outputFile = nvidia::aiaa::Utils::tempfilename() + ".nii.gz";
+
+  auto input = componentsMask();
+  assert(foreground(input) == U_SIZE + CUBE_SIZE + ISLAND_SIZE);
+  nvidia::aiaa::AiaaUtils::imageWrite(input, inputFile);
+  nvidia::aiaa::AiaaUtils::imageComponentFilter(inputFile, outputFile, keepLargest, minSize, fillHoles);
+
+  auto output = readMask(outputFile);
+  std::remove(inputFile.c_str());
+  std::remove(outputFile.c_str());
+  return output;
+}
+
+void testComponentFilterMinSize() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  auto output = componentFilter(0, 10, false);
+
+  // Island is removed; hole stays as it is
+  std::cout << "FOREGROUND (minSize): " << foreground(output) << std::endl;
+  assert(foreground(output) == U_SIZE + CUBE_SIZE);
+  assert(pixel(output, 2, 20, 30) == 0);
+  assert(pixel(output, 23, 23, 13) == 0);
+  assert(pixel(output, 20, 20, 10) == 1);
+}
+
+void testComponentFilterKeepLargest() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  auto output = componentFilter(1, 0, false);
+
+  // Both columns of the "U" (top slices) belong to the largest component
+  std::cout << "FOREGROUND (keepLargest): " << foreground(output) << std::endl;
+  assert(foreground(output) == U_SIZE);
+  assert(pixel(output, 2, 2, 47) == 1);
+  assert(pixel(output, 13, 5, 47) == 1);
+  assert(pixel(output, 20, 20, 10) == 0);
+  assert(pixel(output, 2, 20, 30) == 0);
+}
+
+void testComponentFilterFillHoles() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  auto output = componentFilter(0, 0, true);
+
+  // Enclosed hole is filled; open space between columns of the "U" is not a hole
+  std::cout << "FOREGROUND (fillHoles): " << foreground(output) << std::endl;
+  assert(foreground(output) == U_SIZE + CUBE_SIZE + 8 + ISLAND_SIZE);
+  assert(pixel(output, 23, 23, 13) == 1);
+  assert(pixel(output, 24, 24, 14) == 1);
+  assert(pixel(output, 7, 3, 20) == 0);
+}
+
+// Previous pre-processing path: crop (RegionOfInterestImageFilter) and then resample crop to roi size (ResampleImageFilter, linear)
+IntensityImageType::Pointer cropAndResample(IntensityImageType::Pointer image, const nvidia::aiaa::ImageInfo &imageInfo,
+                                            const IntensityImageType::SizeType &roiSize) {
+  IntensityImageType::IndexType cropIndex;
+  IntensityImageType::SizeType cropSize;
+  for (unsigned int i = 0; i < 3; i++) {
+    cropIndex[i] = imageInfo.cropIndex[i];
+    cropSize[i] = imageInfo.cropSize[i];
+  }
+
+  auto cropFilter = itk::RegionOfInterestImageFilter<IntensityImageType, IntensityImageType>::New();
+  cropFilter->SetInput(image);
+  cropFilter->SetRegionOfInterest(IntensityImageType::RegionType(cropIndex, cropSize));
+  cropFilter->Update();
+  IntensityImageType::Pointer cropped = cropFilter->GetOutput();
+
+  IntensityImageType::SpacingType spacing;
+  for (unsigned int i = 0; i < 3; i++) {
+    spacing[i] = cropped->GetSpacing()[i] * (static_cast<double>(cropSize[i]) / static_cast<double>(roiSize[i]));
+  }
+
+  auto filter = itk::ResampleImageFilter<IntensityImageType, IntensityImageType>::New();
+  filter->SetInput(cropped);
+  filter->SetSize(roiSize);
+  filter->SetOutputSpacing(spacing);
+  filter->SetTransform(itk::IdentityTransform<double, 3>::New());
+  filter->SetOutputOrigin(cropped->GetOrigin());
+  filter->SetOutputDirection(cropped->GetDirection());
+  filter->SetInterpolator(itk::LinearInterpolateImageFunction<IntensityImageType, double>::New());
+  filter->UpdateLargestPossibleRegion();
+  return filter->GetOutput();
+}
+
+void testPreProcessCropResize() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  IntensityImageType::RegionType region;
+  region.SetSize(0, 64);
+  region.SetSize(1, 48);
+  region.SetSize(2, 40);
+
+  // Anisotropic synthetic volume with gradients and sharp steps
+  auto image = IntensityImageType::New();
+  image->SetRegions(region);
+  IntensityImageType::SpacingType spacing;
+  spacing[0] = 0.8;
+  spacing[1] = 1.1;
+  spacing[2] = 2.5;
+  image->SetSpacing(spacing);
+
+  IntensityImageType::PointType origin;
+  origin[0] = -30.5;
+  origin[1] = 12.25;
+  origin[2] = 100;
+  image->SetOrigin(origin);
+  image->Allocate();
+  for (int z = 0; z < 40; z++) {
+    for (int y = 0; y < 48; y++) {
+      for (int x = 0; x < 64; x++) {
+        image->SetPixel( { { x, y, z } }, static_cast<short>((x * 37 + y * 23 + z * 11 + (x * y) % 17 * 5) % 1200 - 200));
+      }
+    }
+  }
+
+  std::string inputFile = nvidia::aiaa::Utils::tempfilename() + ".nii.gz";
+  std::string outputFile = nvidia::aiaa::Utils::tempfilename() + ".nii.gz";
+  nvidia::aiaa::AiaaUtils::imageWrite(image, inputFile);
+
+  // Down sampled along X/Y and up sampled along Z
+  nvidia::aiaa::PointSet pointSet = nvidia::aiaa::PointSet::fromJson(
+      "[[10,20,15],[50,22,18],[30,5,17],[32,40,16],[28,21,3],[31,24,35]]");
+  nvidia::aiaa::Point roi = { 24, 20, 48 };
+  nvidia::aiaa::ImageInfo imageInfo;
+  nvidia::aiaa::PointSet pointSetROI = nvidia::aiaa::AiaaUtils::imagePreProcess(pointSet, inputFile, outputFile, imageInfo, 10, roi);
+  std::cout << "ImageInfo: " << imageInfo.dump() << std::endl;
+  std::cout << "PointSetROI: " << pointSetROI.toJson() << std::endl;
+
+  // Reference runs on the image as stored (NIfTI keeps geometry in float)
+  auto reader = itk::ImageFileReader<IntensityImageType>::New();
+  reader->SetFileName(inputFile);
+  reader->Update();
+  IntensityImageType::Pointer input = reader->GetOutput();
+
+  IntensityImageType::SizeType roiSize;
+  for (unsigned int i = 0; i < 3; i++) {
+    roiSize[i] = roi[i];
+  }
+  IntensityImageType::Pointer expected = cropAndResample(input, imageInfo, roiSize);
+
+  reader = itk::ImageFileReader<IntensityImageType>::New();
+  reader->SetFileName(outputFile);
+  reader->Update();
+  IntensityImageType::Pointer actual = reader->GetOutput();
+  std::remove(inputFile.c_str());
+  std::remove(outputFile.c_str());
+
+  assert(actual->GetLargestPossibleRegion().GetSize() == roiSize);
+  for (unsigned int i = 0; i < 3; i++) {
+    assert(std::fabs(actual->GetSpacing()[i] - expected->GetSpacing()[i]) < 1e-4);
+    assert(std::fabs(actual->GetOrigin()[i] - expected->GetOrigin()[i]) < 1e-4);
+  }
+
+  // Fused pass interpolates in float (separable), ResampleImageFilter in double; both truncate to short
+  const short *a = actual->GetBufferPointer();
+  const short *e = expected->GetBufferPointer();
+  int maxDiff = 0;
+  for (size_t i = 0; i < expected->GetPixelContainer()->Size(); i++) {
+    maxDiff = std::max(maxDiff, std::abs(a[i] - e[i]));
+  }
+  std::cout << "Max Abs Difference: " << maxDiff << std::endl;
+  assert(maxDiff <= 1);
+
+  // Points map to the same index within resampled image as before
+  assert(pointSetROI.size() == pointSet.size());
+  for (size_t p = 0; p < pointSet.size(); p++) {
+    IntensityImageType::IndexType index;
+    for (unsigned int i = 0; i < 3; i++) {
+      index[i] = pointSet.points[p][i];
+    }
+
+    IntensityImageType::PointType point;
+    input->TransformIndexToPhysicalPoint(index, point);
+    expected->TransformPhysicalPointToIndex(point, index);
+    for (unsigned int i = 0; i < 3; i++) {
+      assert(pointSetROI.points[p][i] == index[i]);
+    }
+  }
+}
+
+// Tiles of 12 voxels along x (overlap 8) over an image of 20x8x8 start at x = 0, 4, 8; tile results are filled with 3, 1, 1
+MaskImageType::Pointer stitch(nvidia::aiaa::AiaaUtils::TileStitching stitching) {
+  std::string inputFile = nvidia::aiaa::Utils::tempfilename() + ".nii.gz";
+  std::string outputFile = nvidia::aiaa::Utils::tempfilename() + ".nii.gz";
+  nvidia::aiaa::AiaaUtils::imageWrite(createMask(20, 8, 8), inputFile);
+
+  std::vector<nvidia::aiaa::ImageInfo> tiles = nvidia::aiaa::AiaaUtils::imageTiles(inputFile, { 12, 8, 8 }, 8);
+  assert(tiles.size() == 3);
+  assert(tiles[0].cropIndex[0] == 0 && tiles[1].cropIndex[0] == 4 && tiles[2].cropIndex[0] == 8);
+
+  const unsigned char values[] = { 3, 1, 1 };
+  std::vector<std::string> tileFiles;
+  for (size_t t = 0; t < tiles.size(); t++) {
+    auto tile = createMask(12, 8, 8);
+    tile->FillBuffer(values[t]);
+    tileFiles.push_back(nvidia::aiaa::Utils::tempfilename() + ".nii.gz");
+    nvidia::aiaa::AiaaUtils::imageWrite(tile, tileFiles.back());
+  }
+
+  nvidia::aiaa::AiaaUtils::imageTileStitch(tileFiles, tiles, outputFile, stitching);
+  auto output = readMask(outputFile);
+
+  std::remove(inputFile.c_str());
+  std::remove(outputFile.c_str());
+  for (auto &f : tileFiles) {
+    std::remove(f.c_str());
+  }
+  return output;
+}
+
+void testStitchMajority() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  auto output = stitch(nvidia::aiaa::AiaaUtils::STITCH_MAJORITY);
+
+  // x=2: {3}; x=5: {3,1} tie resolved to larger label; x=9: {3,1,1} all three tiles vote; x=14: {1,1}
+  std::cout << "STITCH (majority): " << (int) pixel(output, 2, 0, 0) << ", " << (int) pixel(output, 5, 0, 0) << ", "
+            << (int) pixel(output, 9, 0, 0) << ", " << (int) pixel(output, 14, 0, 0) << std::endl;
+  assert(output->GetLargestPossibleRegion().GetSize()[0] == 20);
+  assert(pixel(output, 2, 4, 4) == 3);
+  assert(pixel(output, 5, 4, 4) == 3);
+  assert(pixel(output, 9, 4, 4) == 1);
+  assert(pixel(output, 11, 7, 7) == 1);
+  assert(pixel(output, 14, 0, 0) == 1);
+  assert(pixel(output, 19, 7, 7) == 1);
+}
+
+void testStitchMaxAndCenter() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  auto output = stitch(nvidia::aiaa::AiaaUtils::STITCH_MAX_PROBABILITY);
+  assert(pixel(output, 9, 4, 4) == 3);
+  assert(pixel(output, 12, 4, 4) == 1);
+
+  // Tile centers are at x = 6, 10, 14
+  output = stitch(nvidia::aiaa::AiaaUtils::STITCH_CENTER_CROP);
+  assert(pixel(output, 7, 4, 4) == 3);
+  assert(pixel(output, 9, 4, 4) == 1);
+}
+
+void testStitchIncompleteGrid() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  std::string tileFile = nvidia::aiaa::Utils::tempfilename() + ".nii.gz";
+  std::string outputFile = nvidia::aiaa::Utils::tempfilename() + ".nii.gz";
+  nvidia::aiaa::AiaaUtils::imageWrite(createMask(12, 12, 8), tileFile);
+
+  // 2x2 grid (x, y = 0, 8) over 20x20x8 with one tile missing; and a single tile not covering the whole image
+  std::vector<nvidia::aiaa::ImageInfo> tiles(3);
+  for (size_t t = 0; t < tiles.size(); t++) {
+    tiles[t].imageSize = { { 20, 20, 8, 0 } };
+    tiles[t].cropSize = { { 12, 12, 8, 0 } };
+    tiles[t].cropIndex = { { t == 1 ? 8 : 0, t == 2 ? 8 : 0, 0, 0 } };
+  }
+
+  for (size_t n : { tiles.size(), static_cast<size_t>(1) }) {
+    std::vector<nvidia::aiaa::ImageInfo> subset(tiles.begin(), tiles.begin() + n);
+    bool thrown = false;
+    try {
+      nvidia::aiaa::AiaaUtils::imageTileStitch(std::vector<std::string>(n, tileFile), subset, outputFile,
+                                               nvidia::aiaa::AiaaUtils::STITCH_MAJORITY);
+    } catch (nvidia::aiaa::exception &e) {
+      std::cout << "ERROR (" << n << " tiles): " << e.what() << std::endl;
+      thrown = e.id == nvidia::aiaa::exception::INVALID_ARGS_ERROR;
+    }
+    assert(thrown);
+  }
+
+  std::remove(tileFile.c_str());
+  std::remove(outputFile.c_str());
+}
+
+// Image with distinct voxel values and non-trivial geometry
+IntensityImageType::Pointer createIntensity(unsigned int sx, unsigned int sy, unsigned int sz) {
+  IntensityImageType::RegionType region;
+  region.SetSize(0, sx);
+  region.SetSize(1, sy);
+  region.SetSize(2, sz);
+
+  auto image = IntensityImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+  IntensityImageType::SpacingType spacing;
+  IntensityImageType::PointType origin;
+  for (unsigned int i = 0; i < 3; i++) {
+    spacing[i] = 0.5 + i;
+    origin[i] = -10.0 * (i + 1);
+  }
+  image->SetSpacing(spacing);
+  image->SetOrigin(origin);
+
+  short *buffer = image->GetBufferPointer();
+  for (size_t i = 0; i < image->GetPixelContainer()->Size(); i++) {
+    buffer[i] = static_cast<short>((i * 37) % 2000 - 1000);
+  }
+  return image;
+}
+
+// Feeds file bytes in chunks of chunkSize to the decoder and returns the image it publishes into the cache
+IntensityImageType::Pointer streamDecode(const std::string &fileName, size_t chunkSize, size_t limit = std::string::npos) {
+  std::ifstream in(fileName, std::ios::binary);
+  std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  data = data.substr(0, limit);
+
+  nvidia::aiaa::NiftiStreamDecoder decoder;
+  for (size_t i = 0; i < data.size(); i += chunkSize) {
+    decoder.write(data.data() + i, std::min(chunkSize, data.size() - i));
+  }
+  if (!decoder.publish(fileName)) {
+    return nullptr;
+  }
+
+  auto cached = nvidia::aiaa::ImageCache::instance().get(nvidia::aiaa::ImageCache::key<IntensityImageType>(fileName));
+  return dynamic_cast<IntensityImageType*>(cached.GetPointer());
+}
+
+void testNiftiStreamDecoder() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  auto &cache = nvidia::aiaa::ImageCache::instance();
+  const size_t maxSize = cache.getMaxSize();
+  cache.setMaxSize(64 * 1024 * 1024);
+
+  for (std::string ext : { ".nii.gz", ".nii" }) {
+    std::string fileName = nvidia::aiaa::Utils::tempfilename() + ext;
+    nvidia::aiaa::AiaaUtils::imageWrite(createIntensity(33, 21, 7), fileName);
+
+    auto reader = itk::ImageFileReader<IntensityImageType>::New();
+    reader->SetFileName(fileName);
+    reader->Update();
+    IntensityImageType::Pointer expected = reader->GetOutput();
+    const size_t count = expected->GetPixelContainer()->Size();
+
+    // Decoded image (any chunking) is same as image read from file: voxels and geometry
+    for (size_t chunkSize : { 1, 7, 4096, 1 << 30 }) {
+      cache.erase(fileName);
+      auto image = streamDecode(fileName, chunkSize);
+      std::cout << "STREAM DECODE (" << ext << "; chunk: " << chunkSize << "): " << (image ? "published" : "failed") << std::endl;
+      assert(image);
+      assert(image->GetLargestPossibleRegion() == expected->GetLargestPossibleRegion());
+      assert(image->GetSpacing() == expected->GetSpacing());
+      assert(image->GetOrigin() == expected->GetOrigin());
+      assert(image->GetDirection() == expected->GetDirection());
+      assert(std::equal(image->GetBufferPointer(), image->GetBufferPointer() + count, expected->GetBufferPointer()));
+    }
+
+    // Truncated stream is never published
+    cache.erase(fileName);
+    assert(!streamDecode(fileName, 4096, ext == ".nii" ? 352 + count : 100));
+    assert(cache.get(nvidia::aiaa::ImageCache::key<IntensityImageType>(fileName)).IsNull());
+
+    // Nothing is decoded if the cache is disabled
+    cache.setMaxSize(0);
+    assert(!streamDecode(fileName, 4096));
+    cache.setMaxSize(64 * 1024 * 1024);
+
+    cache.erase(fileName);
+    std::remove(fileName.c_str());
+  }
+
+  cache.setMaxSize(maxSize);
+}
+
+void testImageCache() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  auto &cache = nvidia::aiaa::ImageCache::instance();
+  const size_t maxSize = cache.getMaxSize();
+  cache.setMaxSize(100);
+
+  auto a = createMask(1, 1, 1), b = createMask(1, 1, 1), c = createMask(1, 1, 1);
+  cache.put("a.nii|1|10|h", a.GetPointer(), 40);
+  cache.put("b.nii|1|10|h", b.GetPointer(), 40);
+  assert(cache.get("a.nii|1|10|h").GetPointer() == a.GetPointer());
+  assert(cache.get("b.nii|1|10|h").GetPointer() == b.GetPointer());
+  assert(cache.get("a.nii|2|10|h").IsNull());
+
+  // Least recently used (b; a was looked up last) is evicted once max size is exceeded
+  cache.get("a.nii|1|10|h");
+  cache.put("c.nii|1|10|h", c.GetPointer(), 40);
+  assert(cache.get("b.nii|1|10|h").IsNull());
+  assert(cache.get("a.nii|1|10|h").IsNotNull());
+  assert(cache.get("c.nii|1|10|h").IsNotNull());
+
+  // Images larger than the cache are not stored; put with same key replaces the entry
+  cache.put("b.nii|1|10|h", b.GetPointer(), 101);
+  assert(cache.get("b.nii|1|10|h").IsNull());
+  cache.put("c.nii|1|10|h", b.GetPointer(), 40);
+  assert(cache.get("c.nii|1|10|h").GetPointer() == b.GetPointer());
+  assert(cache.get("a.nii|1|10|h").IsNotNull());
+
+  // Erase drops every version/pixel type of the file only
+  cache.put("a.nii|1|10|t", b.GetPointer(), 10);
+  cache.put("a.nii.gz|1|10|h", b.GetPointer(), 10);
+  cache.erase("a.nii");
+  assert(cache.get("a.nii|1|10|h").IsNull());
+  assert(cache.get("a.nii|1|10|t").IsNull());
+  assert(cache.get("a.nii.gz|1|10|h").IsNotNull());
+  assert(cache.get("c.nii|1|10|h").IsNotNull());
+
+  // Shrinking max size evicts; 0 disables the cache
+  cache.setMaxSize(0);
+  assert(cache.get("c.nii|1|10|h").IsNull());
+  cache.put("c.nii|1|10|h", c.GetPointer(), 1);
+  assert(cache.get("c.nii|1|10|h").IsNull());
+
+  cache.setMaxSize(maxSize);
+}
+
+int main() {
+  testComponentFilterMinSize();
+  testComponentFilterKeepLargest();
+  testComponentFilterFillHoles();
+  testPreProcessCropResize();
+  testStitchMajority();
+  testStitchMaxAndCenter();
+  testStitchIncompleteGrid();
+  testNiftiStreamDecoder();
+  testImageCache();
+  return 0;
+}
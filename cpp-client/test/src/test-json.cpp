@@ -26,13 +26,31 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+// Tests use assert; keep them enabled in Release builds
+#undef NDEBUG
+
 #include <nvidia/aiaa/client.h>
+#include <nvidia/aiaa/jsonwriter.h>
 #include <iostream>
+#include <limits>
 #include <vector>
 #include <cassert>
 
 const std::string SERVER_URI = "http://10.110.45.66:5000/v1";
 
+// Asserts that f throws nvidia::aiaa::exception with given id
+template<class F>
+void assertError(F f, nvidia::aiaa::exception::errorType id) {
+  try {
+    f();
+  } catch (nvidia::aiaa::exception &e) {
+    std::cout << "Expected Error: nvidia.aiaa.error." << e.id << " => " << e.what() << std::endl;
+    assert(e.id == id);
+    return;
+  }
+  assert(!"exception expected");
+}
+
 void testJsonModelList() {
   std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
   std::string json =
@@ -42,17 +60,59 @@ void testJsonModelList() {
 
   std::cout << "MODEL-LIST (raw ): " << json << std::endl;
   std::cout << "MODEL-LIST (json): " << modelList.toJson() << std::endl;
-  assert(json == modelList.toJson());
+  assert(modelList.size() == 3);
+  assert(modelList.models[1].name == "Dextr3DLiver");
+  assert(modelList.models[1].internal_name == "Dextr3dCroppedEngine");
+  assert(modelList.models[1].labels == std::set<std::string> { "liver" });
+
+  // toJson also emits type/version; so compare after a round trip
+  std::string roundTrip = nvidia::aiaa::ModelList::fromJson(modelList.toJson()).toJson();
+  assert(roundTrip == modelList.toJson());
+}
+
+void testJsonModel() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  std::string json =
+      "{\"name\":\"spleen\",\"labels\":\"spleen\",\"type\":\"annotation\",\"roi\":96,\"padding\":10.5,"
+      "\"extra\":{\"name\":\"ignored\",\"labels\":[\"ignored\"],\"nested\":[1,[2,{\"roi\":[3]}],null,true]},\"version\":\"2\"}";
+  nvidia::aiaa::Model model = nvidia::aiaa::Model::fromJson(json);
+
+  std::cout << "MODEL (raw ): " << json << std::endl;
+  std::cout << "MODEL (json): " << model.toJson() << std::endl;
+  assert(model.name == "spleen");
+  assert(model.labels == std::set<std::string> { "spleen" });
+  assert(model.type == nvidia::aiaa::Model::annotation);
+  assert(model.roi == std::vector<int>({ 96, 96, 96, 96 }));
+  assert(model.padding == 10.5);
+  assert(model.version == "2");
+
+  assertError([] {nvidia::aiaa::Model::fromJson("{\"labels\":[\"liver\"]}");}, nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
+  assertError([] {nvidia::aiaa::Model::fromJson("[]");}, nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
+  assertError([] {nvidia::aiaa::ModelList::fromJson("[{\"name\":\"a\"}");}, nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
+  assertError([] {nvidia::aiaa::ModelList::fromJson("[[{\"name\":\"a\"}]]");}, nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
 }
 
 void testJsonPointSet() {
   std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
   std::string json = "[[70,172,86],[105,161,180],[125,147,164],[56,174,124],[91,119,143],[77,219,120]]";
-  nvidia::aiaa::Point3DSet pointSet = nvidia::aiaa::Point3DSet::fromJson(json);
+  nvidia::aiaa::PointSet pointSet = nvidia::aiaa::PointSet::fromJson(json);
 
   std::cout << "3D-POINT SET (raw ): " << json << std::endl;
   std::cout << "3D-POINT SET (json): " << pointSet.toJson() << std::endl;
   assert(json == pointSet.toJson());
+
+  // Only value of top level key is selected; nested values (even with same key) are skipped
+  json = "{\"other\":[[1,2]],\"nested\":{\"points\":[[9,9]],\"x\":[[[8]]]},\"points\":[[1,2,3],null,[4,5,6]],\"s\":\"v\",\"b\":false}";
+  pointSet = nvidia::aiaa::PointSet::fromJson(json, "points");
+  std::cout << "3D-POINT SET (key ): " << pointSet.toJson() << std::endl;
+  assert(pointSet.toJson() == "[[1,2,3],[4,5,6]]");
+  assert(nvidia::aiaa::PointSet::fromJson(json, "missing").empty());
+
+  assertError([] {nvidia::aiaa::PointSet::fromJson("[[[1,2]]]");}, nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
+  assertError([] {nvidia::aiaa::PointSet::fromJson("[1,2]");}, nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
+  assertError([] {nvidia::aiaa::PointSet::fromJson("[[1,\"2\"]]");}, nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
+  assertError([] {nvidia::aiaa::PointSet::fromJson("[[1,2],[3,4]");}, nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
+  assertError([] {nvidia::aiaa::PointSet::fromJson("");}, nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
 }
 
 void testJsonPolygons() {
@@ -64,6 +124,14 @@ void testJsonPolygons() {
   std::cout << "POLYGONS (raw ): " << json << std::endl;
   std::cout << "POLYGONS (json): " << polygons.toJson() << std::endl;
   assert(json == polygons.toJson());
+
+  polygons = nvidia::aiaa::Polygons::fromJson("{\"poly\":[[[1,2],[3,4]],null,[]],\"meta\":{\"poly\":[]}}", "poly");
+  std::cout << "POLYGONS (key ): " << polygons.toJson() << std::endl;
+  assert(polygons.toJson() == "[[[1,2],[3,4]],[],[]]");
+
+  assertError([] {nvidia::aiaa::Polygons::fromJson("[[1,2]]");}, nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
+  assertError([] {nvidia::aiaa::Polygons::fromJson("[[[[1,2]]]]");}, nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
+  assertError([] {nvidia::aiaa::Polygons::fromJson("[[[1,2],]]");}, nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
 }
 
 void testJsonPolygonsList() {
@@ -75,12 +143,175 @@ void testJsonPolygonsList() {
   std::cout << "POLYGONS-LIST (raw ): " << json << std::endl;
   std::cout << "POLYGONS-LIST (json): " << polygonsList.toJson() << std::endl;
   assert(json == polygonsList.toJson());
+
+  polygonsList = nvidia::aiaa::PolygonsList::fromJson("[null,[[[1,2]]],[null]]");
+  std::cout << "POLYGONS-LIST (null): " << polygonsList.toJson() << std::endl;
+  assert(polygonsList.toJson() == "[[],[[[1,2]]],[[]]]");
+
+  assertError([] {nvidia::aiaa::PolygonsList::fromJson("[[[1,2]]]");}, nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
+  assertError([] {nvidia::aiaa::PolygonsList::fromJson("[[[[null]]]]");}, nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
+  assertError([] {nvidia::aiaa::PolygonsList::fromJson("[[[[1,2]]]] x");}, nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
+}
+
+// Every truncated prefix of binary data must be rejected
+template<class T>
+void assertTruncated(const std::string &data) {
+  for (size_t i = 0; i < data.size(); i++) {
+    try {
+      T::fromBinary(data.substr(0, i));
+    } catch (nvidia::aiaa::exception &e) {
+      assert(e.id == nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
+      continue;
+    }
+    assert(!"truncated binary array accepted");
+  }
+}
+
+void testBinaryPointSet() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  std::string json = "[[70,172,86],[105,161,180],[-125,147,164],[56,0,124],[91,119,-2147483648],[77,2147483647,120]]";
+  nvidia::aiaa::PointSet pointSet = nvidia::aiaa::PointSet::fromJson(json);
+  std::string data = pointSet.toBinary();
+
+  std::cout << "3D-POINT SET (json  ): " << json.size() << " bytes" << std::endl;
+  std::cout << "3D-POINT SET (binary): " << data.size() << " bytes" << std::endl;
+  assert(nvidia::aiaa::PointSet::fromBinary(data).toJson() == json);
+  assertTruncated<nvidia::aiaa::PointSet>(data);
+
+  // Ragged points
+  pointSet = nvidia::aiaa::PointSet::fromJson("[[1,2],[3,4,5],[6,7,8,9]]");
+  assert(nvidia::aiaa::PointSet::fromBinary(pointSet.toBinary()).toJson() == pointSet.toJson());
+  assertTruncated<nvidia::aiaa::PointSet>(pointSet.toBinary());
+  assert(nvidia::aiaa::PointSet::fromBinary(nvidia::aiaa::PointSet().toBinary()).empty());
+}
+
+void testBinaryPolygons() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  std::string json = "[[[69,167],[73,156],[78,146],[87,137]],[],[[1,2]],[[-5,-6],[0,0],[5,6]]]";
+  nvidia::aiaa::Polygons polygons = nvidia::aiaa::Polygons::fromJson(json);
+  std::string data = polygons.toBinary();
+
+  assert(nvidia::aiaa::Polygons::fromBinary(data).toJson() == json);
+  assertTruncated<nvidia::aiaa::Polygons>(data);
+
+  assertError([&] {nvidia::aiaa::Polygons::fromBinary(data + '\0');}, nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
+  assertError([&] {nvidia::aiaa::PolygonsList::fromBinary(data);}, nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
+  assertError([] {nvidia::aiaa::Polygons::fromBinary("[[[1,2]]]");}, nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
+}
+
+void testBinaryPolygonsList() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  std::string json = "[[],[[[69,167],[73,156],[78,146]],[[1,2],[3,4]]],[[]],[[[10,20],[30,40],[50,60]]]]";
+  nvidia::aiaa::PolygonsList polygonsList = nvidia::aiaa::PolygonsList::fromJson(json);
+  std::string data = polygonsList.toBinary();
+
+  assert(nvidia::aiaa::PolygonsList::fromBinary(data).toJson() == json);
+  assertTruncated<nvidia::aiaa::PolygonsList>(data);
+
+  // Header with huge dims (varint 0xFFFFFFFF) must be rejected before anything is allocated
+  std::string hugeDims = data.substr(0, 6) + "\xFF\xFF\xFF\xFF\x0F" + data.substr(7);
+  assertError([&] {nvidia::aiaa::PolygonsList::fromBinary(hugeDims);}, nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
+
+  // Corrupt offset table
+  std::string corrupt = data;
+  corrupt[8] = static_cast<char>(corrupt[8] + 1);
+  assertError([&] {nvidia::aiaa::PolygonsList::fromBinary(corrupt);}, nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
+}
+
+void testFlatPolygonsList() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  std::string json = "[[],[[[69,167],[73,156],[78,146]],[[1,2],[3,4]]],[[]],[[[-10,20],[30,-40],[50,60]]]]";
+  nvidia::aiaa::PolygonsList polygonsList = nvidia::aiaa::PolygonsList::fromJson(json);
+
+  // PolygonsList <=> FlatPolygonsList round trip
+  nvidia::aiaa::FlatPolygonsList flat = nvidia::aiaa::FlatPolygonsList::fromPolygonsList(polygonsList);
+  std::cout << "FLAT-POLYGONS-LIST (json): " << flat.toJson() << std::endl;
+  assert(flat.size() == 4 && flat.polygons(1) == 2 && flat.polygons(2) == 1 && flat.vertices() == 8);
+  assert(flat.toJson() == json);
+  assert(flat.toPolygonsList().toJson() == json);
+  assert(flat.toPolygons(1).toJson() == polygonsList.list[1].toJson());
+  assert(nvidia::aiaa::FlatPolygonsList::fromJson(json).toJson() == json);
+  assert(nvidia::aiaa::FlatPolygonsList::fromJson("{\"poly\":" + json + "}", "poly").toJson() == json);
+
+  // Binary is compatible with PolygonsList in both directions
+  assert(flat.toBinary() == polygonsList.toBinary());
+  assert(nvidia::aiaa::FlatPolygonsList::fromBinary(polygonsList.toBinary()).toJson() == json);
+  assertTruncated<nvidia::aiaa::FlatPolygonsList>(flat.toBinary());
+
+  // Iterators
+  nvidia::aiaa::FlatPolygonsList::PolygonView view = flat.polygon(3, 0);
+  std::vector<int> coords;
+  for (const int *v : view) {
+    coords.insert(coords.end(), v, v + flat.dims);
+  }
+  assert(coords == std::vector<int>({ -10, 20, 30, -40, 50, 60 }));
+
+  // flipXY and findFirstNonMatching
+  nvidia::aiaa::FlatPolygonsList flipped = flat;
+  flipped.flipXY();
+  polygonsList.flipXY();
+  assert(flipped.toJson() == polygonsList.toJson());
+  int polyIndex = -1, vertexIndex = -1;
+  assert(!flat.findFirstNonMatching(1, flat, polyIndex, vertexIndex));
+  assert(flat.findFirstNonMatching(1, flipped, polyIndex, vertexIndex) && polyIndex == 0 && vertexIndex == 0);
+
+  // append
+  nvidia::aiaa::FlatPolygonsList appended = nvidia::aiaa::FlatPolygonsList::fromJson("[[[[5,5]]]]");
+  appended.append(flat);
+  assert(appended.toJson() == "[[[[5,5]]]," + json.substr(1));
+
+  // Empty, null and ragged vertices are rejected (instead of being zero padded)
+  nvidia::aiaa::PolygonsList ragged = nvidia::aiaa::PolygonsList::fromJson("[[[[1,2],[3,4,5]]]]");
+  assertError([&] {nvidia::aiaa::FlatPolygonsList::fromPolygonsList(ragged);}, nvidia::aiaa::exception::INVALID_ARGS_ERROR);
+  ragged = nvidia::aiaa::PolygonsList::fromJson("[[[[1,2],[]]]]");
+  assertError([&] {nvidia::aiaa::FlatPolygonsList::fromPolygonsList(ragged);}, nvidia::aiaa::exception::INVALID_ARGS_ERROR);
+  assertError([] {nvidia::aiaa::FlatPolygonsList::fromJson("[[[[1,2],null]]]");}, nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
+  assertError([] {nvidia::aiaa::FlatPolygonsList::fromJson("[[[[1,2],[3]]]]");}, nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
+  assertError([] {nvidia::aiaa::FlatPolygonsList::fromJson("[[[[1,2,3]]]]");}, nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
+  assertError([&] {nvidia::aiaa::FlatPolygonsList::fromBinary(ragged.toBinary());}, nvidia::aiaa::exception::RESPONSE_PARSE_ERROR);
+
+  // Contours traced into flat storage are same as Polygons::fromMask
+  const int width = 7, height = 5;
+  const unsigned char mask[width * height] = {
+      0, 0, 0, 0, 0, 0, 0,
+      0, 1, 1, 1, 0, 0, 1,
+      0, 1, 0, 1, 0, 0, 1,
+      0, 1, 1, 1, 0, 1, 0,
+      0, 0, 0, 0, 0, 0, 0 };
+  nvidia::aiaa::FlatPolygonsList traced;
+  traced.addSlice(mask, width, height);
+  assert(traced.toPolygons(0).toJson() == nvidia::aiaa::Polygons::fromMask(mask, width, height).toJson());
+}
+
+void testJsonWriter() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+
+  // Keys are escaped same as string values
+  nvidia::aiaa::JsonWriter writer;
+  writer.beginObject().key("a\"b\\c\n").value("x\"y").key("tab\t").value(1).endObject();
+  std::cout << "JSON (keys): " << writer.str() << std::endl;
+  assert(writer.str() == "{\"a\\\"b\\\\c\\n\":\"x\\\"y\",\"tab\\t\":1}");
+
+  // Non-finite numbers are written as null
+  nvidia::aiaa::JsonWriter numbers;
+  numbers.beginArray();
+  numbers.value(0.5).value(std::numeric_limits<double>::quiet_NaN()).value(std::numeric_limits<double>::infinity());
+  numbers.value(-std::numeric_limits<double>::infinity()).value(-2.0);
+  numbers.endArray();
+  std::cout << "JSON (numbers): " << numbers.str() << std::endl;
+  assert(numbers.str() == "[0.5,null,null,null,-2]");
 }
 
 int main(int argc, char **argv) {
   testJsonModelList();
+  testJsonModel();
   testJsonPointSet();
   testJsonPolygons();
   testJsonPolygonsList();
+  testBinaryPointSet();
+  testBinaryPolygons();
+  testBinaryPolygonsList();
+  testFlatPolygonsList();
+  testJsonWriter();
   return 0;
 }
@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// Tests use assert; keep them enabled in Release builds
+#undef NDEBUG
+
+#include <nvidia/aiaa/polygon.h>
+#include <nvidia/aiaa/exception.h>
+#include <iostream>
+#include <vector>
+#include <cassert>
+
+// Deterministic pseudo random masks (blobs, lines and noise) of width x height
+std::vector<unsigned char> randomMask(int width, int height, unsigned int &seed) {
+  auto next = [&seed]() {
+    seed = seed * 1103515245u + 12345u;
+    return (seed >> 16) & 0x7FFF;
+  };
+
+  std::vector<unsigned char> mask(width * height, 0);
+  const int density = next() % 60;
+  for (auto &m : mask) {
+    m = static_cast<int>(next() % 100) < density ? 1 : 0;
+  }
+  return mask;
+}
+
+void testMaskToPolygonHole() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  const unsigned char mask[] = {
+      0, 0, 0, 0, 0,
+      0, 1, 1, 1, 0,
+      0, 1, 0, 1, 0,
+      0, 1, 1, 1, 0,
+      0, 0, 0, 0, 0 };
+  nvidia::aiaa::Polygons polygons = nvidia::aiaa::Polygons::fromMask(mask, 5, 5);
+
+  // Outer boundary and boundary around the hole; both as [y,x] of foreground pixels
+  std::cout << "POLYGONS (hole): " << polygons.toJson() << std::endl;
+  assert(polygons.toJson() == "[[[1,1],[2,1],[3,1],[3,2],[3,3],[2,3],[1,3],[1,2]],[[1,2],[2,3],[3,2],[2,1]]]");
+}
+
+void testMaskToPolygonDiagonal() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  const unsigned char mask[] = {
+      1, 0, 0,
+      0, 1, 0,
+      0, 0, 1 };
+  nvidia::aiaa::Polygons polygons = nvidia::aiaa::Polygons::fromMask(mask, 3, 3);
+
+  // Diagonal pixels are not connected; single pixel (also at image border) is a polygon of one vertex
+  std::cout << "POLYGONS (diagonal): " << polygons.toJson() << std::endl;
+  assert(polygons.toJson() == "[[[0,0]],[[1,1]],[[2,2]]]");
+}
+
+void testMaskToPolygonLine() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  const unsigned char mask[] = {
+      0, 0, 0, 0, 0, 0,
+      0, 1, 1, 1, 1, 0,
+      0, 0, 0, 0, 0, 0 };
+  nvidia::aiaa::Polygons polygons = nvidia::aiaa::Polygons::fromMask(mask, 6, 3);
+
+  // 1-pixel wide line is traced along both sides
+  std::cout << "POLYGONS (line): " << polygons.toJson() << std::endl;
+  assert(polygons.toJson() == "[[[1,1],[1,2],[1,3],[1,4],[1,3],[1,2]]]");
+
+  assert(nvidia::aiaa::Polygons::fromMask(mask, 0, 3).empty());
+  assert(nvidia::aiaa::Polygons::fromMask(nullptr, 6, 3).empty());
+}
+
+void testMaskToPolygonPointRatio() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  std::vector<unsigned char> mask(6 * 6, 0);
+  for (int y = 1; y < 5; y++) {
+    for (int x = 1; x < 5; x++) {
+      mask[y * 6 + x] = 1;
+    }
+  }
+
+  nvidia::aiaa::Polygons polygons = nvidia::aiaa::Polygons::fromMask(mask.data(), 6, 6);
+  std::cout << "POLYGONS (ratio 1): " << polygons.toJson() << std::endl;
+  assert(polygons.polys.size() == 1 && polygons.polys[0].size() == 12);
+
+  // Every 3rd vertex (starting with the first one)
+  polygons = nvidia::aiaa::Polygons::fromMask(mask.data(), 6, 6, 3);
+  std::cout << "POLYGONS (ratio 3): " << polygons.toJson() << std::endl;
+  assert(polygons.toJson() == "[[[1,1],[4,1],[4,4],[1,4]]]");
+
+  // pointRatio < 1 is same as 1
+  assert(nvidia::aiaa::Polygons::fromMask(mask.data(), 6, 6, 0).polys[0].size() == 12);
+}
+
+void testPolygonToMaskRoundTrip() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  unsigned int seed = 42;
+  size_t polygons = 0;
+  for (int i = 0; i < 2000; i++) {
+    const int width = 1 + i % 23, height = 1 + (i / 23) % 19;
+    std::vector<unsigned char> mask = randomMask(width, height, seed);
+    nvidia::aiaa::Polygons p = nvidia::aiaa::Polygons::fromMask(mask.data(), width, height);
+    polygons += p.size();
+
+    std::vector<unsigned char> result(mask.size(), 0);
+    p.toMask(result.data(), width, height);
+    assert(result == mask);
+  }
+  std::cout << "ROUND TRIP: 2000 masks; " << polygons << " polygons" << std::endl;
+}
+
+void testPolygonToMask() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  const unsigned char expected[] = {
+      0, 0, 0, 0, 0,
+      0, 3, 3, 3, 0,
+      0, 3, 0, 3, 0,
+      0, 3, 3, 3, 0,
+      0, 0, 0, 0, 0 };
+  nvidia::aiaa::Polygons polygons = nvidia::aiaa::Polygons::fromJson(
+      "[[[1,1],[2,1],[3,1],[3,2],[3,3],[2,3],[1,3],[1,2]],[[1,2],[2,3],[3,2],[2,1]]]");
+
+  // Hole is not filled (even-odd); only foreground pixels are written
+  std::vector<unsigned char> mask(25, 9);
+  polygons.toMask(mask.data(), 5, 5, 3);
+  for (size_t i = 0; i < mask.size(); i++) {
+    assert(mask[i] == (expected[i] ? 3 : 9));
+  }
+
+  // Polygon outside of mask is clipped
+  polygons = nvidia::aiaa::Polygons::fromJson("[[[-5,-5],[-5,10],[10,10],[10,-5]],[[100,100]]]");
+  mask.assign(16, 0);
+  polygons.toMask(mask.data(), 4, 4);
+  assert(mask == std::vector<unsigned char>(16, 1));
+
+  // 3D; slices beyond depth are ignored and slices without polygons are untouched
+  nvidia::aiaa::PolygonsList polygonsList = nvidia::aiaa::PolygonsList::fromJson("[[[[0,0]]],[],[[[1,1],[1,2]]],[[[0,0]]]]");
+  mask.assign(3 * 3 * 3, 0);
+  polygonsList.toMask(mask.data(), 3, 3, 3, 2);
+  const unsigned char expected3D[] = {
+      2, 0, 0, 0, 0, 0, 0, 0, 0,
+      0, 0, 0, 0, 0, 0, 0, 0, 0,
+      0, 0, 0, 0, 2, 2, 0, 0, 0 };
+  assert(mask == std::vector<unsigned char>(expected3D, expected3D + 27));
+}
+
+void testPolygonSimplify() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  std::vector<unsigned char> mask(12 * 10, 0);
+  for (int y = 2; y < 8; y++) {
+    for (int x = 1; x < 11; x++) {
+      mask[y * 12 + x] = 1;
+    }
+  }
+  const nvidia::aiaa::Polygons rectangle = nvidia::aiaa::Polygons::fromMask(mask.data(), 12, 10);
+  const std::string corners = "[[[2,1],[7,1],[7,10],[2,10]]]";
+
+  // Traced rectangle is reduced to its four corners (order and start vertex are kept)
+  nvidia::aiaa::Polygons polygons = rectangle;
+  polygons.simplify(0.5);
+  std::cout << "SIMPLIFY (DP): " << rectangle.polys[0].size() << " => " << polygons.toJson() << std::endl;
+  assert(polygons.toJson() == corners);
+
+  polygons = rectangle;
+  polygons.simplify(0.5, nvidia::aiaa::Polygons::SIMPLIFY_VISVALINGAM_WHYATT);
+  std::cout << "SIMPLIFY (VW): " << rectangle.polys[0].size() << " => " << polygons.toJson() << std::endl;
+  assert(polygons.toJson() == corners);
+
+  // Tolerance <= 0 keeps all vertices
+  polygons = rectangle;
+  polygons.simplify(0);
+  assert(polygons.toJson() == rectangle.toJson());
+
+  // At least 3 vertices are kept even if the polygon is (nearly) a line; smaller polygons are not touched
+  nvidia::aiaa::Polygons line = nvidia::aiaa::Polygons::fromJson("[[[0,0],[0,1],[0,2],[0,3],[1,3],[0,2],[0,1]],[[5,5],[6,6]],[[1,1]]]");
+  for (auto method : { nvidia::aiaa::Polygons::SIMPLIFY_DOUGLAS_PEUCKER, nvidia::aiaa::Polygons::SIMPLIFY_VISVALINGAM_WHYATT }) {
+    polygons = line;
+    polygons.simplify(100, method);
+    std::cout << "SIMPLIFY (min): " << polygons.toJson() << std::endl;
+    assert(polygons.polys[0].size() == 3);
+    assert(polygons.polys[1].size() == 2 && polygons.polys[2].size() == 1);
+  }
+
+  // Slices are simplified independently
+  nvidia::aiaa::PolygonsList polygonsList;
+  polygonsList.push_back(rectangle);
+  polygonsList.push_back(nvidia::aiaa::Polygons());
+  polygonsList.push_back(rectangle);
+  polygonsList.simplify(0.5);
+  assert(polygonsList.toJson() == "[" + corners + ",[]," + corners + "]");
+}
+
+// Fake fixPolygon: moves the edited vertex and re-traces the contour, which adds a vertex right after it (vertex count and
+// indices of all following vertices change)
+void fakeFixPolygon(nvidia::aiaa::Polygons &poly, const nvidia::aiaa::VertexEdit &edit) {
+  auto &polygon = poly.polys[edit.polyIndex];
+  auto &v = polygon[edit.vertexIndex];
+  v[0] += edit.vertexOffset[0];
+  v[1] += edit.vertexOffset[1];
+
+  const auto &next = polygon[(edit.vertexIndex + 1) % polygon.size()];
+  nvidia::aiaa::Polygons::Point mid = { (v[0] + next[0]) / 2, (v[1] + next[1]) / 2 };
+  polygon.insert(polygon.begin() + edit.vertexIndex + 1, mid);
+}
+
+void testVertexEditsSequential() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  nvidia::aiaa::Polygons poly = nvidia::aiaa::Polygons::fromJson("[[[0,0],[10,0],[10,10],[0,10]]]");
+  nvidia::aiaa::Polygons moved = nvidia::aiaa::Polygons::fromJson("[[[-2,-2],[10,0],[13,13],[0,10]]]");
+  std::vector<nvidia::aiaa::VertexEdit> edits = moved.diff(poly);
+  assert(edits.size() == 2);
+
+  // First edit inserts a vertex; second edit (vertex 2 before any edit) is vertex 3 afterwards
+  int requests = 0;
+  nvidia::aiaa::VertexEdit::applySequential(poly, edits, [&requests](nvidia::aiaa::Polygons &p, const nvidia::aiaa::VertexEdit &e) {
+    requests++;
+    fakeFixPolygon(p, e);
+  });
+
+  std::cout << "POLYGONS (sequential edits): " << poly.toJson() << std::endl;
+  assert(requests == 2);
+  assert(poly.toJson() == "[[[-2,-2],[4,-1],[10,0],[13,13],[6,11],[0,10]]]");
+
+  // Edits refer to polygons before the first edit; invalid one is rejected before anything is sent
+  nvidia::aiaa::VertexEdit invalid;
+  invalid.vertexIndex = 99;
+  edits.push_back(invalid);
+  try {
+    nvidia::aiaa::VertexEdit::applySequential(poly, edits, [](nvidia::aiaa::Polygons &p, const nvidia::aiaa::VertexEdit &e) {
+      assert(false);
+    });
+    assert(false);
+  } catch (nvidia::aiaa::exception &e) {
+    assert(e.id == nvidia::aiaa::exception::INVALID_ARGS_ERROR);
+  }
+}
+
+void testVertexEditsSequential3D() {
+  std::cout << "\n\n******************************** [" << __func__ << "] ********************************\n";
+  nvidia::aiaa::PolygonsList poly = nvidia::aiaa::PolygonsList::fromJson(
+      "[[[[0,0],[10,0],[10,10],[0,10]]],[[[5,5],[15,5],[15,15],[5,15]],[[20,20],[30,20],[30,30]]]]");
+  nvidia::aiaa::PolygonsList moved = nvidia::aiaa::PolygonsList::fromJson(
+      "[[[[0,0],[10,0],[10,10],[0,10]]],[[[4,4],[15,5],[15,15],[5,15]],[[20,20],[31,19],[30,30]]]]");
+  std::vector<nvidia::aiaa::VertexEdit> edits = moved.diff(poly);
+  assert(edits.size() == 2);
+
+  nvidia::aiaa::VertexEdit::applySequential(poly, edits, [](nvidia::aiaa::PolygonsList &p, const nvidia::aiaa::VertexEdit &e) {
+    assert(e.sliceIndex == 1);
+    fakeFixPolygon(p.list[e.sliceIndex], e);
+  });
+
+  std::cout << "POLYGONS (sequential edits 3D): " << poly.toJson() << std::endl;
+  assert(poly.list[0].toJson() == "[[[0,0],[10,0],[10,10],[0,10]]]");
+  assert(poly.list[1].toJson() == "[[[4,4],[9,4],[15,5],[15,15],[5,15]],[[20,20],[31,19],[30,24],[30,30]]]");
+}
+
+int main(int argc, char **argv) {
+  testMaskToPolygonHole();
+  testMaskToPolygonDiagonal();
+  testMaskToPolygonLine();
+  testMaskToPolygonPointRatio();
+  testPolygonToMaskRoundTrip();
+  testPolygonToMask();
+  testPolygonSimplify();
+  testVertexEditsSequential();
+  testVertexEditsSequential3D();
+  return 0;
+}
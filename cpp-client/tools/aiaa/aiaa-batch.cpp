@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <nvidia/aiaa/client.h>
+#include <nvidia/aiaa/utils.h>
+
+#include "../commonutils.h"
+#include <chrono>
+#include <map>
+
+int main(int argc, char **argv) {
+  if (argc < 2 || cmdOptionExists(argv, argv + argc, "-h")) {
+    std::cout << "Usage:: <COMMAND> <OPTIONS>\n"
+              "  |-h        (Help) Print this information                                                |\n"
+              "  |-server   Server URI(s); comma separated to spread jobs {default: http://0.0.0.0:5000} |\n"
+              " *|-model    Model Name                                                                   |\n"
+              "  |-inference Use inference API instead of segmentation                                   |\n"
+              "  |-params   Input Params (JSON) for inference API                                        |\n"
+              " *|-list     File containing list of input images (one per line)                          |\n"
+              " *|-output   Output Folder where Result masks are stored (same file name as input)        |\n"
+              "  |-threads  Number of parallel requests to each AIAA Server {default: 4}                 |\n"
+              "  |-cache    Result Cache Directory (re-use results for same model, image and params)     |\n"
+              "  |-timeout  Timeout In Seconds {default: 60}                                             |\n"
+              "  |-ts       Print API Latency                                                            |\n";
+    return 0;
+  }
+
+  std::string serverUri = getCmdOption(argv, argv + argc, "-server", "http://0.0.0.0:5000");
+  std::string model = getCmdOption(argv, argv + argc, "-model");
+
+  bool inference = cmdOptionExists(argv, argv + argc, "-inference") ? true : false;
+  std::string params = getCmdOption(argv, argv + argc, "-params");
+  std::string listFile = getCmdOption(argv, argv + argc, "-list");
+  std::string outputFolder = getCmdOption(argv, argv + argc, "-output");
+  std::string cacheDir = getCmdOption(argv, argv + argc, "-cache");
+
+  int threads = nvidia::aiaa::Utils::lexical_cast<int>(getCmdOption(argv, argv + argc, "-threads", "4"));
+  int timeout = nvidia::aiaa::Utils::lexical_cast<int>(getCmdOption(argv, argv + argc, "-timeout", "60"));
+  bool printTs = cmdOptionExists(argv, argv + argc, "-ts") ? true : false;
+
+  if (model.empty()) {
+    std::cerr << "Model is required\n";
+    return -1;
+  }
+  if (listFile.empty()) {
+    std::cerr << "Input Image list file is missing\n";
+    return -1;
+  }
+  if (outputFolder.empty()) {
+    std::cerr << "Output Folder is missing\n";
+    return -1;
+  }
+
+  try {
+    std::vector<std::string> serverUris = nvidia::aiaa::Utils::split(serverUri, ',');
+    nvidia::aiaa::Client client(serverUris[0], timeout);
+    client.setResultCache(cacheDir);
+
+    nvidia::aiaa::Model m;
+    m = client.model(model);
+
+    if (m.name.empty()) {
+      std::cerr << "Couldn't find a model for name: " << model << "\n";
+      return -1;
+    }
+
+    std::vector<nvidia::aiaa::BatchJob> jobs;
+    std::map<std::string, std::string> names;
+    std::istringstream images(fileToString(listFile));
+    std::string image;
+    while (std::getline(images, image)) {
+      if (image.empty()) {
+        continue;
+      }
+
+      // Result masks are stored by file name; same name from different folders would overwrite each other
+      std::string name = image.substr(image.find_last_of("/\\") + 1);
+      if (names.find(name) != names.end()) {
+        std::cerr << "Duplicate Input Image file name: " << name << " (" << names[name] << ", " << image << ")\n";
+        return -1;
+      }
+      names[name] = image;
+
+      nvidia::aiaa::BatchJob job;
+      job.type = inference ? nvidia::aiaa::BatchJob::INFERENCE : nvidia::aiaa::BatchJob::SEGMENTATION;
+      job.model = m;
+      job.params = params;
+      job.inputImageFile = image;
+      job.outputImageFile = outputFolder + "/" + name;
+      jobs.push_back(job);
+    }
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    auto results = client.batch(jobs, threads, [&](size_t i, const nvidia::aiaa::BatchResult &result) {
+      std::cout << (result.success ? "[SUCCESS] " : "[FAILED ] ") << jobs[i].inputImageFile;
+      if (!result.success) {
+        std::cout << " => nvidia.aiaa.error." << result.errorId << "; reason: " << result.errorMessage;
+      }
+      if (printTs) {
+        std::cout << " (" << result.latencyInMs << " ms)";
+      }
+      std::cout << std::endl;
+    }, serverUris);
+
+    auto end = std::chrono::high_resolution_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
+
+    size_t failed = 0;
+    for (auto &result : results) {
+      failed += result.success ? 0 : 1;
+    }
+    std::cout << "Total: " << results.size() << "; Failed: " << failed << std::endl;
+
+    if (printTs) {
+      std::cout << "API Latency (in milli sec): " << ms << std::endl;
+    }
+    return failed ? -1 : 0;
+  } catch (nvidia::aiaa::exception &e) {
+    std::cerr << "nvidia::aiaa::exception => nvidia.aiaa.error." << e.id << "; description: " << e.name() << "; reason: " << e.what() << std::endl;
+  }
+  return -1;
+}
@@ -46,6 +46,9 @@ int main(int argc, char **argv) {
               " *|-session  Session ID (crop should be false)                                            |\n"
               "  |-crop     PreProcess Input (crop) before sending it to AIAA                            |\n"
               " *|-output   Output Image File                                                            |\n"
+              "  |-largest  Keep only largest N connected components of result mask                      |\n"
+              "  |-islands  Remove islands (components) smaller than N voxels from result mask           |\n"
+              "  |-fillholes Fill holes (enclosed background) of result mask                             |\n"
               "  |-timeout  Timeout In Seconds {default: 60}                                             |\n"
               "  |-ts       Print API Latency                                                            |\n";
     return 0;
@@ -65,6 +68,10 @@ int main(int argc, char **argv) {
   std::string sessionId = getCmdOption(argv, argv + argc, "-session");
   std::string outputImageFile = getCmdOption(argv, argv + argc, "-output");
 
+  int largest = nvidia::aiaa::Utils::lexical_cast<int>(getCmdOption(argv, argv + argc, "-largest", "0"));
+  int islands = nvidia::aiaa::Utils::lexical_cast<int>(getCmdOption(argv, argv + argc, "-islands", "0"));
+  bool fillHoles = cmdOptionExists(argv, argv + argc, "-fillholes") ? true : false;
+
   int timeout = nvidia::aiaa::Utils::lexical_cast<int>(getCmdOption(argv, argv + argc, "-timeout", "60"));
   bool printTs = cmdOptionExists(argv, argv + argc, "-ts") ? true : false;
 
@@ -92,6 +99,7 @@ int main(int argc, char **argv) {
   try {
     nvidia::aiaa::PointSet pointSet = nvidia::aiaa::PointSet::fromJson(points);
     nvidia::aiaa::Client client(serverUri, timeout);
+    client.setResultCleanup(largest, islands, fillHoles);
 
     nvidia::aiaa::Model m;
     if (model.empty()) {
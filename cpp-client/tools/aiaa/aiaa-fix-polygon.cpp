@@ -48,6 +48,8 @@ int main(int argc, char **argv) {
               " *|-image        Input 2D Slice Image File                                                |\n"
               " *|-output       Output Image File                                                        |\n"
               "  |-format       Format Output Json                                                       |\n"
+              "  |-binary       Request compact binary polygons from server (JSON fallback)              |\n"
+              "  |-incremental  (3D) Send only slices within neighbor3d of sindex; merge result back     |\n"
               "  |-timeout      Timeout In Seconds {default: 60}                                         |\n"
               "  |-ts           Print API Latency                                                        |\n";
     return 0;
@@ -70,6 +72,8 @@ int main(int argc, char **argv) {
   std::string outputImageFile = getCmdOption(argv, argv + argc, "-output");
 
   int jsonSpace = cmdOptionExists(argv, argv + argc, "-format") ? 2 : 0;
+  bool binary = cmdOptionExists(argv, argv + argc, "-binary");
+  bool incremental = cmdOptionExists(argv, argv + argc, "-incremental");
   int timeout = nvidia::aiaa::Utils::lexical_cast<int>(getCmdOption(argv, argv + argc, "-timeout", "60"));
   bool printTs = cmdOptionExists(argv, argv + argc, "-ts") ? true : false;
 
@@ -98,8 +102,13 @@ int main(int argc, char **argv) {
 
     auto begin = std::chrono::high_resolution_clock::now();
     nvidia::aiaa::Client client(serverUri, timeout);
+    client.setBinaryPolygons(binary);
     if (dim == 2) {
       result2D = client.fixPolygon(poly2D, neighborhoodSize, polygonIndex, vertexIndex, vertexOffset, inputImageFile, outputImageFile);
+    } else if (incremental) {
+      client.fixPolygonIncremental(poly3D, neighborhoodSize, neighborhoodSize3D, sliceIndex, polygonIndex, vertexIndex, vertexOffset,
+                                   inputImageFile, outputImageFile);
+      result3D = poly3D;
     } else {
       result3D = client.fixPolygon(poly3D, neighborhoodSize, neighborhoodSize3D, sliceIndex, polygonIndex, vertexIndex, vertexOffset, inputImageFile,
                                    outputImageFile);
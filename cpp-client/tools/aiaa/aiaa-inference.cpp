@@ -42,6 +42,13 @@ int main(int argc, char **argv) {
               " *|-image    Input Image File                                                             |\n"
               " *|-session  Session ID                                                                   |\n"
               "  |-output   Output Image File                                                            |\n"
+              "  |-cache    Result Cache Directory (re-use results for same model, image and params)     |\n"
+              "  |-quantize Quantize Image to model's intensity window before upload (int16|uint8)       |\n"
+              "  |-rescale  Allow quantization which rescales intensities (server must de-quantize)      |\n"
+              "  |-tile     Run as overlapping tiles of size x,y,z (3D Image) {e.g. 128,128,128}         |\n"
+              "  |-overlap  Overlap (in voxels) between tiles {default: 16}                              |\n"
+              "  |-stitch   Stitching of overlapping tiles (majority|max|center) {default: majority}     |\n"
+              "  |-servers  Comma separated Server URIs to dispatch tiles {default: -server}             |\n"
               "  |-timeout  Timeout In Seconds {default: 60}                                             |\n"
               "  |-ts       Print API Latency                                                            |\n";
     return 0;
@@ -54,6 +61,13 @@ int main(int argc, char **argv) {
   std::string inputImageFile = getCmdOption(argv, argv + argc, "-image");
   std::string sessionId = getCmdOption(argv, argv + argc, "-session");
   std::string outputImageFile = getCmdOption(argv, argv + argc, "-output");
+  std::string cacheDir = getCmdOption(argv, argv + argc, "-cache");
+  std::string quantize = getCmdOption(argv, argv + argc, "-quantize");
+  bool rescale = cmdOptionExists(argv, argv + argc, "-rescale") ? true : false;
+  std::string tile = getCmdOption(argv, argv + argc, "-tile");
+  int overlap = nvidia::aiaa::Utils::lexical_cast<int>(getCmdOption(argv, argv + argc, "-overlap", "16"));
+  std::string stitch = getCmdOption(argv, argv + argc, "-stitch", "majority");
+  std::string servers = getCmdOption(argv, argv + argc, "-servers");
 
   int timeout = nvidia::aiaa::Utils::lexical_cast<int>(getCmdOption(argv, argv + argc, "-timeout", "60"));
   bool printTs = cmdOptionExists(argv, argv + argc, "-ts") ? true : false;
@@ -69,6 +83,12 @@ int main(int argc, char **argv) {
 
   try {
     nvidia::aiaa::Client client(serverUri, timeout);
+    client.setResultCache(cacheDir);
+    if (quantize == "int16") {
+      client.setUploadQuantization(nvidia::aiaa::AiaaUtils::QUANTIZE_INT16, rescale);
+    } else if (quantize == "uint8") {
+      client.setUploadQuantization(nvidia::aiaa::AiaaUtils::QUANTIZE_UINT8, rescale);
+    }
 
     nvidia::aiaa::Model m;
     m = client.model(model);
@@ -79,8 +99,26 @@ int main(int argc, char **argv) {
     }
 
     auto begin = std::chrono::high_resolution_clock::now();
-    std::string resultJson = client.inference(m, params, inputImageFile, outputImageFile, sessionId);
-    std::cout << "Result (JSON): " << resultJson << std::endl;
+    if (!tile.empty()) {
+      nvidia::aiaa::TileOptions options;
+      options.tileSize.clear();
+      for (auto &v : nvidia::aiaa::Utils::split(tile, ',')) {
+        options.tileSize.push_back(nvidia::aiaa::Utils::lexical_cast<int>(v));
+      }
+      options.tileSize.resize(3, options.tileSize.empty() ? 128 : options.tileSize.back());
+      options.overlap = overlap;
+      options.stitching = stitch == "max" ? nvidia::aiaa::AiaaUtils::STITCH_MAX_PROBABILITY :
+          stitch == "center" ? nvidia::aiaa::AiaaUtils::STITCH_CENTER_CROP : nvidia::aiaa::AiaaUtils::STITCH_MAJORITY;
+      options.serverUris = nvidia::aiaa::Utils::split(servers, ',');
+
+      std::vector<std::string> results = client.inferenceTiled(m, params, inputImageFile, outputImageFile, options);
+      for (size_t i = 0; i < results.size(); i++) {
+        std::cout << "Result (JSON) for Tile " << i << ": " << results[i] << std::endl;
+      }
+    } else {
+      std::string resultJson = client.inference(m, params, inputImageFile, outputImageFile, sessionId);
+      std::cout << "Result (JSON): " << resultJson << std::endl;
+    }
 
     auto end = std::chrono::high_resolution_clock::now();
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
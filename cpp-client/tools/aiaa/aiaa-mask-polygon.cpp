@@ -40,6 +40,10 @@ int main(int argc, char **argv) {
               " *|-image    Input Image File                                                             |\n"
               "  |-output   Output File Name to store result                                             |\n"
               "  |-format   Format Output Json                                                           |\n"
+              "  |-binary   Request compact binary polygons from server (JSON fallback)                  |\n"
+              "  |-local    Trace contours locally (no server call)                                      |\n"
+              "  |-simplify Simplify polygons with tolerance in pixels {default: 0 (disabled)}           |\n"
+              "  |-vw       Use Visvalingam-Whyatt instead of Douglas-Peucker for -simplify              |\n"
               "  |-timeout      Timeout In Seconds {default: 60}                                         |\n"
               "  |-ts       Print API Latency                                                            |\n";
     return 0;
@@ -50,6 +54,10 @@ int main(int argc, char **argv) {
   std::string inputImageFile = getCmdOption(argv, argv + argc, "-image");
   std::string outputJsonFile = getCmdOption(argv, argv + argc, "-output");
   int jsonSpace = cmdOptionExists(argv, argv + argc, "-format") ? 2 : 0;
+  bool binary = cmdOptionExists(argv, argv + argc, "-binary");
+  bool local = cmdOptionExists(argv, argv + argc, "-local");
+  double simplify = nvidia::aiaa::Utils::lexical_cast<double>(getCmdOption(argv, argv + argc, "-simplify", "0"));
+  bool vw = cmdOptionExists(argv, argv + argc, "-vw");
   int timeout = nvidia::aiaa::Utils::lexical_cast<int>(getCmdOption(argv, argv + argc, "-timeout", "60"));
   bool printTs = cmdOptionExists(argv, argv + argc, "-ts") ? true : false;
 
@@ -65,15 +73,20 @@ int main(int argc, char **argv) {
   try {
     auto begin = std::chrono::high_resolution_clock::now();
     nvidia::aiaa::Client client(serverUri, timeout);
-    nvidia::aiaa::PolygonsList result = client.maskToPolygon(ratio, inputImageFile);
+    client.setBinaryPolygons(binary);
+    client.setPolygonSimplification(
+        simplify, vw ? nvidia::aiaa::Polygons::SIMPLIFY_VISVALINGAM_WHYATT : nvidia::aiaa::Polygons::SIMPLIFY_DOUGLAS_PEUCKER);
+    // Without simplification result is only written as JSON; so it is kept in flat storage
+    std::string json = simplify > 0 ? client.maskToPolygon(ratio, inputImageFile, local).toJson(jsonSpace) :
+        client.maskToFlatPolygons(ratio, inputImageFile, local).toJson(jsonSpace);
 
     auto end = std::chrono::high_resolution_clock::now();
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
 
     if (outputJsonFile.empty()) {
-      std::cout << result.toJson(jsonSpace) << std::endl;
+      std::cout << json << std::endl;
     } else {
-      stringToFile(result.toJson(jsonSpace), outputJsonFile);
+      stringToFile(json, outputJsonFile);
     }
 
     if (printTs) {
@@ -42,6 +42,14 @@ int main(int argc, char **argv) {
               " *|-image    Input Image File                                                             |\n"
               " *|-session  Session ID                                                                   |\n"
               " *|-output   Output Image File                                                            |\n"
+              "  |-cache    Result Cache Directory (re-use results for same model, image and params)     |\n"
+              "  |-quantize Quantize Image to model's intensity window before upload (int16|uint8)       |\n"
+              "  |-rescale  Allow quantization which rescales intensities (server must de-quantize)      |\n"
+              "  |-slabs    Upload non .nii.gz Image by streaming N slabs {default: 0 (upload as is)}    |\n"
+              "  |-crop     Crop Image to foreground (voxels > threshold) before upload {e.g. -500}      |\n"
+              "  |-largest  Keep only largest N connected components of result mask                      |\n"
+              "  |-islands  Remove islands (components) smaller than N voxels from result mask           |\n"
+              "  |-fillholes Fill holes (enclosed background) of result mask                             |\n"
               "  |-timeout  Timeout In Seconds {default: 60}                                             |\n"
               "  |-ts       Print API Latency                                                            |\n";
     return 0;
@@ -55,6 +63,15 @@ int main(int argc, char **argv) {
   std::string inputImageFile = getCmdOption(argv, argv + argc, "-image");
   std::string sessionId = getCmdOption(argv, argv + argc, "-session");
   std::string outputImageFile = getCmdOption(argv, argv + argc, "-output");
+  std::string cacheDir = getCmdOption(argv, argv + argc, "-cache");
+  std::string quantize = getCmdOption(argv, argv + argc, "-quantize");
+  bool rescale = cmdOptionExists(argv, argv + argc, "-rescale") ? true : false;
+  int slabs = nvidia::aiaa::Utils::lexical_cast<int>(getCmdOption(argv, argv + argc, "-slabs", "0"));
+  std::string crop = getCmdOption(argv, argv + argc, "-crop");
+
+  int largest = nvidia::aiaa::Utils::lexical_cast<int>(getCmdOption(argv, argv + argc, "-largest", "0"));
+  int islands = nvidia::aiaa::Utils::lexical_cast<int>(getCmdOption(argv, argv + argc, "-islands", "0"));
+  bool fillHoles = cmdOptionExists(argv, argv + argc, "-fillholes") ? true : false;
 
   int timeout = nvidia::aiaa::Utils::lexical_cast<int>(getCmdOption(argv, argv + argc, "-timeout", "60"));
   bool printTs = cmdOptionExists(argv, argv + argc, "-ts") ? true : false;
@@ -74,6 +91,17 @@ int main(int argc, char **argv) {
 
   try {
     nvidia::aiaa::Client client(serverUri, timeout);
+    client.setResultCache(cacheDir);
+    client.setResultCleanup(largest, islands, fillHoles);
+    if (quantize == "int16") {
+      client.setUploadQuantization(nvidia::aiaa::AiaaUtils::QUANTIZE_INT16, rescale);
+    } else if (quantize == "uint8") {
+      client.setUploadQuantization(nvidia::aiaa::AiaaUtils::QUANTIZE_UINT8, rescale);
+    }
+    client.setUploadStreamDivisions(slabs > 0 ? slabs : 0);
+    if (!crop.empty()) {
+      client.setForegroundCrop(true, nvidia::aiaa::Utils::lexical_cast<double>(crop));
+    }
 
     nvidia::aiaa::Model m;
     if (model.empty()) {
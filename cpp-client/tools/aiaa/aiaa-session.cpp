@@ -41,6 +41,7 @@ int main(int argc, char **argv) {
               "  |-image    Input Image File in case of (create) operation                               |\n"
               "  |-expiry   Session expiry time in seconds (default: 0)                                  |\n"
               "  |-session  Session ID in case of (get|delete) operation                                 |\n"
+              "  |-slabs    Upload non .nii.gz Image by streaming N slabs {default: 0 (upload as is)}    |\n"
               "  |-timeout  Timeout In Seconds {default: 60}                                             |\n"
               "  |-ts       Print API Latency                                                            |\n";
     return 0;
@@ -52,6 +53,7 @@ int main(int argc, char **argv) {
   std::string inputImageFile = getCmdOption(argv, argv + argc, "-image");
   int expiry = nvidia::aiaa::Utils::lexical_cast<int>(getCmdOption(argv, argv + argc, "-expiry", "0"));
   std::string sessionId = getCmdOption(argv, argv + argc, "-session");
+  int slabs = nvidia::aiaa::Utils::lexical_cast<int>(getCmdOption(argv, argv + argc, "-slabs", "0"));
 
   int timeout = nvidia::aiaa::Utils::lexical_cast<int>(getCmdOption(argv, argv + argc, "-timeout", "60"));
   bool printTs = cmdOptionExists(argv, argv + argc, "-ts") ? true : false;
@@ -75,6 +77,7 @@ int main(int argc, char **argv) {
 
   try {
     nvidia::aiaa::Client client(serverUri, timeout);
+    client.setUploadStreamDivisions(slabs > 0 ? slabs : 0);
 
     auto begin = std::chrono::high_resolution_clock::now();
     if (operation == "create") {
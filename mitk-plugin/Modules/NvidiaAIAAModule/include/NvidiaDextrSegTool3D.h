@@ -57,6 +57,7 @@ public:
   const char **GetXPM() const override;
 
   void SetServerURI(const std::string &serverURI, const int serverTimeout, bool filterByLabel);
+  void SetProgressiveSegmentation(bool progressive);
   void GetModelInfo(std::map<std::string, std::string>& seg, std::map<std::string, std::string>& ann);
   void ClearPoints();
   void ConfirmPoints(const std::string &modelName);
@@ -74,6 +75,7 @@ private:
   int m_AIAAServerTimeout;
   nvidia::aiaa::ModelList m_AIAAModelList;
   std::string m_AIAACurrentModelName;
+  bool m_ProgressiveSegmentation;
 
   mitk::PointSet::Pointer m_PointSet;
   mitk::DataNode::Pointer m_PointSetNode;
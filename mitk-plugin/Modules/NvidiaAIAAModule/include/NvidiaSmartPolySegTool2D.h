@@ -67,7 +67,7 @@ protected:
   ~NvidiaSmartPolySegTool2D() override;
 
   std::string create2DSliceImage();
-  void displayResult(const std::string &tmpResultFileName);
+  void displayResult(const nvidia::aiaa::Polygons &polygons);
 
 private:
   std::string m_AIAAServerUri;
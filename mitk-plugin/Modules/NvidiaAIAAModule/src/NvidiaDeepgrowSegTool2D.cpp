@@ -42,13 +42,13 @@
 
 #include <itkExtractImageFilter.h>
 #include <itkImageFileReader.h>
-#include <itkImageFileWriter.h>
 #include <itkIntensityWindowingImageFilter.h>
 #include <itkPasteImageFilter.h>
 #include <itkAddImageFilter.h>
 
 #include <nvidia/aiaa/client.h>
 #include <nvidia/aiaa/utils.h>
+#include <nvidia/aiaa/aiaautils.h>
 #include <chrono>
 
 MITK_TOOL_MACRO(MITKNVIDIAAIAAMODULE_EXPORT, NvidiaDeepgrowSegTool2D, "NVIDIA Deepgrow Tool");
@@ -239,7 +239,7 @@ nvidia::aiaa::PointSet NvidiaDeepgrowSegTool2D::GetPointsForCurrentSlice(const n
   }
 
   nvidia::aiaa::PointSet filtered;
-  for (auto point : points.points) {
+  for (const auto &point : points.points) {
     if (point[2] == sliceIndex) {
       filtered.push_back(point);
     }
@@ -270,11 +270,7 @@ void NvidiaDeepgrowSegTool2D::ItkImageProcessRunDeepgrow(itk::Image<TPixel, VIma
     if (aiaaSessionId.empty()) {
       MITK_INFO("nvidia") << "(Deepgrow) Trying to add current image into AIAA session";
 
-      typedef itk::Image<TPixel, VImageDimension> ImageType;
-      auto writer = itk::ImageFileWriter<ImageType>::New();
-      writer->SetInput(itkImage);
-      writer->SetFileName(tmpInputFileName);
-      writer->Update();
+      nvidia::aiaa::AiaaUtils::imageWrite(itkImage, tmpInputFileName);
 
       aiaaSessionId = client.createSession(tmpInputFileName);
       m_AIAASessions[imageId] = aiaaSessionId;
@@ -39,7 +39,6 @@
 #include <itkConnectedComponentImageFilter.h>
 #include <itkConstantPadImageFilter.h>
 #include <itkImageFileReader.h>
-#include <itkImageFileWriter.h>
 #include <itkLabelShapeKeepNObjectsImageFilter.h>
 
 #include <itkResampleImageFilter.h>
@@ -86,7 +85,8 @@ MITK_TOOL_MACRO(MITKNVIDIAAIAAMODULE_EXPORT, NvidiaDextrSegTool3D, "NVIDIA Segme
     api_latency_ms = std::chrono::duration_cast < std::chrono::milliseconds > (api_end_time - api_start_time).count(); \
     MITK_INFO("nvidia") << "API Latency for aiaa::client::" << api << "() = " << api_latency_ms << " milli sec"; \
 
-NvidiaDextrSegTool3D::NvidiaDextrSegTool3D() {
+NvidiaDextrSegTool3D::NvidiaDextrSegTool3D()
+    : m_ProgressiveSegmentation(false) {
 }
 
 NvidiaDextrSegTool3D::~NvidiaDextrSegTool3D() {
@@ -162,6 +162,10 @@ void NvidiaDextrSegTool3D::Deactivated() {
   Superclass::Deactivated();
 }
 
+void NvidiaDextrSegTool3D::SetProgressiveSegmentation(bool progressive) {
+  m_ProgressiveSegmentation = progressive;
+}
+
 void NvidiaDextrSegTool3D::SetServerURI(const std::string &serverURI, const int serverTimeout, bool filterByLabel) {
   m_AIAAServerUri = serverURI;
   m_AIAAServerTimeout = serverTimeout;
@@ -255,7 +259,7 @@ void NvidiaDextrSegTool3D::addToPointSet(const nvidia::aiaa::PointSet& pointSet,
   using ImageType = itk::Image<TPixel, VImageDimension>;
 
   for (size_t i = 0; i < pointSet.size(); i++) {
-    nvidia::aiaa::Point pt = pointSet.points[i];
+    const nvidia::aiaa::Point &pt = pointSet.points[i];
 
     typename ImageType::IndexType index;
     for (unsigned int i = 0; i < VImageDimension; i++) {
@@ -365,7 +369,7 @@ nvidia::aiaa::PointSet imagePreProcess(const nvidia::aiaa::PointSet &pointSet, i
 
     typename ImageType::IndexType index;
     int pointCount = 0;
-    for (auto point : pointSet.points) {
+    for (const auto &point : pointSet.points) {
       pointCount++;
       for (unsigned int i = 0; i < VImageDimension; i++) {
         int vxPad = (int) (spacing[i] > 0 ? (PAD / spacing[i]) : PAD);
@@ -422,7 +426,8 @@ nvidia::aiaa::PointSet imagePreProcess(const nvidia::aiaa::PointSet &pointSet, i
 
     // Adjust extreme points index to cropped and resized image
     nvidia::aiaa::PointSet pointSetROI;
-    for (auto p : pointSet.points) {
+    pointSetROI.points.reserve(pointSet.size());
+    for (const auto &p : pointSet.points) {
       for (unsigned int i = 0; i < VImageDimension; i++) {
         index[i] = p[i];
       }
@@ -433,20 +438,17 @@ nvidia::aiaa::PointSet imagePreProcess(const nvidia::aiaa::PointSet &pointSet, i
       itkImage->TransformIndexToPhysicalPoint(index, point);
       resampledImage->TransformPhysicalPointToIndex(point, index);
 
-      nvidia::aiaa::Point pointROI;
+      nvidia::aiaa::PointN<VImageDimension> pointROI;
       for (unsigned int i = 0; i < VImageDimension; i++) {
-        pointROI.push_back(index[i]);
+        pointROI[i] = index[i];
       }
-      pointSetROI.points.push_back(pointROI);
+      pointSetROI.push_back(pointROI);
     }
 
     MITK_DEBUG("nvidia") << "PointSetROI: " << pointSetROI.toJson();
 
     // Write the ROI image out to temp folder
-    auto writer = itk::ImageFileWriter<ImageType>::New();
-    writer->SetInput(resampledImage);
-    writer->SetFileName(outputImage);
-    writer->Update();
+    nvidia::aiaa::AiaaUtils::imageWrite(resampledImage, outputImage);
 
     return pointSetROI;
   } catch (itk::ExceptionObject& e) {
@@ -511,19 +513,26 @@ void NvidiaDextrSegTool3D::ItkImageProcessAutoSegmentation(itk::Image<TPixel, VI
 
     // Write the image out to temp folder
     LATENCY_START_API_CALL()
-    typedef itk::Image<TPixel, VImageDimension> ImageType;
-    auto writer = itk::ImageFileWriter<ImageType>::New();
-    writer->SetInput(itkImage);
-    writer->SetFileName(tmpSampleFileName);
-    writer->Update();
+    nvidia::aiaa::AiaaUtils::imageWrite(itkImage, tmpSampleFileName);
 
     currentSteps++;
     mitk::ProgressBar::GetInstance()->Progress(1);
     LATENCY_END_API_CALL("sampling")
 
     // Call Inference
+    // Progressive (opt-in): coarse mask is displayed first and later replaced by refined one
     LATENCY_START_API_CALL()
-    nvidia::aiaa::PointSet extremePoints = client.segmentation(model, tmpSampleFileName, tmpResultFileName);
+    nvidia::aiaa::PointSet extremePoints;
+    if (m_ProgressiveSegmentation) {
+      extremePoints = client.segmentationProgressive(
+          model, tmpSampleFileName, tmpResultFileName, [this, &tmpResultFileName](const nvidia::aiaa::PointSet &coarsePoints) {
+            MITK_INFO("nvidia") << "Coarse Segmentation PointSet: " << coarsePoints.toJson();
+            displayResult<TPixel, VImageDimension>(tmpResultFileName);
+            mitk::RenderingManager::GetInstance()->ForceImmediateUpdateAll();
+          });
+    } else {
+      extremePoints = client.segmentation(model, tmpSampleFileName, tmpResultFileName);
+    }
     MITK_INFO("nvidia") << "Segmentation PointSet for [" << labelName << "]: " << extremePoints.toJson();
 
     currentSteps++;
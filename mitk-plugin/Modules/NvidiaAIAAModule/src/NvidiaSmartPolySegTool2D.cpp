@@ -38,7 +38,6 @@
 #include <mitkToolManager.h>
 
 #include <itkExtractImageFilter.h>
-#include <itkImageFileReader.h>
 #include <itkImageFileWriter.h>
 #include <itkIntensityWindowingImageFilter.h>
 #include <itkPasteImageFilter.h>
@@ -46,6 +45,7 @@
 #include <nvidia/aiaa/client.h>
 #include <nvidia/aiaa/utils.h>
 #include <chrono>
+#include <utility>
 
 MITK_TOOL_MACRO(MITKNVIDIAAIAAMODULE_EXPORT, NvidiaSmartPolySegTool2D, "NVIDIA SmartPoly Tool");
 
@@ -289,35 +289,31 @@ void NvidiaSmartPolySegTool2D::PolygonFix() {
   MITK_INFO("nvidia") << "PolygonsNew: " << polygonsNew.toJson();
   MITK_INFO("nvidia") << "PolygonsOld: " << polygonsOld.toJson();
 
-  int polyIndex = -1;
-  int vertexIndex = -1;
-  if (!polygonsNew.findFirstNonMatching(polygonsOld, polyIndex, vertexIndex)) {
+  // All vertices moved since last update are sent (one request per vertex unless batched edits are enabled on client)
+  std::vector<nvidia::aiaa::VertexEdit> edits = polygonsNew.diff(polygonsOld, curSliceNum);
+  if (edits.empty()) {
     MITK_INFO("nvidia") << "Could not find an non-matching polygon";
     return;
   }
 
-  MITK_INFO("nvidia") << "FirstNonMatching Polygon (polyIndex" << polyIndex << "; vertexIndex: " << vertexIndex << ")";
-
-  int offset[2] = { 0, 0 };
-  offset[0] = polygonsNew.polys[polyIndex][vertexIndex][0] - polygonsOld.polys[polyIndex][vertexIndex][0];
-  offset[1] = polygonsNew.polys[polyIndex][vertexIndex][1] - polygonsOld.polys[polyIndex][vertexIndex][1];
-
-  MITK_INFO("nvidia") << "vertext Offset (" << offset[0] << ", " << offset[1] << ")";
+  for (auto &e : edits) {
+    MITK_INFO("nvidia") << "NonMatching Polygon (polyIndex: " << e.polyIndex << "; vertexIndex: " << e.vertexIndex << "; vertex Offset ("
+                        << e.vertexOffset[0] << ", " << e.vertexOffset[1] << "))";
+  }
 
   // Call AIAA maskToPolygonConversion
   nvidia::aiaa::Client client(m_AIAAServerUri, m_AIAAServerTimeout);
-  std::string outputImageFile = nvidia::aiaa::Utils::tempfilename() + ".png";  // updated_image_2D.png
 
   // Flix X,Y (for PNG)
   polygonsOld.flipXY();
-  int t = offset[0];
-  offset[0] = offset[1];
-  offset[1] = t;
+  for (auto &e : edits) {
+    std::swap(e.vertexOffset[0], e.vertexOffset[1]);
+  }
 
   try {
     auto begin = std::chrono::high_resolution_clock::now();
-    nvidia::aiaa::Polygons polygonsUpdated = client.fixPolygon(polygonsOld, m_NeighborhoodSize, polyIndex, vertexIndex, offset, tmpImage2DFileName,
-                                                               outputImageFile);
+    // Result mask is rasterized locally from updated polygons; so output image is not needed
+    nvidia::aiaa::Polygons polygonsUpdated = client.fixPolygon(polygonsOld, m_NeighborhoodSize, edits, tmpImage2DFileName, "");
     // Flix X,Y
     polygonsUpdated.flipXY();
 
@@ -329,9 +325,9 @@ void NvidiaSmartPolySegTool2D::PolygonFix() {
 
     if (!polygonsUpdated.empty()) {
       m_polygonsList.list[curSliceNum].polys = polygonsUpdated.polys;
-      displayResult(outputImageFile);
+      displayResult(polygonsUpdated);
     } else {
-      MITK_INFO("nvidia") << "PolygonsUpdated: " << polyIndex;
+      MITK_INFO("nvidia") << "PolygonsUpdated: Empty; Edits: " << edits.size();
       Tool::GeneralMessage("Failed to fix the polygon.  Empty response received from AIAA");
     }
   } catch (nvidia::aiaa::exception &e) {
@@ -339,9 +335,8 @@ void NvidiaSmartPolySegTool2D::PolygonFix() {
     Tool::GeneralMessage("Failed to execute 'fixPolygon' on Nvidia AIAA Server\n\n" + msg);
   }
 
-  // Remove TempFiles
+  // Remove TempFile
   std::remove(tmpImage2DFileName.c_str());
-  std::remove(outputImageFile.c_str());
 
   mitk::RenderingManager::GetInstance()->RequestUpdateAll();
 }
@@ -472,7 +467,7 @@ void NvidiaSmartPolySegTool2D::SetCurrentSlice(unsigned int slice) {
   mitk::RenderingManager::GetInstance()->RequestUpdateAll();
 }
 
-void NvidiaSmartPolySegTool2D::displayResult(const std::string &tmpResultFileName) {
+void NvidiaSmartPolySegTool2D::displayResult(const nvidia::aiaa::Polygons &polygons) {
   unsigned int curSliceNum = m_imageSize[2] - 1 - m_currentSlice;
   auto* toolManager = this->GetToolManager();
   mitk::DataNode::Pointer workingNode = toolManager->GetWorkingData(0);
@@ -491,14 +486,20 @@ void NvidiaSmartPolySegTool2D::displayResult(const std::string &tmpResultFileNam
   std::string labelName = labelSetImage->GetActiveLabel(activeLayerID)->GetName();
 
   using LabelImageType = itk::Image<mitk::Tool::DefaultSegmentationDataType, 3>;
-  using LabelImageReaderType = itk::ImageFileReader<LabelImageType>;
 
-  // read as pseudo 3D image for pasting slice back
-  auto reader = LabelImageReaderType::New();
-  reader->SetFileName(tmpResultFileName);
-  reader->Update();
+  // rasterize polygons into pseudo 3D image for pasting slice back
+  LabelImageType::SizeType sliceSize;
+  sliceSize[0] = m_imageSize[0];
+  sliceSize[1] = m_imageSize[1];
+  sliceSize[2] = 1;
+
+  std::vector<unsigned char> mask(sliceSize[0] * sliceSize[1], 0);
+  polygons.toMask(mask.data(), sliceSize[0], sliceSize[1]);
 
-  auto result_slice = reader->GetOutput();
+  auto result_slice = LabelImageType::New();
+  result_slice->SetRegions(LabelImageType::RegionType(sliceSize));
+  result_slice->Allocate();
+  std::copy(mask.begin(), mask.end(), result_slice->GetBufferPointer());
 
   // Important: use clone to just get the image content, prevent the write lock for later update
   typename LabelImageType::Pointer itkCurrentLayer;
@@ -63,8 +63,11 @@ void NvidiaDextrSegTool3DGUI::updateConfigs() {
     auto serverURI = preferences->Get(QmitkNvidiaAIAAPreferencePage::SERVER_URI, QmitkNvidiaAIAAPreferencePage::DEFAULT_SERVER_URI);
     auto serverTimeout = preferences->GetInt(QmitkNvidiaAIAAPreferencePage::SERVER_TIMEOUT, QmitkNvidiaAIAAPreferencePage::DEFAULT_SERVER_TIMEOUT);
     auto filterByLabel = preferences->GetBool(QmitkNvidiaAIAAPreferencePage::FILTER_BY_LABEL, QmitkNvidiaAIAAPreferencePage::DEFAULT_FILTER_BY_LABEL);
+    auto progressive = preferences->GetBool(QmitkNvidiaAIAAPreferencePage::PROGRESSIVE_SEGMENTATION,
+                                            QmitkNvidiaAIAAPreferencePage::DEFAULT_PROGRESSIVE_SEGMENTATION);
 
     m_NvidiaDextrSegTool3D->SetServerURI(serverURI.toStdString(), serverTimeout, filterByLabel);
+    m_NvidiaDextrSegTool3D->SetProgressiveSegmentation(progressive);
 
     // Update ComboBox for selecting the model
     m_Ui->segmentationCombo->clear();
@@ -25,11 +25,13 @@ const QString QmitkNvidiaAIAAPreferencePage::SERVER_URI = "server uri";
 const QString QmitkNvidiaAIAAPreferencePage::SERVER_TIMEOUT = "server timeout";
 const QString QmitkNvidiaAIAAPreferencePage::FILTER_BY_LABEL = "filter models by label";
 const QString QmitkNvidiaAIAAPreferencePage::NEIGHBORHOOD_SIZE = "neighborhood size";
+const QString QmitkNvidiaAIAAPreferencePage::PROGRESSIVE_SEGMENTATION = "progressive auto segmentation";
 
 const QString QmitkNvidiaAIAAPreferencePage::DEFAULT_SERVER_URI = "http://0.0.0.0:5000";
 const int QmitkNvidiaAIAAPreferencePage::DEFAULT_SERVER_TIMEOUT = 60;
 const bool QmitkNvidiaAIAAPreferencePage::DEFAULT_FILTER_BY_LABEL = true;
 const int QmitkNvidiaAIAAPreferencePage::DEFAULT_NEIGHBORHOOD_SIZE = 1;
+const bool QmitkNvidiaAIAAPreferencePage::DEFAULT_PROGRESSIVE_SEGMENTATION = false;
 
 QmitkNvidiaAIAAPreferencePage::QmitkNvidiaAIAAPreferencePage()
     : m_Widget(nullptr),
@@ -50,6 +52,7 @@ bool QmitkNvidiaAIAAPreferencePage::PerformOk() {
   m_Preferences->PutInt(SERVER_TIMEOUT, m_Ui->serverTimeoutSpinBox->value());
   m_Preferences->PutBool(FILTER_BY_LABEL, m_Ui->modelFilterCheckBox->isChecked());
   m_Preferences->PutInt(NEIGHBORHOOD_SIZE, m_Ui->neighborhoodSizeSpinBox->value());
+  m_Preferences->PutBool(PROGRESSIVE_SEGMENTATION, m_Ui->progressiveCheckBox->isChecked());
 
   return true;
 }
@@ -62,6 +65,7 @@ void QmitkNvidiaAIAAPreferencePage::Update() {
   m_Ui->serverTimeoutSpinBox->setValue(m_Preferences->GetInt(SERVER_TIMEOUT, DEFAULT_SERVER_TIMEOUT));
   m_Ui->modelFilterCheckBox->setChecked(m_Preferences->GetBool(FILTER_BY_LABEL, DEFAULT_FILTER_BY_LABEL));
   m_Ui->neighborhoodSizeSpinBox->setValue(m_Preferences->GetInt(NEIGHBORHOOD_SIZE, DEFAULT_NEIGHBORHOOD_SIZE));
+  m_Ui->progressiveCheckBox->setChecked(m_Preferences->GetBool(PROGRESSIVE_SEGMENTATION, DEFAULT_PROGRESSIVE_SEGMENTATION));
 }
 
 void QmitkNvidiaAIAAPreferencePage::CreateQtControl(QWidget* parent) {
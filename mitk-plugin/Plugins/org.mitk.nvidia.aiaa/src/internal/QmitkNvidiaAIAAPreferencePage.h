@@ -32,11 +32,13 @@ class QmitkNvidiaAIAAPreferencePage : public QObject, public berry::IQtPreferenc
   static const QString SERVER_TIMEOUT;
   static const QString FILTER_BY_LABEL;
   static const QString NEIGHBORHOOD_SIZE;
+  static const QString PROGRESSIVE_SEGMENTATION;
 
   static const QString DEFAULT_SERVER_URI;
   static const int DEFAULT_SERVER_TIMEOUT;
   static const bool DEFAULT_FILTER_BY_LABEL;
   static const int DEFAULT_NEIGHBORHOOD_SIZE;
+  static const bool DEFAULT_PROGRESSIVE_SEGMENTATION;
 
   QmitkNvidiaAIAAPreferencePage();
   ~QmitkNvidiaAIAAPreferencePage();